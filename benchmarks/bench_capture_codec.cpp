@@ -0,0 +1,201 @@
+// Size and cost of recording a tick in the raw and the compact capture
+// encodings. The process list is synthetic, so a host of any size can be
+// modelled: most processes idle, a few percent busy each tick with moving
+// CPU, memory and I/O, a handful spawning and exiting, and footprints read
+// for one screen of rows. Arguments: process count, tick count.
+#include "capture.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr double kTickSeconds = 0.5;
+constexpr uint64_t kTotalMemory = 64ull << 30;
+constexpr size_t kScreenRows = 40;
+
+const char* const kNames[] = {
+    "postgres", "php-fpm", "nginx", "sshd", "bash", "systemd", "kworker/0:1", "python3", "java", "node",
+    "containerd-shim", "dockerd", "cron", "rsyslogd", "redis-server", "sidekiq", "ruby", "chrome", "code",
+};
+const char* const kUsers[] = {"root", "postgres", "www-data", "app", "redis", "syslog"};
+
+class Workload {
+public:
+    Workload(size_t processes, unsigned seed) : rng_(seed), next_pid_(1), tick_(0) {
+        for (size_t i = 0; i < processes; ++i) {
+            spawn();
+        }
+    }
+    
+    const std::vector<ProcessInfo>& processes() const { return processes_; }
+    
+    void step() {
+        ++tick_;
+        std::uniform_real_distribution<double> jitter(0.97, 1.03);
+        const double elapsed = kTickSeconds * jitter(rng_);
+        for (size_t i = 0; i < processes_.size(); ++i) {
+            ProcessInfo& proc = processes_[i];
+            if (rng_() % 100 < 3) {
+                // Busy: CPU from clock ticks over the measured interval
+                proc.cpu_percent = 100.0 * static_cast<double>(1 + rng_() % 50) / (100.0 * elapsed);
+                proc.memory_bytes += 4096 * (rng_() % 64);
+                proc.memory_percent = 100.0 * static_cast<double>(proc.memory_bytes) / kTotalMemory;
+                proc.io_read_rate = rng_() % 4 == 0 ? static_cast<double>(rng_() % (1 << 20)) / elapsed : 0.0;
+                proc.io_write_rate = rng_() % 4 == 0 ? static_cast<double>(rng_() % (1 << 20)) / elapsed : 0.0;
+                proc.io_syscr_rate = static_cast<double>(rng_() % 256) / elapsed;
+                proc.io_syscw_rate = rng_() % 4 == 0 ? static_cast<double>(rng_() % 64) / elapsed : 0.0;
+                proc.sample_age = 0;
+            } else {
+                proc.cpu_percent = 0.0;
+                proc.io_read_rate = 0.0;
+                proc.io_write_rate = 0.0;
+                proc.io_syscr_rate = 0.0;
+                proc.io_syscw_rate = 0.0;
+                ++proc.sample_age;
+            }
+            if (i < kScreenRows) {
+                proc.footprint_available = true;
+                proc.footprint_age = tick_ % 10 == 0 ? 0.0 : proc.footprint_age + elapsed;
+            }
+        }
+        for (int i = 0; i < 4; ++i) {
+            processes_.erase(processes_.begin() + static_cast<long>(kScreenRows + rng_() % (processes_.size() - kScreenRows)));
+            spawn();
+        }
+    }
+
+private:
+    std::mt19937 rng_;
+    std::vector<ProcessInfo> processes_;
+    int next_pid_;
+    uint64_t tick_;
+    
+    void spawn() {
+        ProcessInfo proc;
+        next_pid_ += 1 + static_cast<int>(rng_() % 3);
+        proc.pid = next_pid_;
+        proc.ppid = processes_.empty() ? 0 : processes_[rng_() % processes_.size()].pid;
+        proc.name = kNames[rng_() % (sizeof(kNames) / sizeof(kNames[0]))];
+        proc.user = kUsers[rng_() % (sizeof(kUsers) / sizeof(kUsers[0]))];
+        proc.state = 'S';
+        proc.start_time = 100000 + static_cast<uint64_t>(tick_) * 50 + rng_() % 50;
+        proc.num_threads = 1 + static_cast<int>(rng_() % 8);
+        proc.memory_bytes = 4096ull * (256 + rng_() % 65536);
+        proc.memory_percent = 100.0 * static_cast<double>(proc.memory_bytes) / kTotalMemory;
+        proc.io_available = true;
+        proc.footprint.rss = proc.memory_bytes;
+        proc.footprint.pss = proc.memory_bytes / 2;
+        proc.footprint.uss = proc.memory_bytes / 4;
+        processes_.push_back(proc);
+    }
+};
+
+void fillSnapshot(Snapshot& snap, const std::vector<ProcessInfo>& processes, uint64_t version) {
+    snap.version = version;
+    snap.cpu_usage = 12.5 + static_cast<double>(version % 7);
+    snap.core_usage.assign(16, snap.cpu_usage);
+    snap.memory.total = kTotalMemory;
+    snap.processes.clear();
+    for (const auto& proc : processes) {
+        snap.processes.append(proc, snap.strings);
+    }
+    snap.process_count = snap.processes.size();
+}
+
+struct Result {
+    uint64_t bytes;
+    uint64_t keyframe_bytes;
+    size_t keyframes;
+    double encode_us;
+    double decode_us;
+    
+    Result() : bytes(0), keyframe_bytes(0), keyframes(0), encode_us(0), decode_us(0) {}
+};
+
+double microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t process_count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 5000;
+    const int ticks = argc > 2 ? std::atoi(argv[2]) : 600;
+    if (process_count <= kScreenRows || ticks <= 0) {
+        std::fprintf(stderr, "usage: %s [processes > %zu] [ticks]\n", argv[0], kScreenRows);
+        return 1;
+    }
+    
+    Workload workload(process_count, 1);
+    Snapshot snap;
+    Snapshot decoded;
+    std::vector<uint8_t> payload;
+    ProcessTableEncoder encoder;
+    ProcessTableDecoder decoder;
+    Result raw;
+    Result compact;
+    uint64_t samples = 0;
+    for (int tick = 0; tick < ticks; ++tick) {
+        workload.step();
+        fillSnapshot(snap, workload.processes(), static_cast<uint64_t>(tick));
+        samples += snap.processes.size();
+        
+        payload.clear();
+        auto start = std::chrono::steady_clock::now();
+        encodeSnapshot(snap, payload);
+        raw.encode_us += microsSince(start);
+        raw.bytes += payload.size();
+        start = std::chrono::steady_clock::now();
+        decodeSnapshot(payload.data(), payload.size(), decoded);
+        raw.decode_us += microsSince(start);
+        
+        const bool keyframe = tick % kCaptureKeyframeInterval == 0;
+        payload.clear();
+        start = std::chrono::steady_clock::now();
+        encodeCompactSnapshot(snap, encoder, keyframe, payload);
+        compact.encode_us += microsSince(start);
+        compact.bytes += payload.size();
+        if (keyframe) {
+            compact.keyframe_bytes += payload.size();
+            ++compact.keyframes;
+        }
+        // The table follows the length-prefixed system part
+        uint32_t system_bytes = 0;
+        std::memcpy(&system_bytes, payload.data(), sizeof(system_bytes));
+        const size_t skip = sizeof(system_bytes) + system_bytes;
+        start = std::chrono::steady_clock::now();
+        if (!decoder.decode(payload.data() + skip, payload.size() - skip, keyframe)) {
+            std::fprintf(stderr, "tick %d did not decode\n", tick);
+            return 1;
+        }
+        decoder.output(decoded.processes, decoded.strings);
+        compact.decode_us += microsSince(start);
+    }
+    
+    std::printf("processes: %zu, ticks: %d, keyframe every %u ticks\n", process_count, ticks,
+                kCaptureKeyframeInterval);
+    std::printf("%-10s %16s %14s %14s %14s\n", "", "bytes/sample", "KB/tick", "encode us/tick", "decode us/tick");
+    auto print = [&](const char* label, const Result& result) {
+        std::printf("%-10s %16.2f %14.1f %14.1f %14.1f\n", label, static_cast<double>(result.bytes) / samples,
+                    static_cast<double>(result.bytes) / ticks / 1024, result.encode_us / ticks,
+                    result.decode_us / ticks);
+    };
+    print("raw", raw);
+    print("compact", compact);
+    if (compact.keyframes > 0 && static_cast<size_t>(ticks) > compact.keyframes) {
+        std::printf("compact keyframe: %.1f KB, delta tick: %.1f KB\n",
+                    static_cast<double>(compact.keyframe_bytes) / compact.keyframes / 1024,
+                    static_cast<double>(compact.bytes - compact.keyframe_bytes) / (ticks - compact.keyframes) / 1024);
+    }
+    const double hours = 24.0;
+    std::printf("one day at %.1f s per tick: raw %.0f MB, compact %.0f MB\n", kTickSeconds,
+                static_cast<double>(raw.bytes) / ticks * (hours * 3600 / kTickSeconds) / (1 << 20),
+                static_cast<double>(compact.bytes) / ticks * (hours * 3600 / kTickSeconds) / (1 << 20));
+    return 0;
+}
@@ -0,0 +1,251 @@
+// Cost of scoring a search query against every process name: the original
+// full-matrix Levenshtein (copied here, it allocates m+1 rows per call)
+// against the bit-parallel distance, both for the bare distance and for
+// the matches() the filter calls with its 0.3 threshold; the substring scan
+// on each instruction set against lowering a copy for std::string::find;
+// and the filter's per-name work, lowering both strings twice per name
+// against one pass over the string pool's lowercase copies. Names are
+// synthetic but shaped like a busy host's: kernel threads with CPU and
+// queue suffixes, pooled workers, interpreters and daemons. Arguments:
+// name count, rounds over the names per query.
+#include "fuzzy_search.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+const char* const kDaemons[] = {
+    "systemd", "systemd-journald", "systemd-udevd", "systemd-logind", "systemd-resolved", "dbus-daemon",
+    "sshd", "cron", "rsyslogd", "containerd", "containerd-shim-runc-v2", "dockerd", "kubelet", "nginx",
+    "php-fpm8.2", "postgres", "redis-server", "memcached", "mysqld", "java", "node", "python3", "ruby",
+    "sidekiq", "gunicorn", "uwsgi", "bash", "zsh", "tmux: server", "chrome", "chromium-browser", "code",
+    "firefox", "Xorg", "gnome-shell", "pipewire", "pulseaudio", "NetworkManager", "polkitd", "snapd",
+};
+const char* const kKernelThreads[] = {
+    "kworker/%u:%u", "kworker/%u:%uH", "kworker/u%u:%u", "ksoftirqd/%u", "migration/%u", "cpuhp/%u",
+    "rcuop/%u", "irq/%u-nvme%uq", "idle_inject/%u", "jbd2/nvme%un1p%u-8",
+};
+const char* const kQueries[] = {"chrome", "postgres", "kworker", "pyhton", "systemd-journald", "x", "sidekiq"};
+
+std::vector<std::string> makeNames(size_t count) {
+    std::mt19937 rng(1);
+    std::vector<std::string> names;
+    names.reserve(count);
+    char buffer[64];
+    while (names.size() < count) {
+        if (rng() % 3 == 0) {
+            // Kernel threads: about a third of a large host's processes
+            const char* format = kKernelThreads[rng() % (sizeof(kKernelThreads) / sizeof(kKernelThreads[0]))];
+            std::snprintf(buffer, sizeof(buffer), format, static_cast<unsigned>(rng() % 64),
+                          static_cast<unsigned>(rng() % 8));
+            names.emplace_back(buffer);
+        } else {
+            names.emplace_back(kDaemons[rng() % (sizeof(kDaemons) / sizeof(kDaemons[0]))]);
+        }
+    }
+    return names;
+}
+
+int legacyDistance(const std::string& s1, const std::string& s2) {
+    const size_t m = s1.size();
+    const size_t n = s2.size();
+    if (m == 0) return static_cast<int>(n);
+    if (n == 0) return static_cast<int>(m);
+    std::vector<std::vector<int>> dp(m + 1, std::vector<int>(n + 1));
+    for (size_t i = 0; i <= m; ++i) dp[i][0] = static_cast<int>(i);
+    for (size_t j = 0; j <= n; ++j) dp[0][j] = static_cast<int>(j);
+    for (size_t i = 1; i <= m; ++i) {
+        for (size_t j = 1; j <= n; ++j) {
+            int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
+            dp[i][j] = std::min({dp[i - 1][j] + 1, dp[i][j - 1] + 1, dp[i - 1][j - 1] + cost});
+        }
+    }
+    return dp[m][n];
+}
+
+std::string legacyLower(const std::string& str) {
+    std::string result = str;
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return result;
+}
+
+bool legacyMatches(const std::string& text, const std::string& query, double threshold) {
+    std::string lower_text = legacyLower(text);
+    std::string lower_query = legacyLower(query);
+    if (lower_text.find(lower_query) != std::string::npos) {
+        return true;
+    }
+    const double max_len = static_cast<double>(std::max(lower_text.size(), lower_query.size()));
+    return 1.0 - legacyDistance(lower_text, lower_query) / max_len >= threshold;
+}
+
+struct Result {
+    double ns_per_name;
+    double allocations_per_name;
+    uint64_t checksum;
+    
+    Result() : ns_per_name(0), allocations_per_name(0), checksum(0) {}
+};
+
+// Runs score(name index, query) over every name and query, rounds times
+template <typename Score>
+Result measure(const std::vector<std::string>& names, const std::vector<std::string>& queries, int rounds,
+               Score score) {
+    Result result;
+    const uint64_t allocations = g_allocations.load();
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto& query : queries) {
+            for (size_t i = 0; i < names.size(); ++i) {
+                result.checksum += static_cast<uint64_t>(score(i, query));
+            }
+        }
+    }
+    const double scored = static_cast<double>(names.size()) * rounds * queries.size();
+    result.ns_per_name = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                         scored;
+    result.allocations_per_name = static_cast<double>(g_allocations.load() - allocations) / scored;
+    return result;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 10000;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (count == 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: %s [names] [rounds]\n", argv[0]);
+        return 1;
+    }
+    const std::vector<std::string> names = makeNames(count);
+    const std::vector<std::string> queries(std::begin(kQueries), std::end(kQueries));
+    
+    const Result old_distance = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return legacyDistance(names[i], query);
+    });
+    const Result new_distance = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return FuzzySearch::levenshteinDistance(names[i], query);
+    });
+    const Result old_matches = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return legacyMatches(names[i], query, 0.3);
+    });
+    const Result new_matches = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return FuzzySearch::matches(names[i], query, 0.3);
+    });
+    if (old_distance.checksum != new_distance.checksum || old_matches.checksum != new_matches.checksum) {
+        std::fprintf(stderr, "results differ from the full-matrix implementation\n");
+        return 1;
+    }
+    
+    const Result find_copy = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return FuzzySearch::toLower(names[i]).find(query);
+    });
+    const FuzzySearch::Isa isas[] = {FuzzySearch::Isa::Scalar, FuzzySearch::Isa::SSE2, FuzzySearch::Isa::AVX2};
+    const char* const isa_labels[] = {"find, scalar", "find, SSE2", "find, AVX2"};
+    std::vector<Result> find_isa;
+    for (FuzzySearch::Isa isa : isas) {
+        if (isa > FuzzySearch::supportedIsa()) {
+            break;
+        }
+        find_isa.push_back(measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+            return FuzzySearch::findIgnoreCase(names[i], query, isa);
+        }));
+        if (find_isa.back().checksum != find_copy.checksum) {
+            std::fprintf(stderr, "%s differs from std::string::find\n", isa_labels[find_isa.size() - 1]);
+            return 1;
+        }
+    }
+    
+    // Names are mostly under one vector; full command lines show the scan
+    // over longer text
+    std::vector<std::string> commands;
+    size_t command_bytes = 0;
+    for (size_t i = 0; i < names.size(); ++i) {
+        commands.push_back(names[i] + " --config=/etc/" + names[(i * 7) % names.size()] +
+                           "/Service.conf --log-dir=/var/log/app --workers=" + std::to_string(i % 64));
+        command_bytes += commands.back().size();
+    }
+    const Result command_copy = measure(commands, queries, rounds, [&](size_t i, const std::string& query) {
+        return FuzzySearch::toLower(commands[i]).find(query);
+    });
+    std::vector<Result> command_isa;
+    for (size_t k = 0; k < find_isa.size(); ++k) {
+        command_isa.push_back(measure(commands, queries, rounds, [&](size_t i, const std::string& query) {
+            return FuzzySearch::findIgnoreCase(commands[i], query, isas[k]);
+        }));
+        if (command_isa.back().checksum != command_copy.checksum) {
+            std::fprintf(stderr, "%s differs from std::string::find on command lines\n", isa_labels[k]);
+            return 1;
+        }
+    }
+    
+    // What filterRows does per distinct name, before and after the pool kept
+    // lowercase copies; scores are compared to three decimals
+    std::vector<std::string> lower_names;
+    for (const auto& name : names) {
+        lower_names.push_back(FuzzySearch::toLower(name));
+    }
+    const Result filter_lowering = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        const double score = FuzzySearch::matches(names[i], query, 0.3) ? FuzzySearch::getMatchScore(names[i], query)
+                                                                        : -1.0;
+        return static_cast<int>(score * 1000.0) + 1000;
+    });
+    const Result filter_cached = measure(names, queries, rounds, [&](size_t i, const std::string& query) {
+        return static_cast<int>(FuzzySearch::scoreLowered(lower_names[i], query, 0.3) * 1000.0) + 1000;
+    });
+    if (filter_lowering.checksum != filter_cached.checksum) {
+        std::fprintf(stderr, "scoreLowered differs from matches and getMatchScore\n");
+        return 1;
+    }
+    
+    std::printf("names: %zu, queries: %zu, rounds: %d\n", names.size(), queries.size(), rounds);
+    std::printf("%-24s %12s %14s\n", "", "ns/name", "allocs/name");
+    auto print = [](const char* label, const Result& result) {
+        std::printf("%-24s %12.1f %14.2f\n", label, result.ns_per_name, result.allocations_per_name);
+    };
+    print("distance, matrix", old_distance);
+    print("distance, bit-vector", new_distance);
+    print("matches, matrix", old_matches);
+    print("matches, bit-vector", new_matches);
+    print("find, lowered copy", find_copy);
+    for (size_t i = 0; i < find_isa.size(); ++i) {
+        print(isa_labels[i], find_isa[i]);
+    }
+    std::printf("command lines, %zu bytes on average:\n", command_bytes / commands.size());
+    print("find, lowered copy", command_copy);
+    for (size_t i = 0; i < command_isa.size(); ++i) {
+        print(isa_labels[i], command_isa[i]);
+    }
+    std::printf("filter pass per name:\n");
+    print("filter, lowering twice", filter_lowering);
+    print("filter, pool lowercase", filter_cached);
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Measures one full /proc scan with 1..N scan workers. Pass the maximum
+// worker count and iteration count as arguments.
+#include "linux_monitor.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+int main(int argc, char* argv[]) {
+    // As tbm does at startup, so the fd cache is sized the same
+    LinuxMonitor::raiseFileLimit();
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    const size_t max_workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : hw;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    
+    std::printf("hardware threads: %u, iterations: %d\n", hw, iterations);
+    std::printf("%8s %10s %12s %10s\n", "workers", "processes", "ms/scan", "speedup");
+    
+    double baseline = 0.0;
+    for (size_t workers = 1; workers <= max_workers; workers = workers < 4 ? workers + 1 : workers * 2) {
+        std::unique_ptr<ThreadPool> pool;
+        if (workers > 1) {
+            pool = std::make_unique<ThreadPool>(workers);
+        }
+        
+        // Warm-up pass fills the fd cache so every row measures steady state
+        size_t processes = LinuxMonitor::parseProcesses(LinuxMonitor::listPids(), pool.get()).size();
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            processes = LinuxMonitor::parseProcesses(LinuxMonitor::listPids(), pool.get()).size();
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ms = std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+        if (workers == 1) {
+            baseline = ms;
+        }
+        std::printf("%8zu %10zu %12.3f %9.2fx\n", workers, processes, ms, baseline / ms);
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Measures heap traffic of handing one tick's process list from the monitor
+// to the UI: the original path copies vector<ProcessInfo> four times (update
+// loop, setProcesses, render, filter); the columnar path refills the table
+// in place, copy-assigns it into last tick's buffers, and sorts and filters
+// row indices. Arguments: tick count, then an optional search query (the
+// fuzzy matcher allocates on its own, so it is left out by default).
+#include "linux_monitor.hpp"
+#include "process_manager.hpp"
+#include "process_table.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocated_bytes{0};
+
+struct AllocationScope {
+    uint64_t allocations;
+    uint64_t bytes;
+    
+    AllocationScope() : allocations(g_allocations.load()), bytes(g_allocated_bytes.load()) {}
+    uint64_t allocationsSince() const { return g_allocations.load() - allocations; }
+    uint64_t bytesSince() const { return g_allocated_bytes.load() - bytes; }
+};
+
+// Stand-in for what the collector produces each tick: same processes, moving CPU
+void nextTick(std::vector<ProcessInfo>& processes, int tick) {
+    for (size_t i = 0; i < processes.size(); ++i) {
+        processes[i].cpu_percent = static_cast<double>((i * 7 + tick) % 100);
+    }
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    const int ticks = argc > 1 ? std::atoi(argv[1]) : 200;
+    std::vector<ProcessInfo> processes = LinuxMonitor::parseProcesses(LinuxMonitor::listPids(), nullptr);
+    if (processes.empty()) {
+        std::fprintf(stderr, "no processes parsed\n");
+        return 1;
+    }
+    ProcessManager manager;
+    const std::string query = argc > 2 ? argv[2] : "";
+    
+    // Before: every stage takes its own copy of the row-wise list
+    std::vector<ProcessInfo> ui_processes;
+    AllocationScope before_scope;
+    auto start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick) {
+        nextTick(processes, tick);
+        auto copied = processes;                      // updateLoop
+        ui_processes = copied;                        // setProcesses
+        auto rendered = ui_processes;                 // renderProcessList
+        manager.sortProcesses(rendered, ProcessManager::SortBy::CPU, true);
+        if (!query.empty()) {
+            auto filtered = manager.filterProcesses(rendered, query);
+        }
+    }
+    const double before_us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / ticks;
+    const uint64_t before_allocations = before_scope.allocationsSince();
+    const uint64_t before_bytes = before_scope.bytesSince();
+    
+    // After: the table and index buffers are reused from the previous tick
+    StringPool strings;
+    StringPool ui_strings;
+    ProcessTable table;
+    ProcessTable ui_table;
+    std::vector<uint32_t> order;
+    auto run_table_tick = [&](int tick) {
+        nextTick(processes, tick);
+        table.clear();
+        for (const auto& proc : processes) {
+            table.append(proc, strings);
+        }
+        ui_table = table;
+        ui_strings.syncFrom(strings);
+        manager.sortRows(ui_table, ui_strings, ProcessManager::SortBy::CPU, true, order);
+        if (!query.empty()) {
+            manager.filterRows(ui_table, ui_strings, query, order);
+        }
+    };
+    // The first tick sizes the buffers and interns every name
+    run_table_tick(0);
+    AllocationScope after_scope;
+    start = std::chrono::steady_clock::now();
+    for (int tick = 1; tick <= ticks; ++tick) {
+        run_table_tick(tick);
+    }
+    const double after_us = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count() / ticks;
+    const uint64_t after_allocations = after_scope.allocationsSince();
+    const uint64_t after_bytes = after_scope.bytesSince();
+    
+    std::printf("processes: %zu, ticks: %d, distinct strings: %zu\n", processes.size(), ticks, strings.size());
+    std::printf("%-22s %14s %14s %12s\n", "", "allocs/tick", "bytes/tick", "us/tick");
+    std::printf("%-22s %14.1f %14.0f %12.1f\n", "vector<ProcessInfo>",
+                static_cast<double>(before_allocations) / ticks, static_cast<double>(before_bytes) / ticks, before_us);
+    std::printf("%-22s %14.1f %14.0f %12.1f\n", "ProcessTable",
+                static_cast<double>(after_allocations) / ticks, static_cast<double>(after_bytes) / ticks, after_us);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "capture_codec.hpp"
+#include "snapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Capture file layout, all integers in host byte order:
+//
+//   CaptureHeader                      fixed 64 bytes at offset 0
+//   tick payload | index block | ...   appended in write order
+//
+// Each tick is one encoded Snapshot. Index blocks hold a fixed number of
+// (offset, length, wall time) entries and are chained through `next`, so
+// a reader finds any tick by walking a few blocks and never scans the
+// payloads. The header's counts are updated after each tick is in place,
+// so a capture cut short by a crash still opens at its last complete tick.
+//
+// A compact tick stores the process table with ProcessTableEncoder, so
+// reading one means decoding forward from the keyframe before it.
+
+constexpr char kCaptureMagic[8] = {'T', 'B', 'M', 'C', 'A', 'P', '\0', '\1'};
+constexpr uint32_t kCaptureVersion = 3;            // 2 had no syscall rates; older ones are not read
+constexpr uint32_t kCaptureIndexEntries = 4096;    // per index block
+constexpr uint32_t kCaptureKeyframeInterval = 256; // compact ticks per keyframe
+
+enum CaptureEntryFlags : uint32_t {
+    kCaptureCompact  = 1u << 0, // process table from ProcessTableEncoder
+    kCaptureKeyframe = 1u << 1, // compact tick that decodes on its own
+};
+
+enum class CaptureEncoding {
+    Raw,     // every tick stands alone; columns copied as they are
+    Compact  // delta-encoded process table, keyframe every kCaptureKeyframeInterval ticks
+};
+
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t tick_count;     // ticks whose payload and index entry are complete
+    uint64_t data_end;       // end of the last complete record
+    uint64_t first_index;    // offset of the first index block, 0 before the first tick
+    uint64_t last_index;     // offset of the block being filled
+    uint32_t index_entries;  // capacity of every index block
+    uint32_t reserved[3];
+};
+static_assert(sizeof(CaptureHeader) == 64, "capture header is fixed");
+
+struct CaptureIndexEntry {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t flags;          // CaptureEntryFlags
+    int64_t wall_ns;         // system clock at capture, nanoseconds since the epoch
+};
+
+struct CaptureIndexBlock {
+    uint64_t next;           // offset of the following block, 0 for the last
+    uint32_t count;
+    uint32_t capacity;
+    // CaptureIndexEntry entries[capacity] follow
+};
+
+// Raw snapshot payload encoding. Each tick carries its own name table, so
+// any tick decodes without the ones before it. Threads, tree rows and
+// history are not recorded; replay rebuilds the history as it plays.
+void encodeSnapshot(const Snapshot& snap, std::vector<uint8_t>& out);
+// Returns false on a truncated or malformed payload
+bool decodeSnapshot(const uint8_t* data, size_t size, Snapshot& snap);
+
+// Compact payload: the system-wide part as in the raw encoding, prefixed
+// by its length, then the process table from encoder
+void encodeCompactSnapshot(const Snapshot& snap, ProcessTableEncoder& encoder, bool keyframe,
+                           std::vector<uint8_t>& out);
+
+// Appends ticks to a capture file through a shared mapping, growing the
+// file in large steps. The file is trimmed to its last tick on close.
+class CaptureWriter {
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+    
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+    
+    // Creates or truncates path; false with errno set on failure
+    bool open(const std::string& path, CaptureEncoding encoding = CaptureEncoding::Compact);
+    bool append(const Snapshot& snap, int64_t wall_ns);
+    // False when the file could not be trimmed; it still reads back, with
+    // trailing zeros
+    bool close();
+    
+    bool isOpen() const { return fd_ >= 0; }
+    uint64_t tickCount() const;
+    uint64_t bytesWritten() const;
+
+private:
+    int fd_;
+    uint8_t* map_;
+    size_t map_size_;
+    CaptureEncoding encoding_;
+    ProcessTableEncoder encoder_;
+    bool keyframe_due_; // the last tick did not make it into the file
+    std::vector<uint8_t> payload_; // reused across ticks
+    
+    CaptureHeader& header() const { return *reinterpret_cast<CaptureHeader*>(map_); }
+    bool reserve(size_t size);
+};
+
+// Read-only view of a capture. Opening maps the file and walks the index
+// chain; payloads are only paged in when a tick is decoded. A compact
+// tick is decoded forward from the last tick read when no keyframe lies
+// between them, else from its keyframe, so playback decodes one tick each.
+class CaptureReader {
+public:
+    CaptureReader();
+    ~CaptureReader();
+    
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+    
+    // False with errno set when the file cannot be mapped, EINVAL when it
+    // is not a capture
+    bool open(const std::string& path);
+    
+    size_t tickCount() const { return tick_count_; }
+    int64_t wallTime(size_t tick) const { return entry(tick).wall_ns; }
+    // Last tick captured at or before wall_ns, 0 when wall_ns precedes them all
+    size_t findTick(int64_t wall_ns) const;
+    bool read(size_t tick, Snapshot& snap);
+
+private:
+    int fd_;
+    const uint8_t* map_;
+    size_t map_size_;
+    size_t tick_count_;
+    std::vector<const CaptureIndexBlock*> blocks_;
+    ProcessTableDecoder decoder_;
+    size_t decoded_tick_; // tick the decoder holds the table of
+    
+    const CaptureIndexEntry& entry(size_t tick) const;
+    bool payload(size_t tick, const uint8_t*& data, size_t& size) const;
+    bool decodeTable(size_t tick);
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "process_table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compact encoding of the process table for long captures. A keyframe
+// stands alone; every other tick is encoded against the tick before it,
+// matching rows by PID and start time, so a process whose columns did not
+// move costs a few bits.
+//
+//   rows, removed PIDs, added PIDs   varints, PIDs as ascending deltas
+//   dictionary additions             names and users first seen this tick
+//   integer columns                  zigzag varint deltas against the same
+//                                    process last tick (a stale row's
+//                                    sample age is expected to grow by one),
+//                                    runs of unchanged rows as one count;
+//                                    start time of new processes as
+//                                    delta-of-delta
+//   double columns                   XOR with the previous value, bit packed
+//                                    (Gorilla): 1 bit when unchanged
+//
+// Names and users are indices into a dictionary that lives from one
+// keyframe to the next. New processes are encoded against zero.
+
+class ProcessTableEncoder {
+public:
+    ProcessTableEncoder();
+    
+    // Appends the encoding of table to out. A keyframe also starts a new
+    // dictionary.
+    void encode(const ProcessTable& table, const StringPool& strings, bool keyframe, std::vector<uint8_t>& out);
+    // Forgets the previous tick; the next encode must be a keyframe
+    void reset();
+    // True once strings was compacted after the last encode, which leaves
+    // the pool ID cache stale; the next encode must then be a keyframe
+    bool needsKeyframe(const StringPool& strings) const { return strings.generation() != pool_generation_; }
+    size_t dictionarySize() const { return dictionary_ ? dictionary_->size() : 0; }
+
+private:
+    ProcessTable previous_;  // names and users hold dictionary IDs
+    ProcessTable current_;
+    std::unique_ptr<StringPool> dictionary_;
+    size_t dictionary_sent_; // strings the decoder already has
+    // Snapshot pool ID to dictionary ID. The pool may not be the one it
+    // was filled from, so each entry is checked against the string once
+    // per tick; pool_checked_ holds the encode count it was last checked at.
+    std::vector<uint32_t> pool_to_dictionary_;
+    std::vector<uint32_t> pool_checked_;
+    uint32_t encodes_;
+    uint64_t pool_generation_; // StringPool generation the cache was filled from
+    std::vector<int32_t> source_; // previous_ row of each row, -1 when new
+    std::vector<int> removed_;
+    std::vector<int> added_;
+    
+    uint32_t dictionaryId(StringPool::Id id, const StringPool& strings);
+};
+
+class ProcessTableDecoder {
+public:
+    ProcessTableDecoder();
+    
+    // Applies one encoded tick. False on a malformed section, or on a delta
+    // with no keyframe before it; the decoder then waits for a keyframe.
+    bool decode(const uint8_t* data, size_t size, bool keyframe);
+    // Copies the last decoded table out, interning names into strings
+    void output(ProcessTable& table, StringPool& strings);
+    bool primed() const { return primed_; }
+    void reset();
+
+private:
+    ProcessTable previous_; // names and users hold dictionary IDs
+    ProcessTable current_;
+    std::vector<std::string> dictionary_;
+    std::vector<uint32_t> dictionary_to_pool_;
+    std::vector<int32_t> source_;
+    std::vector<int> removed_;
+    std::vector<int> added_;
+    bool primed_;
+};
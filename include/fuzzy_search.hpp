@@ -1,15 +1,44 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 
 class FuzzySearch {
 public:
+    // Instruction sets findIgnoreCase can use; Auto picks the widest this
+    // CPU has
+    enum class Isa { Auto, Scalar, SSE2, AVX2 };
+    
     static int levenshteinDistance(const std::string& s1, const std::string& s2);
+    // Stops as soon as the distance is known to exceed max_distance (which
+    // must not be negative) and returns max_distance + 1 in that case
+    static int levenshteinDistance(const std::string& s1, const std::string& s2, int max_distance);
     static double similarity(const std::string& s1, const std::string& s2);
     static bool matches(const std::string& text, const std::string& query, double threshold = 0.3);
     static double getMatchScore(const std::string& text, const std::string& query);
+    // matches() and getMatchScore() in one pass, for callers that keep
+    // lowercase copies of their names: the score, or -1 below threshold
+    static double scoreLowered(const std::string& lower_text, const std::string& lower_query,
+                               double threshold = 0.3);
+    
+    // Offset of the first occurrence of lower_query in text, ignoring ASCII
+    // case in text, or npos. lower_query must already be lowercase. Asking
+    // for an instruction set the CPU lacks runs the widest one it has.
+    static size_t findIgnoreCase(std::string_view text, std::string_view lower_query, Isa isa = Isa::Auto);
+    static Isa supportedIsa();
+    
+    // ASCII only, as in the C locale the monitor runs in
+    static std::string toLower(const std::string& str);
+    static char toLowerAscii(char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
 
 private:
-    static std::string toLower(const std::string& str);
+    // similarity(s1, s2) >= threshold, without computing more of the
+    // distance than that takes
+    static bool isSimilar(const std::string& s1, const std::string& s2, double threshold);
+    // Largest distance between non-empty strings of these lengths that
+    // still scores threshold, or -1 when none does
+    static int distanceLimit(size_t len1, size_t len2, double threshold);
 };
-
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "process_table.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One point of a series: the spread and mean of the samples it covers.
+// A raw point covers a single sample, so all three are equal.
+struct HistoryPoint {
+    float min;
+    float max;
+    float avg;
+    
+    HistoryPoint() : min(0), max(0), avg(0) {}
+    explicit HistoryPoint(float value) : min(value), max(value), avg(value) {}
+};
+
+// Fixed-capacity ring; once full, each push overwrites the oldest point
+class HistoryRing {
+public:
+    explicit HistoryRing(size_t capacity = 0);
+    
+    void push(const HistoryPoint& point);
+    void clear() { head_ = 0; size_ = 0; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return points_.size(); }
+    // Index 0 is the oldest point still held
+    const HistoryPoint& at(size_t index) const;
+    const HistoryPoint& latest() const { return at(size_ - 1); }
+
+private:
+    std::vector<HistoryPoint> points_;
+    size_t head_; // slot the next push writes
+    size_t size_;
+};
+
+enum class HistoryTier {
+    Raw,        // every update
+    TenSeconds,
+    Minute
+};
+
+constexpr size_t kHistoryTiers = 3;
+
+// Points kept per tier; the product with the tier's resolution is how far
+// back each tier reaches
+struct HistoryLayout {
+    size_t raw_points;
+    size_t ten_second_points;
+    size_t minute_points;
+    
+    HistoryLayout() : raw_points(120), ten_second_points(180), minute_points(240) {}
+};
+
+// One metric at every tier. Each sample goes into the raw ring and into
+// the open 10 s and 1 min buckets; a bucket is folded into its ring when a
+// sample lands past its end. Buckets in which nothing was sampled are not
+// filled in.
+class MetricHistory {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    explicit MetricHistory(const HistoryLayout& layout = HistoryLayout());
+    
+    void add(double value, Clock::time_point when);
+    void clear();
+    const HistoryRing& tier(HistoryTier which) const { return rings_[static_cast<size_t>(which)]; }
+    size_t memoryBytes() const;
+
+private:
+    struct Bucket {
+        int64_t index; // bucket number since the clock's epoch, -1 while empty
+        float min;
+        float max;
+        double sum;
+        uint32_t count;
+        
+        Bucket() : index(-1), min(0), max(0), sum(0), count(0) {}
+    };
+    
+    HistoryRing rings_[kHistoryTiers];
+    Bucket open_[kHistoryTiers - 1]; // one per downsampled tier
+};
+
+// History of the system-wide metrics and of the busiest processes, in
+// memory fixed by the layout, the core count and the number of process
+// slots. Once every ring is allocated, recording neither allocates nor
+// frees.
+class History {
+public:
+    using Clock = MetricHistory::Clock;
+    
+    // A tracked process; slots are reused, so check pid and start_time
+    struct ProcessSeries {
+        int pid;               // 0 while the slot is free
+        uint64_t start_time;
+        Clock::time_point last_top; // last update it was among the busiest
+        MetricHistory cpu_percent;
+        MetricHistory memory_bytes;
+        
+        explicit ProcessSeries(const HistoryLayout& layout)
+            : pid(0), start_time(0), cpu_percent(layout), memory_bytes(layout) {}
+    };
+    
+    explicit History(size_t process_slots = 16, const HistoryLayout& layout = HistoryLayout());
+    
+    void recordSystem(double cpu_percent, const std::vector<double>& core_percent, double memory_percent,
+                      double swap_percent, Clock::time_point when);
+    // top holds table rows of the busiest processes. They claim a slot,
+    // evicting whichever tracked process was busy longest ago; every
+    // tracked process still in the table is then recorded.
+    void recordProcesses(const ProcessTable& table, const std::vector<uint32_t>& top, Clock::time_point when);
+    
+    const MetricHistory& cpu() const { return cpu_; }
+    const std::vector<MetricHistory>& cores() const { return cores_; }
+    const MetricHistory& memory() const { return memory_; }
+    const MetricHistory& swap() const { return swap_; }
+    const std::vector<ProcessSeries>& processes() const { return processes_; }
+    const ProcessSeries* findProcess(int pid) const;
+    size_t memoryBytes() const;
+
+private:
+    HistoryLayout layout_;
+    MetricHistory cpu_;
+    std::vector<MetricHistory> cores_;
+    MetricHistory memory_;
+    MetricHistory swap_;
+    std::vector<ProcessSeries> processes_;
+};
@@ -3,12 +3,102 @@
 #include "system_monitor.hpp"
 #include <string>
 #include <vector>
+#include <sys/types.h>
+
+class ThreadPool;
 
 namespace LinuxMonitor {
+    // Syscall accounting for /proc reads, cumulative since startup
+    struct ProcReadStats {
+        uint64_t opens;
+        uint64_t reads;
+        uint64_t closes;
+        uint64_t cache_hits;      // reads served from an already open fd
+        uint64_t cache_misses;    // fds opened and kept for later ticks
+        uint64_t invalidations;   // cached fds dropped after ESRCH or PID reuse
+        uint64_t permission_skips; // reads skipped because an earlier one was denied
+        size_t cached_processes;
+        
+        ProcReadStats() : opens(0), reads(0), closes(0), cache_hits(0), cache_misses(0),
+                          invalidations(0), permission_skips(0), cached_processes(0) {}
+        uint64_t syscalls() const { return opens + reads + closes; }
+    };
+    
+    // Which /proc/diskstats entries to keep; whole physical disks always are
+    struct DiskFilter {
+        bool partitions;
+        bool virtual_devices; // loop*, ram*
+        
+        DiskFilter() : partitions(false), virtual_devices(false) {}
+    };
+    
     CPUStats parseCPUStats(const std::string& stat_line);
+    // Reads the aggregate and every per-core line of /proc/stat in one pass.
+    // cores is indexed by CPU number; offline CPUs have no line and get a
+    // zeroed slot, so online counts only the CPUs that were read.
+    bool readCPUStats(CPUStats& total, std::vector<CPUStats>& cores, size_t& online);
     MemoryStats parseMemoryStats();
+    // Refreshes counters in place; slots whose device is unchanged keep
+    // their name buffer, so a steady device set does not allocate
+    bool readDiskStats(std::vector<DiskStats>& disks, const DiskFilter& filter);
+    // Advances table.tick and refreshes every interface's counters
+    bool readNetDevStats(NetInterfaceTable& table);
+    bool readSystemPressure(SystemPressure& pressure);
+    // Mount point of the cgroup v2 hierarchy, or empty when there is none
+    const std::string& cgroupRoot();
+    // cpu/memory pressure of the top two levels of the cgroup v2 tree
+    bool readCgroupPressure(std::vector<CgroupPressure>& groups);
+    // The cgroup v2 path of a process, e.g. "/system.slice/sshd.service";
+    // empty when the process is gone or there is no v2 hierarchy
+    std::string readProcessCgroup(int pid);
+    // Fills usage and memory from the group's files under cgroupRoot()
+    bool readCgroupStats(CgroupStats& group);
     std::vector<ProcessInfo> parseProcesses();
+    std::vector<int> listPids();
+    // Parses the given PIDs, spread across pool workers when one is supplied
+    std::vector<ProcessInfo> parseProcesses(const std::vector<int>& pids, ThreadPool* pool);
     ProcessInfo parseProcessInfo(int pid);
+    // Only /proc/<pid>/stat: name, state, CPU times, start time, vsize, rss
+    ProcessInfo parseProcessStat(int pid);
+    
+    // Multi-pass scans: wrap every scanProcesses call of a tick in
+    // beginScanTick/endScanTick. Cached fds of PIDs not read for more than
+    // max_idle_ticks are closed, so processes sampled every k ticks keep
+    // theirs when k is passed.
+    enum class ScanDepth { Full, StatOnly };
+    void beginScanTick();
+    void endScanTick(unsigned max_idle_ticks);
+    std::vector<ProcessInfo> scanProcesses(const std::vector<int>& pids, ThreadPool* pool, ScanDepth depth);
+    // Reads /proc/<pid>/smaps_rollup (Linux 4.14+). Costly: the kernel walks
+    // every mapping of the process to produce it
+    bool readSmapsRollup(int pid, MemoryFootprint& footprint);
+    // Reads /proc/<pid>/task/*/stat; cpu_percent is left for the caller
+    std::vector<ThreadInfo> parseThreads(int pid);
     std::string readFile(const std::string& path);
+    
+    // Raises the soft RLIMIT_NOFILE towards the hard limit so the cache of
+    // open /proc fds can hold more processes. Call before the first scan:
+    // the cache sizes itself from the limit once. tbm starts no children,
+    // so they never inherit the higher limit.
+    void raiseFileLimit();
+    
+    // Reads a /proc file into buf with raw open/read; returns bytes read or -1
+    ssize_t readProcFile(const char* path, char* buf, size_t size);
+    
+    // Allocation-free parsers over raw file contents
+    bool parseStatBuffer(const char* data, size_t len, ProcessInfo& proc);
+    bool parseStatusBuffer(const char* data, size_t len, uint64_t& rss_bytes, unsigned& uid);
+    bool parseIoBuffer(const char* data, size_t len, ProcessInfo& proc);
+    bool parseSmapsRollupBuffer(const char* data, size_t len, MemoryFootprint& footprint);
+    MemoryStats parseMemInfoBuffer(const char* data, size_t len);
+    bool parseCPUStatsBuffer(const char* data, size_t len, CPUStats& total, std::vector<CPUStats>& cores,
+                             size_t& online);
+    void parseDiskStatsBuffer(const char* data, size_t len, std::vector<DiskStats>& disks, const DiskFilter& filter);
+    void parseNetDevBuffer(const char* data, size_t len, NetInterfaceTable& table);
+    bool parsePressureBuffer(const char* data, size_t len, PressureStats& stats);
+    std::string parseCgroupBuffer(const char* data, size_t len);
+    
+    // Persistent /proc/<pid> fd cache; capacity is also bounded by RLIMIT_NOFILE
+    ProcReadStats getProcReadStats();
+    void setFdCacheCapacity(size_t max_processes);
 }
-
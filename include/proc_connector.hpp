@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ProcEvent {
+    enum Type { Fork, Exec, Exit };
+    Type type;
+    int pid;        // thread group id of the process the event is about
+    int parent_pid; // Fork only
+    char comm[16];  // Exec only: name captured as soon as the event arrived
+};
+
+// Subscribes to kernel process lifecycle events over the netlink proc
+// connector (NETLINK_CONNECTOR / CN_IDX_PROC). Requires CAP_NET_ADMIN;
+// open() fails cleanly without it so callers can fall back to readdir.
+// A listener thread drains the socket continuously so bursts of forks
+// between ticks do not overflow the receive buffer.
+class ProcConnector {
+public:
+    ProcConnector();
+    ~ProcConnector();
+    
+    ProcConnector(const ProcConnector&) = delete;
+    ProcConnector& operator=(const ProcConnector&) = delete;
+    
+    bool open();
+    bool isOpen() const { return fd_ >= 0; }
+    
+    // Moves queued events into out. Returns false when the kernel dropped
+    // events since the last call, in which case the caller must rescan.
+    bool drain(std::vector<ProcEvent>& out);
+
+private:
+    int fd_;
+    int wake_fd_;
+    std::thread listener_;
+    std::atomic<bool> stopping_;
+    
+    std::mutex queue_mutex_;
+    std::vector<ProcEvent> queue_;
+    bool overflowed_;
+    
+    bool subscribe(bool enable);
+    bool waitForAck();
+    void listenLoop();
+    // Returns false on ENOBUFS
+    bool receive(bool& got_ack, int& ack_err);
+};
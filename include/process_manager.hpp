@@ -1,6 +1,8 @@
 #pragma once
 
 #include "system_monitor.hpp"
+#include "process_table.hpp"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -12,18 +14,29 @@ public:
         CPU,
         MEMORY,
         PID,
-        NAME
+        NAME,
+        IO_READ,   // bytes/s read from storage
+        IO_WRITE,  // bytes/s written to storage
+        IO_TOTAL,
+        IO_SYSCR,  // read syscalls/s, including ones served from cache
+        IO_SYSCW   // write syscalls/s
     };
     
     std::vector<ProcessInfo> filterProcesses(const std::vector<ProcessInfo>& processes, 
                                              const std::string& query) const;
     void sortProcesses(std::vector<ProcessInfo>& processes, SortBy criteria, bool descending = true) const;
+    static const char* sortName(SortBy criteria);
     
-    size_t getProcessCount() const { return processes_.size(); }
-    void setProcesses(const std::vector<ProcessInfo>& processes) { processes_ = processes; }
-    const std::vector<ProcessInfo>& getProcesses() const { return processes_; }
-    
+    // Table variants: order receives row indices (all rows sorted, or the
+    // matching rows best first) and the table itself is left untouched.
+    // They reuse scratch buffers, so one manager must not be shared by threads.
+    void sortRows(const ProcessTable& table, const StringPool& strings, SortBy criteria,
+                  bool descending, std::vector<uint32_t>& order) const;
+    void filterRows(const ProcessTable& table, const StringPool& strings, const std::string& query,
+                    std::vector<uint32_t>& order) const;
+
 private:
-    std::vector<ProcessInfo> processes_;
+    mutable std::vector<double> name_scores_; // by name ID: fuzzy names are scored once
+    mutable std::vector<double> row_scores_;
 };
 
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "system_monitor.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Interned strings with stable IDs; ID 0 is the empty string. Between
+// compactions the pool only grows, so an ID stays valid and a replica owned
+// by another thread catches up by copying just the strings added since.
+// compact() drops strings no longer used and renumbers the rest; it starts
+// a new generation, and replicas of an older one are rebuilt in full.
+class StringPool {
+public:
+    using Id = uint32_t;
+    
+    StringPool();
+    
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    
+    Id intern(std::string_view value);
+    const std::string& get(Id id) const { return strings_[id]; }
+    // Lowercased once, when the string is first interned, for search
+    const std::string& lower(Id id) const { return lower_[id]; }
+    size_t size() const { return strings_.size(); }
+    
+    uint64_t generation() const { return generation_; }
+    
+    // Appends the strings source gained since the last sync, or copies all
+    // of them after source was compacted. Only valid for a pool that has
+    // never interned anything itself.
+    void syncFrom(const StringPool& source);
+    // Keeps the strings whose live flag is set, plus ID 0, renumbered in
+    // their current order; remap receives the new ID of each kept string
+    // and 0 for dropped ones.
+    void compact(const std::vector<uint8_t>& live, std::vector<Id>& remap);
+
+private:
+    // deque: growing never moves existing strings, so the index keys stay valid
+    std::deque<std::string> strings_;
+    std::unordered_map<std::string_view, Id> index_;
+    std::deque<std::string> lower_;
+    uint64_t generation_;
+};
+
+// The process list one column per field, rows aligned across columns.
+// Assigning one table to another reuses the destination's capacity, and
+// sorting or filtering produces permutations of row indices, so handing
+// the list to the UI every tick does not allocate once sizes settle.
+// SystemMonitor fills it in ascending PID order.
+struct ProcessTable {
+    std::vector<int> pid;
+    std::vector<int> ppid;
+    std::vector<uint64_t> start_time;
+    std::vector<StringPool::Id> name;
+    std::vector<StringPool::Id> user;
+    std::vector<char> state;
+    std::vector<int> num_threads;
+    std::vector<double> cpu_percent;
+    std::vector<double> memory_percent;
+    std::vector<uint64_t> memory_bytes;
+    std::vector<double> io_read_rate;
+    std::vector<double> io_write_rate;
+    std::vector<double> io_syscr_rate;
+    std::vector<double> io_syscw_rate;
+    std::vector<uint8_t> io_available;
+    std::vector<unsigned> sample_age;
+    std::vector<MemoryFootprint> footprint;
+    std::vector<double> footprint_age; // negative when there is no footprint
+    
+    size_t size() const { return pid.size(); }
+    // Empties every column but keeps its capacity
+    void clear();
+    void append(const ProcessInfo& proc, StringPool& strings);
+    // Rewrites names and users after StringPool::compact
+    void remapStrings(const std::vector<StringPool::Id>& remap);
+};
+
+// Columns of a surviving process that differ between two ticks. Sample and
+// footprint ages are left out: they advance every tick on their own, so
+// only a row going stale or fresh again counts.
+enum ProcessField : uint32_t {
+    kFieldParent    = 1u << 0,
+    kFieldName      = 1u << 1, // name or user
+    kFieldState     = 1u << 2,
+    kFieldThreads   = 1u << 3,
+    kFieldCPU       = 1u << 4,
+    kFieldMemory    = 1u << 5, // bytes or percent
+    kFieldIO        = 1u << 6,
+    kFieldStale     = 1u << 7, // sample_age crossed zero
+    kFieldFootprint = 1u << 8,
+};
+
+// What changed in the process list from one tick to the next. Its size
+// follows churn: PIDs that appeared, exited, or had a column change. A PID
+// reused by a new process shows up as removed and added.
+struct ProcessDelta {
+    std::vector<uint32_t> added;          // rows of the newer table
+    std::vector<int> removed;             // PIDs gone from the older table
+    std::vector<uint32_t> changed;        // rows of the newer table
+    std::vector<uint32_t> changed_fields; // ProcessField mask, parallel to changed
+    size_t unchanged;
+    
+    ProcessDelta() : unchanged(0) {}
+    
+    size_t size() const { return added.size() + removed.size() + changed.size(); }
+    // One merge pass over two tables in ascending PID order; keeps capacity
+    void compute(const ProcessTable& before, const ProcessTable& after);
+};
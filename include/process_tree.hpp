@@ -0,0 +1,69 @@
+#pragma once
+
+#include "system_monitor.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Parent/children index over the live process set, kept across ticks.
+// Each update applies only the PIDs that appeared, vanished, or changed
+// parent, and recomputes subtree totals only along the paths below which
+// a value changed.
+class ProcessTree {
+public:
+    struct Node {
+        int pid;
+        int ppid;             // as last reported by the kernel
+        int parent;           // linked parent, 0 while the node is a root
+        uint64_t start_time;
+        std::vector<int> children;
+        double cpu_percent;
+        uint64_t memory_bytes;
+        double subtree_cpu;
+        uint64_t subtree_memory;
+        size_t subtree_count;
+        uint64_t seen;        // last update that listed the PID
+        bool dirty;           // totals are stale; implies every ancestor is dirty too
+        
+        Node() : pid(0), ppid(0), parent(0), start_time(0), cpu_percent(0), memory_bytes(0),
+                 subtree_cpu(0), subtree_memory(0), subtree_count(0), seen(0), dirty(true) {}
+    };
+    
+    // What the last update changed
+    struct UpdateStats {
+        size_t added;
+        size_t removed;
+        size_t reparented;
+        size_t recomputed; // nodes whose subtree totals were summed again
+        
+        UpdateStats() : added(0), removed(0), reparented(0), recomputed(0) {}
+    };
+    
+    ProcessTree();
+    
+    void update(const std::vector<ProcessInfo>& processes);
+    // Depth-first, busiest subtree first; descendants of collapsed PIDs are left out
+    void flatten(const std::unordered_set<int>& collapsed, std::vector<ProcessTreeRow>& out) const;
+    
+    const Node* find(int pid) const;
+    size_t size() const { return nodes_.size(); }
+    size_t rootCount() const { return roots_.size(); }
+    const UpdateStats& getLastUpdate() const { return last_update_; }
+
+private:
+    std::unordered_map<int, Node> nodes_;
+    std::unordered_set<int> roots_;
+    uint64_t tick_;
+    UpdateStats last_update_;
+    
+    void link(Node& node);
+    void unlink(Node& node);
+    void remove(int pid);
+    bool isAncestor(int ancestor, int pid) const;
+    void markDirty(Node& node);
+    void recompute(Node& node);
+    void appendRows(const Node& node, int depth, const std::unordered_set<int>& collapsed,
+                    std::vector<ProcessTreeRow>& out) const;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "capture.hpp"
+#include "history.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Plays a capture back as a stream of snapshots in place of a live
+// SystemMonitor. The update thread calls advance() with the wall time
+// that passed; key handlers pause, seek and change speed from the UI
+// thread; the renderer takes snapshot() as it would from the monitor.
+class Replay {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Status {
+        size_t tick;
+        size_t tick_count;
+        int64_t wall_ns;  // capture time of the tick shown
+        bool paused;
+        double speed;
+        
+        Status() : tick(0), tick_count(0), wall_ns(0), paused(false), speed(1) {}
+    };
+    
+    Replay();
+    
+    // False with errno set when the file is missing or not a capture,
+    // ENODATA when it holds no ticks, EINVAL when the first does not decode
+    bool open(const std::string& path);
+    
+    // Moves playback forward by elapsed times the speed; true when a
+    // different tick is now shown. Stops at the last tick.
+    bool advance(Clock::duration elapsed);
+    void togglePause();
+    // Relative jump in capture time; pauses at either end
+    void seek(double seconds);
+    // Halves or doubles the speed, within 1/8x to 64x
+    void slower();
+    void faster();
+    
+    Status status() const;
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+private:
+    CaptureReader reader_;
+    mutable std::mutex mutex_;
+    int64_t position_ns_;  // capture time playback has reached
+    size_t tick_;          // tick currently published
+    bool paused_;
+    double speed_;
+    // Rebuilt from the ticks played, since captures do not store it
+    History history_;
+    // Read and written only through std::atomic_load / std::atomic_store
+    std::shared_ptr<const Snapshot> published_;
+    
+    // Publishes tick; false, leaving the current one up, if it does not decode
+    bool show(size_t tick);
+};
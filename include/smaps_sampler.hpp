@@ -0,0 +1,67 @@
+#pragma once
+
+#include "system_monitor.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reads /proc/<pid>/smaps_rollup on a thread of its own. The kernel walks
+// every mapping of the process under its mmap lock to produce that file,
+// which takes milliseconds for large processes, so only the PIDs the caller
+// asks for are read, no faster than the configured rate, and results are
+// served from a cache together with their age.
+class SmapsSampler {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Result {
+        int pid;
+        uint64_t start_time;
+        MemoryFootprint footprint;
+        Clock::time_point sampled_at;
+    };
+    
+    // reads_per_second bounds the whole lane; a PID is re-read at most
+    // once per refresh_interval
+    SmapsSampler(double reads_per_second, Clock::duration refresh_interval);
+    ~SmapsSampler();
+    
+    SmapsSampler(const SmapsSampler&) = delete;
+    SmapsSampler& operator=(const SmapsSampler&) = delete;
+    
+    // Replaces the wanted (pid, start_time) list. Among PIDs that are due,
+    // earlier entries are read first.
+    void request(const std::vector<std::pair<int, uint64_t>>& wanted);
+    // Cached footprints of the currently wanted PIDs
+    void collect(std::vector<Result>& out) const;
+    uint64_t getReadCount() const { return reads_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t start_time;
+        MemoryFootprint footprint;
+        Clock::time_point sampled_at;
+        bool valid; // false when the read failed; not retried for this start_time
+    };
+    
+    std::thread worker_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::vector<std::pair<int, uint64_t>> wanted_;
+    std::unordered_map<int, Entry> cache_;
+    Clock::duration read_gap_;
+    Clock::duration refresh_interval_;
+    std::atomic<uint64_t> reads_;
+    bool stopping_;
+    
+    void workerLoop();
+    // Finds the wanted PID to read next and when it falls due; false when
+    // none ever will. Requires mutex_.
+    bool nextDue(int& pid, uint64_t& start_time, Clock::time_point& due) const;
+};
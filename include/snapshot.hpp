@@ -0,0 +1,47 @@
+#pragma once
+
+#include "system_monitor.hpp"
+#include "history.hpp"
+#include "process_table.hpp"
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Everything one update collected, frozen. SystemMonitor publishes a new
+// snapshot at the end of each update and never touches it again, so a
+// reader holding one sees CPU, memory and processes from the same tick
+// without any lock. Buffers come back to the monitor once the last reader
+// lets go and are refilled in place on a later tick.
+struct Snapshot {
+    uint64_t version; // increments by one per update
+    std::chrono::steady_clock::time_point taken_at;
+    
+    double cpu_usage;
+    CPUStats cpu_delta;
+    std::vector<double> core_usage;
+    MemoryStats memory;
+    std::vector<DiskStats> disks;
+    std::vector<NetStats> interfaces; // active interfaces only
+    SystemPressure pressure;
+    std::vector<CgroupPressure> cgroup_pressure;
+    std::vector<CgroupStats> cgroups;
+    
+    size_t process_count;
+    bool event_driven;
+    uint64_t short_lived_count;
+    SamplingStats sampling;
+    // Names and users are IDs into strings, a replica of the monitor's pool
+    ProcessTable processes;
+    // Rows of processes that differ from snapshot version - 1
+    ProcessDelta delta;
+    StringPool strings;
+    std::unordered_map<int, std::vector<ThreadInfo>> threads;
+    std::vector<ProcessTreeRow> tree_rows;
+    History history;
+    
+    Snapshot() : version(0), cpu_usage(0), process_count(0), event_driven(false), short_lived_count(0) {}
+    
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+};
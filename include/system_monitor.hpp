@@ -4,6 +4,21 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+class ThreadPool;
+class ProcConnector;
+class SmapsSampler;
+class ProcessTree;
+class StringPool;
+struct ProcessTable;
+struct ProcessDelta;
+class History;
+struct ProcEvent;
+struct Snapshot;
 
 struct CPUStats {
     double user;
@@ -13,62 +28,468 @@ struct CPUStats {
     double iowait;
     double irq;
     double softirq;
+    double steal;      // time stolen by the hypervisor
+    double guest;      // already counted in user
+    double guest_nice; // already counted in nice
     double total;
     
-    CPUStats() : user(0), nice(0), system(0), idle(0), iowait(0), irq(0), softirq(0), total(0) {}
+    CPUStats() : user(0), nice(0), system(0), idle(0), iowait(0), irq(0), softirq(0),
+                 steal(0), guest(0), guest_nice(0), total(0) {}
 };
 
+// All sizes in bytes except the HugePages_* counts
 struct MemoryStats {
     uint64_t total;
     uint64_t used;
     uint64_t free;
+    uint64_t available;
     uint64_t cached;
     uint64_t buffers;
+    uint64_t shmem;
+    uint64_t slab;
+    uint64_t slab_reclaimable;
+    uint64_t dirty;
+    uint64_t writeback;
+    uint64_t swap_total;
+    uint64_t swap_free;
+    uint64_t swap_cached;
+    uint64_t hugepages_total;
+    uint64_t hugepages_free;
+    uint64_t hugepages_reserved;
+    uint64_t hugepages_surplus;
+    uint64_t hugepage_size;
     double percent_used;
+    
+    MemoryStats() : total(0), used(0), free(0), available(0), cached(0), buffers(0), shmem(0),
+                    slab(0), slab_reclaimable(0), dirty(0), writeback(0), swap_total(0),
+                    swap_free(0), swap_cached(0), hugepages_total(0), hugepages_free(0),
+                    hugepages_reserved(0), hugepages_surplus(0), hugepage_size(0), percent_used(0) {}
+    
+    uint64_t swapUsed() const { return swap_total > swap_free ? swap_total - swap_free : 0; }
+};
+
+// Memory of one process from /proc/<pid>/smaps_rollup, in bytes. PSS
+// splits each shared page among the processes mapping it, so unlike RSS
+// it can be summed across the workers of a forking server.
+struct MemoryFootprint {
+    uint64_t rss;
+    uint64_t pss;
+    uint64_t uss;      // Private_Clean + Private_Dirty
+    uint64_t swap;
+    uint64_t swap_pss; // proportional share of swapped-out shared pages
+    
+    MemoryFootprint() : rss(0), pss(0), uss(0), swap(0), swap_pss(0) {}
 };
 
 struct ProcessInfo {
     int pid;
+    int ppid;            // 0 for the kernel's own roots (init, kthreadd)
     std::string name;
     std::string user;
     double cpu_percent;
     double memory_percent;
     uint64_t memory_bytes;
-    std::string state;
+    char state;          // R, S, D, Z, T, ...; '?' when unknown
     uint64_t virtual_memory;
     uint64_t resident_memory;
+    uint64_t utime;      // clock ticks spent in user mode
+    uint64_t stime;      // clock ticks spent in kernel mode
+    uint64_t start_time; // clock ticks after boot, used to detect PID reuse
+    int num_threads;
+    
+    // Cumulative counters from /proc/<pid>/io; bytes are storage-layer I/O
+    uint64_t io_read_bytes;
+    uint64_t io_write_bytes;
+    uint64_t io_syscr;
+    uint64_t io_syscw;
+    // Rates since the previous tick, filled in by SystemMonitor
+    double io_read_rate;  // bytes/s
+    double io_write_rate; // bytes/s
+    double io_syscr_rate; // read syscalls/s
+    double io_syscw_rate; // write syscalls/s
+    bool io_available;    // false when the counters are not readable by us
+    // Ticks since memory and I/O were last read; nonzero for idle processes
+    // whose values were carried forward by the tiered scheduler
+    unsigned sample_age;
+    // Only read for on-screen rows, on a rate-limited background thread
+    MemoryFootprint footprint;
+    bool footprint_available;
+    double footprint_age; // seconds since footprint was read
+    
+    ProcessInfo() : pid(0), ppid(0), cpu_percent(0), memory_percent(0), memory_bytes(0), state('?'),
+                    virtual_memory(0), resident_memory(0), utime(0), stime(0), start_time(0),
+                    num_threads(0), io_read_bytes(0), io_write_bytes(0), io_syscr(0), io_syscw(0),
+                    io_read_rate(0), io_write_rate(0), io_syscr_rate(0), io_syscw_rate(0),
+                    io_available(false), sample_age(0), footprint_available(false), footprint_age(0) {}
+    
+    bool stale() const { return sample_age > 0; }
+};
+
+// One line of the process tree in display order, with totals over the
+// process and all of its descendants
+struct ProcessTreeRow {
+    int pid;
+    int depth;
+    bool has_children;
+    bool collapsed;
+    double subtree_cpu;
+    uint64_t subtree_memory;
+    size_t subtree_count; // processes in the subtree, itself included
+    
+    ProcessTreeRow() : pid(0), depth(0), has_children(false), collapsed(false),
+                       subtree_cpu(0), subtree_memory(0), subtree_count(0) {}
+};
+
+// One task of a multithreaded process, from /proc/<pid>/task/<tid>/stat
+struct ThreadInfo {
+    int tid;
+    std::string name;  // thread name as set by prctl(PR_SET_NAME)
+    char state;
+    double cpu_percent;
+    uint64_t utime;
+    uint64_t stime;
+    uint64_t start_time;
+    
+    ThreadInfo() : tid(0), state('?'), cpu_percent(0), utime(0), stime(0), start_time(0) {}
+};
+
+// One block device from /proc/diskstats: raw counters plus rates over the
+// last interval, which SystemMonitor fills in
+struct DiskStats {
+    std::string name;
+    unsigned major;
+    unsigned minor;
+    bool is_partition;
+    uint64_t reads;           // completed requests
+    uint64_t sectors_read;    // always 512-byte units
+    uint64_t read_time_ms;
+    uint64_t writes;
+    uint64_t sectors_written;
+    uint64_t write_time_ms;
+    uint64_t in_flight;
+    uint64_t io_time_ms;      // time with at least one request in flight
+    double read_iops;
+    double write_iops;
+    double read_bytes_per_sec;
+    double write_bytes_per_sec;
+    double utilization;       // percent of the interval the device was busy
+    double avg_latency_ms;    // mean time per completed request
+    
+    DiskStats() : major(0), minor(0), is_partition(false), reads(0), sectors_read(0), read_time_ms(0),
+                  writes(0), sectors_written(0), write_time_ms(0), in_flight(0), io_time_ms(0),
+                  read_iops(0), write_iops(0), read_bytes_per_sec(0), write_bytes_per_sec(0),
+                  utilization(0), avg_latency_ms(0) {}
+};
+
+// Cumulative interface counters from /proc/net/dev
+struct NetCounters {
+    uint64_t rx_bytes;
+    uint64_t rx_packets;
+    uint64_t rx_errors;
+    uint64_t rx_dropped;
+    uint64_t tx_bytes;
+    uint64_t tx_packets;
+    uint64_t tx_errors;
+    uint64_t tx_dropped;
+    
+    NetCounters() : rx_bytes(0), rx_packets(0), rx_errors(0), rx_dropped(0),
+                    tx_bytes(0), tx_packets(0), tx_errors(0), tx_dropped(0) {}
+};
+
+struct NetStats {
+    std::string name;
+    bool active;          // false for a free slot left by a removed interface
+    uint64_t first_seen;  // tick the interface took this slot
+    uint64_t last_seen;
+    NetCounters counters;
+    double rx_bytes_per_sec;
+    double tx_bytes_per_sec;
+    double rx_packets_per_sec;
+    double tx_packets_per_sec;
+    uint64_t drops;       // rx + tx drops during the last interval
+    uint64_t errors;      // rx + tx errors during the last interval
+    
+    NetStats() : active(false), first_seen(0), last_seen(0), rx_bytes_per_sec(0), tx_bytes_per_sec(0),
+                 rx_packets_per_sec(0), tx_packets_per_sec(0), drops(0), errors(0) {}
+};
+
+// Interfaces pinned to slots for as long as they exist. Container hosts
+// churn through veth devices; a slot freed by one is reused by the next,
+// so a steady tick only allocates when the interface count grows.
+struct NetInterfaceTable {
+    std::vector<NetStats> slots;
+    std::unordered_map<std::string, size_t> index; // name to slot
+    std::vector<size_t> free_slots;
+    uint64_t tick;
+    
+    NetInterfaceTable() : tick(0) {}
+};
+
+// One line of a PSI file: share of wall time that tasks were stalled
+struct PressureLine {
+    double avg10;      // percent, 10 s running average
+    double avg60;
+    double avg300;
+    uint64_t total_us; // cumulative stall time
+    
+    PressureLine() : avg10(0), avg60(0), avg300(0), total_us(0) {}
+};
+
+// "some": at least one task stalled; "full": all non-idle tasks stalled
+struct PressureStats {
+    PressureLine some;
+    PressureLine full;
+    bool available;
+    
+    PressureStats() : available(false) {}
+};
+
+// System-wide /proc/pressure/{cpu,memory,io}
+struct SystemPressure {
+    PressureStats cpu;
+    PressureStats memory;
+    PressureStats io;
+};
+
+// Pressure of one cgroup v2 group, path relative to the cgroup root
+struct CgroupPressure {
+    std::string path;
+    PressureStats cpu;
+    PressureStats memory;
+};
+
+// A cgroup v2 group with at least one live process, read from the group's
+// own accounting files instead of summing its members
+struct CgroupStats {
+    std::string path;         // relative to the cgroup root, "/" for the root itself
+    size_t process_count;
+    uint64_t usage_usec;      // cpu.stat usage_usec
+    double cpu_percent;       // 100% is one full core, as for processes
+    uint64_t memory_current;  // bytes
+    uint64_t memory_max;      // bytes, 0 when unlimited
     
-    ProcessInfo() : pid(0), cpu_percent(0), memory_percent(0), memory_bytes(0), 
-                    virtual_memory(0), resident_memory(0) {}
+    CgroupStats() : process_count(0), usage_usec(0), cpu_percent(0), memory_current(0), memory_max(0) {}
+};
+
+// A process that started and exited between two ticks, seen only through
+// proc connector events
+struct ShortLivedProcess {
+    int pid;
+    std::string name; // empty when it exited without exec'ing
+};
+
+struct MonitorOptions {
+    size_t worker_threads;    // /proc scan parallelism; 1 scans on the calling thread
+    bool use_proc_connector;  // track PIDs from netlink events instead of readdir (Linux)
+    size_t thread_top_n;      // also list threads of the N busiest processes
+    bool show_partitions;     // include partitions in the disk panel
+    bool show_virtual_disks;  // include loop and ram devices
+    unsigned cold_interval;   // idle processes are sampled every k ticks; 1 samples all every tick
+    size_t hot_top_n;         // the N busiest processes always stay hot
+    double footprint_rate;    // smaps_rollup reads per second for hot PIDs; 0 disables (Linux)
+    
+    MonitorOptions() : worker_threads(1), use_proc_connector(true), thread_top_n(0),
+                       show_partitions(false), show_virtual_disks(false), cold_interval(8),
+                       hot_top_n(32), footprint_rate(10) {}
+};
+
+// What the tiered scheduler did during the last update
+struct SamplingStats {
+    size_t hot;          // fully parsed: busy, pinned, or new
+    size_t cold_checked; // idle, due this tick: stat only
+    size_t cold_skipped; // idle, not due: carried forward without any read
+    size_t promoted;     // cold processes whose CPU time moved, re-read in full
+    
+    SamplingStats() : hot(0), cold_checked(0), cold_skipped(0), promoted(0) {}
 };
 
 class SystemMonitor {
 public:
-    SystemMonitor();
+    explicit SystemMonitor(const MonitorOptions& options = MonitorOptions());
     ~SystemMonitor();
     
     void update();
     
+    // The state as of the last update, safe to hold and read from any
+    // thread. The getters below read live state and are only for the
+    // thread that calls update().
+    std::shared_ptr<const Snapshot> snapshot() const;
+    
     const CPUStats& getCPUStats() const { return cpu_stats_; }
+    // Jiffies spent in each state since the previous update
+    CPUStats getCPUDelta() const;
+    // Busy percentage per logical CPU over the last interval, indexed by cpu number
+    const std::vector<double>& getCoreUsage() const { return core_usage_; }
     const MemoryStats& getMemoryStats() const { return memory_stats_; }
+    // Block devices in /proc/diskstats order, after the options' filters
+    const std::vector<DiskStats>& getDiskStats() const { return disk_stats_; }
+    // PSI; all entries are unavailable on kernels without CONFIG_PSI
+    const SystemPressure& getPressure() const { return pressure_; }
+    const std::vector<CgroupPressure>& getCgroupPressure() const { return cgroup_pressure_; }
+    
+    // Per-cgroup aggregation is only collected while enabled
+    void setCgroupViewEnabled(bool enabled) { cgroup_view_enabled_ = enabled; }
+    // Sorted by CPU usage, busiest first
+    const std::vector<CgroupStats>& getCgroupStats() const { return cgroup_stats_; }
+    uint64_t getCgroupLookups() const { return cgroup_lookups_; }
+    // The process tree is only maintained while enabled. Rows are in
+    // display order, without the descendants of collapsed PIDs.
+    void setTreeViewEnabled(bool enabled) { tree_view_enabled_ = enabled; }
+    void setCollapsedPids(const std::vector<int>& pids);
+    const std::vector<ProcessTreeRow>& getTreeRows() const { return tree_rows_; }
+    const ProcessTree* getProcessTree() const { return process_tree_.get(); }
+    // Interface slots; skip entries whose active flag is false
+    const std::vector<NetStats>& getNetStats() const { return net_table_.slots; }
     const std::vector<ProcessInfo>& getProcesses() const { return processes_; }
+    // The same list in columns, in PID order, with names and users
+    // interned in getStrings()
+    const ProcessTable& getProcessTable() const;
+    // How the table differs from the previous update's
+    const ProcessDelta& getProcessDelta() const;
+    // CPU, memory and swap over time, and CPU and memory of the busiest processes
+    const History& getHistory() const;
+    const StringPool& getStrings() const;
     double getCPUUsage() const;
     size_t getProcessCount() const { return processes_.size(); }
     
+    // Process discovery: event-driven when the proc connector is available
+    bool isEventDriven() const { return proc_connector_ != nullptr; }
+    uint64_t getReaddirPasses() const { return readdir_passes_; }
+    uint64_t getReaddirPassesAvoided() const { return readdir_passes_avoided_; }
+    uint64_t getShortLivedCount() const { return short_lived_count_; }
+    // Processes with CPU and I/O baselines; matches getProcessCount() after each update
+    size_t getTrackedProcessCount() const { return process_state_.size(); }
+    const std::deque<ShortLivedProcess>& getShortLivedProcesses() const { return short_lived_; }
+    
+    // Threads are only read for expanded PIDs and the top-N processes;
+    // getThreads returns nullptr for any other PID
+    void setExpandedPids(const std::vector<int>& pids) { expanded_pids_ = pids; }
+    // PIDs on screen or selected; they are sampled every tick and, in
+    // this order, have their memory footprint read in the background
+    void setHotPids(const std::vector<int>& pids) { hot_pids_ = pids; }
+    const SamplingStats& getSamplingStats() const { return sampling_stats_; }
+    const std::vector<ThreadInfo>* getThreads(int pid) const;
+    const std::unordered_map<int, std::vector<ThreadInfo>>& getAllThreads() const { return threads_; }
+
 private:
+    MonitorOptions options_;
+    std::unique_ptr<ThreadPool> scan_pool_;
+    
+    // Live PID set maintained from fork/exit events
+    std::unique_ptr<ProcConnector> proc_connector_;
+    std::unique_ptr<SmapsSampler> smaps_sampler_;
+    std::unordered_set<int> live_pids_;
+    std::vector<int> scan_pids_;
+    bool live_pids_valid_;
+    bool exits_from_events_; // this tick's exits already left process_state_
+    uint64_t readdir_passes_;
+    uint64_t readdir_passes_avoided_;
+    uint64_t short_lived_count_;
+    std::deque<ShortLivedProcess> short_lived_;
+    
     CPUStats cpu_stats_;
     CPUStats prev_cpu_stats_;
+    std::vector<CPUStats> core_stats_;
+    std::vector<CPUStats> prev_core_stats_;
+    std::vector<double> core_usage_;
     MemoryStats memory_stats_;
+    std::vector<DiskStats> disk_stats_;
+    std::vector<DiskStats> prev_disk_stats_;
+    SystemPressure pressure_;
+    std::vector<CgroupPressure> cgroup_pressure_;
+    uint64_t pressure_ticks_;
+    
+    // pid -> cgroup path, only re-read for new PIDs and after exec
+    struct ProcessCgroup {
+        std::string path;
+        uint64_t start_time;
+        uint64_t generation;
+    };
+    bool cgroup_view_enabled_;
+    std::unordered_map<int, ProcessCgroup> pid_cgroups_;
+    std::unordered_set<int> exec_pids_;
+    struct CgroupUsage {
+        uint64_t usage_usec;
+        uint64_t generation;
+    };
+    std::unordered_map<std::string, CgroupUsage> cgroup_usage_;
+    std::vector<CgroupStats> cgroup_stats_;
+    uint64_t cgroup_lookups_;
+    bool tree_view_enabled_;
+    std::unique_ptr<ProcessTree> process_tree_;
+    std::unordered_set<int> collapsed_pids_;
+    std::vector<ProcessTreeRow> tree_rows_;
+    NetInterfaceTable net_table_;
+    std::vector<NetCounters> prev_net_counters_; // indexed by slot
     std::vector<ProcessInfo> processes_;
+    std::unique_ptr<StringPool> strings_;
+    std::unique_ptr<ProcessTable> process_table_;
+    std::unique_ptr<ProcessTable> previous_table_;
+    std::unique_ptr<ProcessDelta> process_delta_;
+    std::vector<uint32_t> pid_order_; // processes_ indices by PID, reused
+    size_t live_strings_; // pool strings in use at the last compaction check
+    std::vector<uint8_t> live_flags_;     // by pool ID, reused
+    std::vector<uint32_t> string_remap_;  // StringPool::compact output, reused
+    std::unique_ptr<History> history_;
+    std::vector<uint32_t> history_top_; // table rows of the busiest processes, reused
+    
+    // Per-thread view, limited to the processes selected for expansion
+    std::vector<int> expanded_pids_;
+    std::vector<int> hot_pids_;
+    SamplingStats sampling_stats_;
+    std::unordered_map<int, std::vector<ThreadInfo>> threads_;
+    
+    // Read and written only through std::atomic_load / std::atomic_store
+    std::shared_ptr<const Snapshot> published_;
+    struct SnapshotPool;
+    std::shared_ptr<SnapshotPool> snapshot_pool_;
+    uint64_t snapshot_version_;
     
     std::chrono::steady_clock::time_point last_update_;
+    double sample_interval_; // seconds between the last two updates
+    
+    // Per-PID CPU and I/O counters carried between ticks
+    struct ProcessSample {
+        uint64_t cpu_time;      // utime + stime at last sample
+        uint64_t start_time;
+        double sample_total;    // system-wide jiffies at last sample
+        uint64_t generation;    // tick in which the PID was last seen
+        uint64_t io_read_bytes;
+        uint64_t io_write_bytes;
+        uint64_t io_syscr;
+        uint64_t io_syscw;
+        bool io_available;
+        bool cold;              // demoted to the every-k-ticks tier
+        unsigned idle_samples;  // consecutive samples without CPU time
+    };
+    std::unordered_map<int, ProcessSample> process_state_;
+    std::unordered_map<int, ProcessSample> thread_state_; // keyed by TID
+    uint64_t generation_;
+    unsigned cpu_count_;
     
     // Platform-specific implementations
     void updateCPUStats();
     void updateMemoryStats();
+    void updateDiskStats();
+    void updateNetworkStats();
+    void updatePressure();
+    void updateCgroups();
     void updateProcesses();
+    void compactStrings();
+    size_t scanTiered(const std::vector<int>& pids);
+    void updateProcessCPU(size_t sampled);
+    void updateFootprints();
+    void updateTree();
+    void updateHistory();
+    void publishSnapshot();
+    void updateProcessIO(ProcessInfo& proc, const ProcessSample& previous, double elapsed) const;
+    void updateThreads();
+    const std::vector<int>& refreshLivePids();
+    void applyProcEvents(const std::vector<ProcEvent>& events);
+    void pruneLivePids();
     
     // Helper to calculate CPU percentage
+    double sampleTaskCPU(ProcessSample& state, bool inserted, uint64_t cpu_time, uint64_t start_time) const;
     double calculateCPUPercent(const CPUStats& current, const CPUStats& previous) const;
 };
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of persistent workers for data-parallel loops. The calling
+// thread takes part as worker 0, so a pool of size 1 spawns no threads.
+class ThreadPool {
+public:
+    using ChunkFn = std::function<void(size_t worker, size_t begin, size_t end)>;
+    
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    size_t size() const { return workers_.size() + 1; }
+    
+    // Splits [0, count) into chunks that workers claim dynamically and blocks
+    // until all of them have run. Not reentrant.
+    void parallelFor(size_t count, size_t chunk_size, const ChunkFn& fn);
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    
+    const ChunkFn* job_;
+    size_t job_count_;
+    size_t job_chunk_;
+    std::atomic<size_t> next_index_;
+    size_t active_workers_;
+    uint64_t epoch_;
+    bool stopping_;
+    
+    void workerLoop(size_t worker);
+    void runChunks(size_t worker);
+};
@@ -1,47 +1,92 @@
 #pragma once
 
 #include "system_monitor.hpp"
+#include "history.hpp"
 #include "process_manager.hpp"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <atomic>
 #include <thread>
 #include <mutex>
 
+struct Snapshot;
+class CaptureWriter;
+class Replay;
+
 class TUI {
 public:
-    TUI();
+    // With a recorder, every tick is also appended to its capture. With a
+    // replay, the capture drives the UI and no monitor is created.
+    explicit TUI(const MonitorOptions& options = MonitorOptions(),
+                 std::unique_ptr<CaptureWriter> recorder = nullptr,
+                 std::unique_ptr<Replay> replay = nullptr);
     ~TUI();
     
     void run();
-    
+
 private:
     std::unique_ptr<SystemMonitor> monitor_;
+    std::unique_ptr<CaptureWriter> recorder_; // used by the update thread only
+    std::unique_ptr<Replay> replay_;
+    std::atomic<uint64_t> recorded_ticks_;
+    std::atomic<bool> recording_;             // cleared when a write fails
     std::unique_ptr<ProcessManager> process_manager_;
     ftxui::ScreenInteractive screen_;
     
     std::atomic<bool> running_;
     std::thread update_thread_;
-    mutable std::mutex data_mutex_;
+    // Guards the view settings below that the update thread passes to the
+    // monitor; collected data reaches the UI only through snapshots
+    mutable std::mutex settings_mutex_;
+    // The snapshot the current frame is drawn from; render thread only
+    std::shared_ptr<const Snapshot> frame_;
     
     std::string search_query_;
-    std::string sort_mode_;
+    ProcessManager::SortBy sort_by_;
     int selected_process_index_;
     bool show_help_;
+    bool show_cgroups_;
+    bool show_tree_;
+    HistoryTier history_tier_; // resolution of the sparklines
+    
+    // Processes expanded into their threads; only these have tasks scanned
+    std::unordered_set<int> expanded_pids_;
+    // Tree mode: subtrees folded into their root row
+    std::unordered_set<int> collapsed_pids_;
+    // PIDs in the order last drawn, so key handlers can map the selection
+    mutable std::vector<int> visible_pids_;
+    // Render scratch, reused across frames
+    mutable std::vector<uint32_t> row_order_;
+    mutable std::unordered_map<int, uint32_t> row_by_pid_;
     
     ftxui::Component search_input_;
     ftxui::Component process_list_;
     ftxui::Component main_container_;
     
     void updateLoop();
+    void replayLoop();
     ftxui::Element renderHeader() const;
+    ftxui::Element renderPressure(const char* label, const PressureStats& stats) const;
     ftxui::Element renderCPUStats() const;
+    ftxui::Element renderCoreHeatmap(const std::vector<double>& core_usage) const;
     ftxui::Element renderMemoryStats() const;
+    ftxui::Element renderSparkline(const char* label, const MetricHistory& metric) const;
+    ftxui::Element renderDiskStats() const;
+    ftxui::Element renderNetworkStats() const;
     ftxui::Element renderProcessList() const;
+    ftxui::Element renderCgroupList() const;
     ftxui::Element renderFooter() const;
     ftxui::Element renderHelp() const;
     bool onEvent(ftxui::Event event);
+    bool onReplayEvent(const ftxui::Event& event);
+    void toggleExpanded();
+    void toggleCollapsed();
+    void cycleSortMode();
+    void cycleHistoryTier();
     
     std::string formatBytes(uint64_t bytes) const;
     std::string formatPercent(double percent) const;
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// Process-wide UID -> user name cache. Lookups never touch NSS: an unknown
+// UID returns its numeric form immediately and is resolved on a background
+// thread, so a slow LDAP/SSSD backend cannot stall a monitor tick. Names are
+// interned and stay valid for the rest of the process; the cache is never
+// destroyed, so exiting does not wait on a resolver stuck in NSS.
+class UserCache {
+public:
+    static UserCache& instance();
+    
+    const std::string& lookup(unsigned uid);
+    
+    UserCache(const UserCache&) = delete;
+    UserCache& operator=(const UserCache&) = delete;
+
+private:
+    UserCache();
+    
+    std::shared_mutex names_mutex_;
+    std::unordered_map<unsigned, const std::string*> names_;
+    std::unordered_set<std::string> pool_;
+    
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<unsigned> pending_;
+    struct timespec passwd_mtime_;
+    
+    const std::string* intern(const std::string& name);
+    void resolverLoop();
+    bool passwdChanged();
+    void resolve(unsigned uid);
+};
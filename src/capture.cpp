@@ -0,0 +1,729 @@
+#include "capture.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// The file grows by doubling, in steps of at most this much
+constexpr size_t kMinMapping = 1 << 20;
+constexpr size_t kMaxGrowStep = 64 << 20;
+
+constexpr uint32_t kNoString = std::numeric_limits<uint32_t>::max();
+constexpr size_t kNoTick = std::numeric_limits<size_t>::max();
+
+// Structs written as raw bytes; the header's version covers their layout
+static_assert(std::is_trivially_copyable<CPUStats>::value, "");
+static_assert(std::is_trivially_copyable<MemoryStats>::value, "");
+static_assert(std::is_trivially_copyable<NetCounters>::value, "");
+static_assert(std::is_trivially_copyable<PressureStats>::value, "");
+static_assert(std::is_trivially_copyable<SystemPressure>::value, "");
+static_assert(std::is_trivially_copyable<SamplingStats>::value, "");
+static_assert(std::is_trivially_copyable<MemoryFootprint>::value, "");
+
+size_t align8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+// Grows the file from old_size to new_size with its blocks allocated.
+// A write through the mapping into a hole the filesystem cannot fill
+// raises SIGBUS; allocating up front turns a full disk into ENOSPC here.
+bool allocateFile(int fd, size_t old_size, size_t new_size) {
+#ifdef __APPLE__
+    fstore_t store;
+    std::memset(&store, 0, sizeof(store));
+    store.fst_flags = F_ALLOCATEALL;
+    store.fst_posmode = F_PEOFPOSMODE;
+    store.fst_length = static_cast<off_t>(new_size - old_size);
+    if (fcntl(fd, F_PREALLOCATE, &store) == -1) {
+        return false;
+    }
+    return ftruncate(fd, static_cast<off_t>(new_size)) == 0;
+#else
+    const int error = posix_fallocate(fd, static_cast<off_t>(old_size), static_cast<off_t>(new_size - old_size));
+    if (error != 0) {
+        errno = error;
+        return false;
+    }
+    return true;
+#endif
+}
+
+size_t indexBlockBytes(uint32_t capacity) {
+    return sizeof(CaptureIndexBlock) + static_cast<size_t>(capacity) * sizeof(CaptureIndexEntry);
+}
+
+class PayloadWriter {
+public:
+    explicit PayloadWriter(std::vector<uint8_t>& out) : out_(out) {}
+    
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "");
+        const size_t at = out_.size();
+        out_.resize(at + sizeof(T));
+        std::memcpy(out_.data() + at, &value, sizeof(T));
+    }
+    
+    template <typename T>
+    void putColumn(const std::vector<T>& column) {
+        const size_t at = out_.size();
+        out_.resize(at + column.size() * sizeof(T));
+        if (!column.empty()) {
+            std::memcpy(out_.data() + at, column.data(), column.size() * sizeof(T));
+        }
+    }
+    
+    void putString(const std::string& value) {
+        put(static_cast<uint32_t>(value.size()));
+        out_.insert(out_.end(), value.begin(), value.end());
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// Bounds-checked reads; after the first overrun every read fails
+class PayloadReader {
+public:
+    PayloadReader(const uint8_t* data, size_t size) : at_(data), end_(data + size), ok_(true) {}
+    
+    bool ok() const { return ok_; }
+    
+    template <typename T>
+    bool get(T& value) {
+        if (!take(sizeof(T))) {
+            return false;
+        }
+        std::memcpy(&value, at_ - sizeof(T), sizeof(T));
+        return true;
+    }
+    
+    template <typename T>
+    bool getColumn(std::vector<T>& column, size_t rows) {
+        if (rows > static_cast<size_t>(end_ - at_) / sizeof(T) || !take(rows * sizeof(T))) {
+            ok_ = false;
+            return false;
+        }
+        column.resize(rows);
+        if (rows > 0) {
+            std::memcpy(column.data(), at_ - rows * sizeof(T), rows * sizeof(T));
+        }
+        return true;
+    }
+    
+    bool getString(std::string& value) {
+        uint32_t length = 0;
+        if (!get(length) || !take(length)) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(at_ - length), length);
+        return true;
+    }
+    
+    bool getCount(uint32_t& count, size_t min_item_bytes) {
+        // Rejects counts the remaining bytes cannot possibly hold
+        if (!get(count) || count > static_cast<size_t>(end_ - at_) / std::max<size_t>(min_item_bytes, 1)) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* at_;
+    const uint8_t* end_;
+    bool ok_;
+    
+    bool take(size_t bytes) {
+        if (!ok_ || bytes > static_cast<size_t>(end_ - at_)) {
+            ok_ = false;
+            return false;
+        }
+        at_ += bytes;
+        return true;
+    }
+};
+
+// Everything but the process table, shared by both encodings
+void encodeSystem(const Snapshot& snap, PayloadWriter& writer) {
+    writer.put(snap.version);
+    writer.put(snap.cpu_usage);
+    writer.put(snap.cpu_delta);
+    writer.put(static_cast<uint32_t>(snap.core_usage.size()));
+    writer.putColumn(snap.core_usage);
+    writer.put(snap.memory);
+    
+    writer.put(static_cast<uint32_t>(snap.disks.size()));
+    for (const auto& disk : snap.disks) {
+        writer.putString(disk.name);
+        writer.put(disk.major);
+        writer.put(disk.minor);
+        writer.put(static_cast<uint8_t>(disk.is_partition));
+        writer.put(disk.reads);
+        writer.put(disk.sectors_read);
+        writer.put(disk.read_time_ms);
+        writer.put(disk.writes);
+        writer.put(disk.sectors_written);
+        writer.put(disk.write_time_ms);
+        writer.put(disk.in_flight);
+        writer.put(disk.io_time_ms);
+        writer.put(disk.read_iops);
+        writer.put(disk.write_iops);
+        writer.put(disk.read_bytes_per_sec);
+        writer.put(disk.write_bytes_per_sec);
+        writer.put(disk.utilization);
+        writer.put(disk.avg_latency_ms);
+    }
+    
+    writer.put(static_cast<uint32_t>(snap.interfaces.size()));
+    for (const auto& iface : snap.interfaces) {
+        writer.putString(iface.name);
+        writer.put(iface.counters);
+        writer.put(iface.rx_bytes_per_sec);
+        writer.put(iface.tx_bytes_per_sec);
+        writer.put(iface.rx_packets_per_sec);
+        writer.put(iface.tx_packets_per_sec);
+        writer.put(iface.drops);
+        writer.put(iface.errors);
+    }
+    
+    writer.put(snap.pressure);
+    writer.put(static_cast<uint32_t>(snap.cgroup_pressure.size()));
+    for (const auto& group : snap.cgroup_pressure) {
+        writer.putString(group.path);
+        writer.put(group.cpu);
+        writer.put(group.memory);
+    }
+    writer.put(static_cast<uint32_t>(snap.cgroups.size()));
+    for (const auto& group : snap.cgroups) {
+        writer.putString(group.path);
+        writer.put(static_cast<uint64_t>(group.process_count));
+        writer.put(group.usage_usec);
+        writer.put(group.cpu_percent);
+        writer.put(group.memory_current);
+        writer.put(group.memory_max);
+    }
+    
+    writer.put(static_cast<uint64_t>(snap.process_count));
+    writer.put(static_cast<uint8_t>(snap.event_driven));
+    writer.put(snap.short_lived_count);
+    writer.put(snap.sampling);
+}
+
+void decodeSystem(PayloadReader& reader, Snapshot& snap) {
+    uint32_t count = 0;
+    reader.get(snap.version);
+    reader.get(snap.cpu_usage);
+    reader.get(snap.cpu_delta);
+    if (reader.getCount(count, sizeof(double))) {
+        reader.getColumn(snap.core_usage, count);
+    }
+    reader.get(snap.memory);
+    
+    uint8_t flag = 0;
+    snap.disks.clear();
+    if (reader.getCount(count, sizeof(uint32_t))) {
+        snap.disks.resize(count);
+    }
+    for (auto& disk : snap.disks) {
+        reader.getString(disk.name);
+        reader.get(disk.major);
+        reader.get(disk.minor);
+        reader.get(flag);
+        disk.is_partition = flag != 0;
+        reader.get(disk.reads);
+        reader.get(disk.sectors_read);
+        reader.get(disk.read_time_ms);
+        reader.get(disk.writes);
+        reader.get(disk.sectors_written);
+        reader.get(disk.write_time_ms);
+        reader.get(disk.in_flight);
+        reader.get(disk.io_time_ms);
+        reader.get(disk.read_iops);
+        reader.get(disk.write_iops);
+        reader.get(disk.read_bytes_per_sec);
+        reader.get(disk.write_bytes_per_sec);
+        reader.get(disk.utilization);
+        reader.get(disk.avg_latency_ms);
+    }
+    
+    snap.interfaces.clear();
+    if (reader.getCount(count, sizeof(uint32_t))) {
+        snap.interfaces.resize(count);
+    }
+    for (auto& iface : snap.interfaces) {
+        iface.active = true;
+        reader.getString(iface.name);
+        reader.get(iface.counters);
+        reader.get(iface.rx_bytes_per_sec);
+        reader.get(iface.tx_bytes_per_sec);
+        reader.get(iface.rx_packets_per_sec);
+        reader.get(iface.tx_packets_per_sec);
+        reader.get(iface.drops);
+        reader.get(iface.errors);
+    }
+    
+    reader.get(snap.pressure);
+    snap.cgroup_pressure.clear();
+    if (reader.getCount(count, sizeof(uint32_t))) {
+        snap.cgroup_pressure.resize(count);
+    }
+    for (auto& group : snap.cgroup_pressure) {
+        reader.getString(group.path);
+        reader.get(group.cpu);
+        reader.get(group.memory);
+    }
+    snap.cgroups.clear();
+    if (reader.getCount(count, sizeof(uint32_t))) {
+        snap.cgroups.resize(count);
+    }
+    for (auto& group : snap.cgroups) {
+        uint64_t process_count = 0;
+        reader.getString(group.path);
+        reader.get(process_count);
+        group.process_count = static_cast<size_t>(process_count);
+        reader.get(group.usage_usec);
+        reader.get(group.cpu_percent);
+        reader.get(group.memory_current);
+        reader.get(group.memory_max);
+    }
+    
+    uint64_t process_count = 0;
+    reader.get(process_count);
+    snap.process_count = static_cast<size_t>(process_count);
+    reader.get(flag);
+    snap.event_driven = flag != 0;
+    reader.get(snap.short_lived_count);
+    reader.get(snap.sampling);
+}
+
+} // namespace
+
+void encodeSnapshot(const Snapshot& snap, std::vector<uint8_t>& out) {
+    PayloadWriter writer(out);
+    encodeSystem(snap, writer);
+    
+    // Names and users become indices into a table of just the strings
+    // this tick uses
+    thread_local std::vector<uint32_t> local_ids;
+    thread_local std::vector<StringPool::Id> used;
+    thread_local std::vector<uint32_t> names;
+    thread_local std::vector<uint32_t> users;
+    const ProcessTable& table = snap.processes;
+    local_ids.assign(snap.strings.size(), kNoString);
+    used.clear();
+    auto localId = [&](StringPool::Id id) {
+        if (local_ids[id] == kNoString) {
+            local_ids[id] = static_cast<uint32_t>(used.size());
+            used.push_back(id);
+        }
+        return local_ids[id];
+    };
+    names.resize(table.size());
+    users.resize(table.size());
+    for (size_t row = 0; row < table.size(); ++row) {
+        names[row] = localId(table.name[row]);
+        users[row] = localId(table.user[row]);
+    }
+    writer.put(static_cast<uint32_t>(used.size()));
+    for (StringPool::Id id : used) {
+        writer.putString(snap.strings.get(id));
+    }
+    
+    writer.put(static_cast<uint32_t>(table.size()));
+    writer.putColumn(table.pid);
+    writer.putColumn(table.ppid);
+    writer.putColumn(table.start_time);
+    writer.putColumn(names);
+    writer.putColumn(users);
+    writer.putColumn(table.state);
+    writer.putColumn(table.num_threads);
+    writer.putColumn(table.cpu_percent);
+    writer.putColumn(table.memory_percent);
+    writer.putColumn(table.memory_bytes);
+    writer.putColumn(table.io_read_rate);
+    writer.putColumn(table.io_write_rate);
+    writer.putColumn(table.io_syscr_rate);
+    writer.putColumn(table.io_syscw_rate);
+    writer.putColumn(table.io_available);
+    writer.putColumn(table.sample_age);
+    writer.putColumn(table.footprint);
+    writer.putColumn(table.footprint_age);
+}
+
+bool decodeSnapshot(const uint8_t* data, size_t size, Snapshot& snap) {
+    PayloadReader reader(data, size);
+    decodeSystem(reader, snap);
+    
+    uint32_t count = 0;
+    thread_local std::vector<StringPool::Id> pool_ids;
+    thread_local std::string value;
+    pool_ids.clear();
+    if (reader.getCount(count, sizeof(uint32_t))) {
+        for (uint32_t i = 0; i < count && reader.getString(value); ++i) {
+            pool_ids.push_back(snap.strings.intern(value));
+        }
+    }
+    
+    ProcessTable& table = snap.processes;
+    uint32_t rows = 0;
+    reader.getCount(rows, sizeof(int));
+    reader.getColumn(table.pid, rows);
+    reader.getColumn(table.ppid, rows);
+    reader.getColumn(table.start_time, rows);
+    reader.getColumn(table.name, rows);
+    reader.getColumn(table.user, rows);
+    reader.getColumn(table.state, rows);
+    reader.getColumn(table.num_threads, rows);
+    reader.getColumn(table.cpu_percent, rows);
+    reader.getColumn(table.memory_percent, rows);
+    reader.getColumn(table.memory_bytes, rows);
+    reader.getColumn(table.io_read_rate, rows);
+    reader.getColumn(table.io_write_rate, rows);
+    reader.getColumn(table.io_syscr_rate, rows);
+    reader.getColumn(table.io_syscw_rate, rows);
+    reader.getColumn(table.io_available, rows);
+    reader.getColumn(table.sample_age, rows);
+    reader.getColumn(table.footprint, rows);
+    reader.getColumn(table.footprint_age, rows);
+    if (!reader.ok()) {
+        table.clear();
+        return false;
+    }
+    
+    // Local string indices back to IDs in the snapshot's pool
+    for (size_t row = 0; row < rows; ++row) {
+        if (table.name[row] >= pool_ids.size() || table.user[row] >= pool_ids.size()) {
+            table.clear();
+            return false;
+        }
+        table.name[row] = pool_ids[table.name[row]];
+        table.user[row] = pool_ids[table.user[row]];
+    }
+    return true;
+}
+
+void encodeCompactSnapshot(const Snapshot& snap, ProcessTableEncoder& encoder, bool keyframe,
+                           std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    PayloadWriter writer(out);
+    writer.put(uint32_t(0));
+    encodeSystem(snap, writer);
+    const uint32_t system_bytes = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+    std::memcpy(out.data() + start, &system_bytes, sizeof(system_bytes));
+    encoder.encode(snap.processes, snap.strings, keyframe, out);
+}
+
+CaptureWriter::CaptureWriter()
+    : fd_(-1), map_(nullptr), map_size_(0), encoding_(CaptureEncoding::Compact), keyframe_due_(true) {}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path, CaptureEncoding encoding) {
+    close();
+    encoding_ = encoding;
+    keyframe_due_ = true;
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        return false;
+    }
+    if (!reserve(sizeof(CaptureHeader))) {
+        const int saved = errno;
+        close();
+        errno = saved;
+        return false;
+    }
+    
+    CaptureHeader& h = header();
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kCaptureMagic, sizeof(h.magic));
+    h.version = kCaptureVersion;
+    h.header_size = sizeof(CaptureHeader);
+    h.data_end = sizeof(CaptureHeader);
+    h.index_entries = kCaptureIndexEntries;
+    return true;
+}
+
+bool CaptureWriter::reserve(size_t size) {
+    if (size <= map_size_) {
+        return true;
+    }
+    size_t new_size = std::max(map_size_, kMinMapping);
+    while (new_size < size) {
+        new_size += std::min(new_size, kMaxGrowStep);
+    }
+    
+    // Before unmapping, so on failure the ticks so far stay mapped and
+    // close() can still trim the file
+    if (!allocateFile(fd_, map_size_, new_size)) {
+        return false;
+    }
+    if (map_) {
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    void* mapped = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    map_ = static_cast<uint8_t*>(mapped);
+    map_size_ = new_size;
+    return true;
+}
+
+bool CaptureWriter::append(const Snapshot& snap, int64_t wall_ns) {
+    if (!map_) {
+        errno = EBADF;
+        return false;
+    }
+    payload_.clear();
+    uint32_t flags = 0;
+    if (encoding_ == CaptureEncoding::Compact) {
+        const bool keyframe = keyframe_due_ || encoder_.needsKeyframe(snap.strings) ||
+                              header().tick_count % kCaptureKeyframeInterval == 0;
+        flags = keyframe ? kCaptureCompact | kCaptureKeyframe : kCaptureCompact;
+        encodeCompactSnapshot(snap, encoder_, keyframe, payload_);
+        // Cleared only once the tick is in the file, since the encoder
+        // has already moved on to it
+        keyframe_due_ = true;
+    } else {
+        encodeSnapshot(snap, payload_);
+    }
+    if (payload_.size() > std::numeric_limits<uint32_t>::max()) {
+        errno = EFBIG;
+        return false;
+    }
+    
+    // A full (or missing) index block is followed by a fresh one
+    uint64_t offset = header().data_end;
+    const uint64_t last_index = header().last_index;
+    const bool new_block = last_index == 0 ||
+        reinterpret_cast<const CaptureIndexBlock*>(map_ + last_index)->count == kCaptureIndexEntries;
+    uint64_t block_offset = 0;
+    if (new_block) {
+        block_offset = align8(offset);
+        offset = block_offset + indexBlockBytes(kCaptureIndexEntries);
+    }
+    const uint64_t payload_offset = align8(offset);
+    const uint64_t end = payload_offset + payload_.size();
+    if (!reserve(end)) {
+        return false;
+    }
+    
+    // Everything is in place before the header counts it
+    CaptureHeader& h = header();
+    if (new_block) {
+        auto* block = reinterpret_cast<CaptureIndexBlock*>(map_ + block_offset);
+        block->next = 0;
+        block->count = 0;
+        block->capacity = kCaptureIndexEntries;
+        if (h.last_index != 0) {
+            reinterpret_cast<CaptureIndexBlock*>(map_ + h.last_index)->next = block_offset;
+        } else {
+            h.first_index = block_offset;
+        }
+        h.last_index = block_offset;
+    }
+    std::memcpy(map_ + payload_offset, payload_.data(), payload_.size());
+    
+    auto* block = reinterpret_cast<CaptureIndexBlock*>(map_ + h.last_index);
+    auto* entries = reinterpret_cast<CaptureIndexEntry*>(block + 1);
+    CaptureIndexEntry& entry = entries[block->count];
+    entry.offset = payload_offset;
+    entry.length = static_cast<uint32_t>(payload_.size());
+    entry.flags = flags;
+    entry.wall_ns = wall_ns;
+    ++block->count;
+    h.data_end = end;
+    ++h.tick_count;
+    keyframe_due_ = false;
+    return true;
+}
+
+bool CaptureWriter::close() {
+    if (fd_ < 0) {
+        return true;
+    }
+    size_t used = 0;
+    if (map_) {
+        used = header().data_end;
+        munmap(map_, map_size_);
+        map_ = nullptr;
+        map_size_ = 0;
+    }
+    // Drop the unused tail of the last growth step
+    const bool trimmed = used == 0 || ftruncate(fd_, static_cast<off_t>(used)) == 0;
+    ::close(fd_);
+    fd_ = -1;
+    return trimmed;
+}
+
+uint64_t CaptureWriter::tickCount() const {
+    return map_ ? header().tick_count : 0;
+}
+
+uint64_t CaptureWriter::bytesWritten() const {
+    return map_ ? header().data_end : 0;
+}
+
+CaptureReader::CaptureReader()
+    : fd_(-1), map_(nullptr), map_size_(0), tick_count_(0), decoded_tick_(kNoTick) {}
+
+CaptureReader::~CaptureReader() {
+    if (map_) {
+        munmap(const_cast<uint8_t*>(map_), map_size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+        return false;
+    }
+    if (static_cast<size_t>(info.st_size) < sizeof(CaptureHeader)) {
+        errno = EINVAL;
+        return false;
+    }
+    map_size_ = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        map_size_ = 0;
+        return false;
+    }
+    map_ = static_cast<const uint8_t*>(mapped);
+    
+    CaptureHeader h;
+    std::memcpy(&h, map_, sizeof(h));
+    if (std::memcmp(h.magic, kCaptureMagic, sizeof(h.magic)) != 0 || h.version != kCaptureVersion ||
+        h.header_size != sizeof(CaptureHeader) || h.index_entries == 0) {
+        errno = EINVAL;
+        return false;
+    }
+    
+    // Only the block headers are touched; a capture of any size opens in
+    // as many page faults as it has index blocks
+    const size_t block_bytes = indexBlockBytes(h.index_entries);
+    size_t total = 0;
+    uint64_t offset = h.first_index;
+    while (offset != 0) {
+        if (offset % 8 != 0 || offset < sizeof(CaptureHeader) || block_bytes > map_size_ ||
+            offset > map_size_ - block_bytes) {
+            break;
+        }
+        const auto* block = reinterpret_cast<const CaptureIndexBlock*>(map_ + offset);
+        if (block->capacity != h.index_entries || block->count > block->capacity) {
+            break;
+        }
+        blocks_.push_back(block);
+        total += block->count;
+        // Every block but the last is full, so tick n is in block n / capacity
+        if (block->count < block->capacity || block->next <= offset) {
+            break;
+        }
+        offset = block->next;
+    }
+    tick_count_ = std::min<size_t>(total, h.tick_count);
+    return true;
+}
+
+const CaptureIndexEntry& CaptureReader::entry(size_t tick) const {
+    const CaptureIndexBlock* block = blocks_[tick / blocks_.front()->capacity];
+    return reinterpret_cast<const CaptureIndexEntry*>(block + 1)[tick % block->capacity];
+}
+
+size_t CaptureReader::findTick(int64_t wall_ns) const {
+    size_t low = 0;
+    size_t high = tick_count_;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (wallTime(mid) <= wall_ns) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+bool CaptureReader::payload(size_t tick, const uint8_t*& data, size_t& size) const {
+    const CaptureIndexEntry& e = entry(tick);
+    if (e.offset > map_size_ || e.length > map_size_ - e.offset) {
+        return false;
+    }
+    data = map_ + e.offset;
+    size = e.length;
+    return true;
+}
+
+bool CaptureReader::decodeTable(size_t tick) {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    uint32_t system_bytes = 0;
+    if (!payload(tick, data, size) || size < sizeof(system_bytes)) {
+        return false;
+    }
+    std::memcpy(&system_bytes, data, sizeof(system_bytes));
+    if (system_bytes > size - sizeof(system_bytes)) {
+        return false;
+    }
+    const size_t skip = sizeof(system_bytes) + system_bytes;
+    return decoder_.decode(data + skip, size - skip, (entry(tick).flags & kCaptureKeyframe) != 0);
+}
+
+bool CaptureReader::read(size_t tick, Snapshot& snap) {
+    if (tick >= tick_count_) {
+        return false;
+    }
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    if (!payload(tick, data, size)) {
+        return false;
+    }
+    if (!(entry(tick).flags & kCaptureCompact)) {
+        return decodeSnapshot(data, size, snap);
+    }
+    
+    if (tick != decoded_tick_) {
+        // Decoding resumes after the tick the decoder holds when no keyframe
+        // comes between, so playing forward decodes one tick at a time
+        size_t from = tick;
+        while (from > 0 && !(entry(from).flags & kCaptureKeyframe) &&
+               !(decoded_tick_ != kNoTick && from == decoded_tick_ + 1)) {
+            --from;
+        }
+        decoded_tick_ = kNoTick;
+        for (size_t t = from; t <= tick; ++t) {
+            if (!decodeTable(t)) {
+                return false;
+            }
+        }
+        decoded_tick_ = tick;
+    }
+    
+    uint32_t system_bytes = 0;
+    std::memcpy(&system_bytes, data, sizeof(system_bytes));
+    PayloadReader reader(data + sizeof(system_bytes), system_bytes);
+    decodeSystem(reader, snap);
+    if (!reader.ok()) {
+        return false;
+    }
+    decoder_.output(snap.processes, snap.strings);
+    return true;
+}
@@ -0,0 +1,683 @@
+#include "capture_codec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t kNoId = std::numeric_limits<uint32_t>::max();
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+uint64_t bitsOf(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Bounds-checked reads; after the first overrun every read fails
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : at_(data), end_(data + size), ok_(true) {}
+    
+    bool ok() const { return ok_; }
+    void fail() { ok_ = false; }
+    const uint8_t* position() const { return at_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - at_); }
+    
+    bool getVarint(uint64_t& value) {
+        value = 0;
+        for (unsigned shift = 0; ok_ && at_ < end_ && shift < 64; shift += 7) {
+            const uint8_t byte = *at_++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        ok_ = false;
+        return false;
+    }
+    
+    // Rejects counts above limit, so a corrupt count cannot size a buffer
+    bool getCount(size_t& count, size_t limit) {
+        uint64_t value = 0;
+        if (!getVarint(value) || value > limit) {
+            ok_ = false;
+            return false;
+        }
+        count = static_cast<size_t>(value);
+        return true;
+    }
+    
+    bool getString(std::string& value) {
+        size_t length = 0;
+        if (!getCount(length, remaining())) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(at_), length);
+        at_ += length;
+        return true;
+    }
+
+private:
+    const uint8_t* at_;
+    const uint8_t* end_;
+    bool ok_;
+};
+
+// Bits are packed most significant first, gathered a 64-bit word at a
+// time; flush writes out the last partial word, padded to a byte
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out), pending_(0), count_(0) {}
+    
+    void bit(unsigned value) {
+        pending_ = (pending_ << 1) | value;
+        if (++count_ == 64) {
+            writeBytes(pending_, 8);
+            count_ = 0;
+        }
+    }
+    
+    void put(uint64_t value, unsigned width) {
+        if (width < 64) {
+            value &= (uint64_t(1) << width) - 1;
+        }
+        const unsigned room = 64 - count_;
+        if (width < room) {
+            pending_ = (pending_ << width) | value;
+            count_ += width;
+            return;
+        }
+        // Completes the word; what does not fit starts the next one
+        const unsigned spill = width - room;
+        writeBytes(room == 64 ? value : (pending_ << room) | (value >> spill), 8);
+        pending_ = value;
+        count_ = spill;
+    }
+    
+    void flush() {
+        if (count_ > 0) {
+            writeBytes(pending_ << (64 - count_), (count_ + 7) / 8);
+            count_ = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t pending_; // only the low count_ bits are unwritten
+    unsigned count_;
+    
+    void writeBytes(uint64_t word, unsigned bytes) {
+        for (unsigned i = 0; i < bytes; ++i) {
+            out_.push_back(static_cast<uint8_t>(word >> (56 - 8 * i)));
+        }
+    }
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data_(data), bits_(size * 8), at_(0), ok_(true) {}
+    
+    bool ok() const { return ok_; }
+    // For a value that was read in full but makes no sense
+    void fail() { ok_ = false; }
+    
+    bool bit(uint64_t& value) {
+        if (!ok_ || at_ == bits_) {
+            ok_ = false;
+            return false;
+        }
+        value = (data_[at_ / 8] >> (7 - at_ % 8)) & 1;
+        ++at_;
+        return true;
+    }
+    
+    bool get(unsigned width, uint64_t& value) {
+        value = 0;
+        if (!ok_ || width > bits_ - at_) {
+            ok_ = false;
+            return false;
+        }
+        while (width > 0) {
+            const unsigned offset = static_cast<unsigned>(at_ % 8);
+            const unsigned take = std::min(width, 8 - offset);
+            const unsigned byte = data_[at_ / 8];
+            value = (value << take) | ((byte >> (8 - offset - take)) & ((1u << take) - 1));
+            at_ += take;
+            width -= take;
+        }
+        return true;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t bits_;
+    size_t at_;
+    bool ok_;
+};
+
+// One double column, each value XORed with its reference (Gorilla). An
+// unchanged value is '0'. Otherwise '1', then '0' and the meaningful bits
+// when they fit the window of the last stored XOR, or '1', 6 bits of
+// leading zeros, 6 bits of length - 1, and the meaningful bits.
+class XorWriter {
+public:
+    explicit XorWriter(BitWriter& bits) : bits_(bits), leading_(0), trailing_(0), window_(false) {}
+    
+    void add(double value, double reference) {
+        const uint64_t x = bitsOf(value) ^ bitsOf(reference);
+        if (x == 0) {
+            bits_.bit(0);
+            return;
+        }
+        const unsigned leading = static_cast<unsigned>(__builtin_clzll(x));
+        const unsigned trailing = static_cast<unsigned>(__builtin_ctzll(x));
+        if (window_ && leading >= leading_ && trailing >= trailing_) {
+            bits_.put(0x2, 2);
+            bits_.put(x >> trailing_, 64 - leading_ - trailing_);
+            return;
+        }
+        window_ = true;
+        leading_ = leading;
+        trailing_ = trailing;
+        const unsigned length = 64 - leading - trailing;
+        bits_.put(0x3, 2);
+        bits_.put(leading, 6);
+        bits_.put(length - 1, 6);
+        bits_.put(x >> trailing, length);
+    }
+
+private:
+    BitWriter& bits_;
+    unsigned leading_;
+    unsigned trailing_;
+    bool window_;
+};
+
+class XorReader {
+public:
+    explicit XorReader(BitReader& bits) : bits_(bits), leading_(0), trailing_(0), window_(false) {}
+    
+    bool next(double reference, double& value) {
+        uint64_t flag = 0;
+        if (!bits_.bit(flag)) {
+            return false;
+        }
+        if (flag == 0) {
+            value = reference;
+            return true;
+        }
+        if (!bits_.bit(flag)) {
+            return false;
+        }
+        if (flag == 1) {
+            uint64_t leading = 0;
+            uint64_t length = 0;
+            if (!bits_.get(6, leading) || !bits_.get(6, length)) {
+                return false;
+            }
+            if (leading + length + 1 > 64) {
+                bits_.fail();
+                return false;
+            }
+            leading_ = static_cast<unsigned>(leading);
+            trailing_ = static_cast<unsigned>(64 - leading - length - 1);
+            window_ = true;
+        } else if (!window_) {
+            // Reuses a window that was never stored
+            bits_.fail();
+            return false;
+        }
+        uint64_t meaningful = 0;
+        if (!bits_.get(64 - leading_ - trailing_, meaningful)) {
+            return false;
+        }
+        value = fromBits(bitsOf(reference) ^ (meaningful << trailing_));
+        return true;
+    }
+
+private:
+    BitReader& bits_;
+    unsigned leading_;
+    unsigned trailing_;
+    bool window_;
+};
+
+// One integer column as deltas: the number of unchanged rows, then the
+// zigzag delta of the next changed row, and so on; a trailing run of
+// unchanged rows is one count
+class RunWriter {
+public:
+    explicit RunWriter(std::vector<uint8_t>& out) : out_(out), unchanged_(0) {}
+    
+    // Arithmetic wraps, so any integer type goes through uint64_t
+    void add(uint64_t value, uint64_t reference) {
+        const int64_t delta = static_cast<int64_t>(value - reference);
+        if (delta == 0) {
+            ++unchanged_;
+            return;
+        }
+        putVarint(out_, unchanged_);
+        putVarint(out_, zigzag(delta));
+        unchanged_ = 0;
+    }
+    
+    void finish() {
+        if (unchanged_ > 0) {
+            putVarint(out_, unchanged_);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t unchanged_;
+};
+
+// Reads a column written by RunWriter, calling apply(row, delta) for each
+// row in order
+template <typename Apply>
+bool getRuns(ByteReader& in, size_t rows, Apply apply) {
+    size_t row = 0;
+    while (row < rows) {
+        size_t unchanged = 0;
+        if (!in.getCount(unchanged, rows - row)) {
+            return false;
+        }
+        for (const size_t end = row + unchanged; row < end; ++row) {
+            apply(row, 0);
+        }
+        if (row == rows) {
+            break;
+        }
+        uint64_t value = 0;
+        if (!in.getVarint(value) || value == 0) {
+            in.fail();
+            return false;
+        }
+        apply(row++, static_cast<uint64_t>(unzigzag(value)));
+    }
+    return true;
+}
+
+// The reference for a surviving process is its value last tick, except
+// in an age column, where a nonzero age is expected to grow by one
+template <typename T>
+struct IntColumn {
+    std::vector<T> ProcessTable::* column;
+    bool age;
+    
+    uint64_t get(const ProcessTable& table, size_t row) const {
+        return static_cast<uint64_t>((table.*column)[row]);
+    }
+    uint64_t predict(const ProcessTable& table, size_t row) const {
+        const uint64_t value = get(table, row);
+        return age && value > 0 ? value + 1 : value;
+    }
+    void set(ProcessTable& table, size_t row, uint64_t value) const {
+        (table.*column)[row] = static_cast<T>(value);
+    }
+};
+
+struct FootprintColumn {
+    uint64_t MemoryFootprint::* field;
+    
+    uint64_t get(const ProcessTable& table, size_t row) const { return table.footprint[row].*field; }
+    uint64_t predict(const ProcessTable& table, size_t row) const { return get(table, row); }
+    void set(ProcessTable& table, size_t row, uint64_t value) const { table.footprint[row].*field = value; }
+};
+
+// Integer columns in encoding order; start time is encoded on its own
+template <typename Visit>
+void forEachIntColumn(Visit visit) {
+    visit(IntColumn<int>{&ProcessTable::ppid, false});
+    visit(IntColumn<StringPool::Id>{&ProcessTable::name, false});
+    visit(IntColumn<StringPool::Id>{&ProcessTable::user, false});
+    visit(IntColumn<char>{&ProcessTable::state, false});
+    visit(IntColumn<int>{&ProcessTable::num_threads, false});
+    visit(IntColumn<uint64_t>{&ProcessTable::memory_bytes, false});
+    visit(IntColumn<uint8_t>{&ProcessTable::io_available, false});
+    // Carried-over rows age by one every tick until sampled again
+    visit(IntColumn<unsigned>{&ProcessTable::sample_age, true});
+    visit(FootprintColumn{&MemoryFootprint::rss});
+    visit(FootprintColumn{&MemoryFootprint::pss});
+    visit(FootprintColumn{&MemoryFootprint::uss});
+    visit(FootprintColumn{&MemoryFootprint::swap});
+    visit(FootprintColumn{&MemoryFootprint::swap_pss});
+}
+
+template <typename Visit>
+void forEachDoubleColumn(Visit visit) {
+    visit(&ProcessTable::cpu_percent);
+    visit(&ProcessTable::memory_percent);
+    visit(&ProcessTable::io_read_rate);
+    visit(&ProcessTable::io_write_rate);
+    visit(&ProcessTable::io_syscr_rate);
+    visit(&ProcessTable::io_syscw_rate);
+    visit(&ProcessTable::footprint_age);
+}
+
+void resizeTable(ProcessTable& table, size_t rows) {
+    table.pid.resize(rows);
+    table.ppid.resize(rows);
+    table.start_time.resize(rows);
+    table.name.resize(rows);
+    table.user.resize(rows);
+    table.state.resize(rows);
+    table.num_threads.resize(rows);
+    table.cpu_percent.resize(rows);
+    table.memory_percent.resize(rows);
+    table.memory_bytes.resize(rows);
+    table.io_read_rate.resize(rows);
+    table.io_write_rate.resize(rows);
+    table.io_syscr_rate.resize(rows);
+    table.io_syscw_rate.resize(rows);
+    table.io_available.resize(rows);
+    table.sample_age.resize(rows);
+    table.footprint.resize(rows);
+    table.footprint_age.resize(rows);
+}
+
+void putPids(std::vector<uint8_t>& out, const std::vector<int>& pids) {
+    putVarint(out, pids.size());
+    int last = 0;
+    for (int pid : pids) {
+        putVarint(out, static_cast<uint32_t>(pid - last));
+        last = pid;
+    }
+}
+
+// Ascending and positive, as the table keeps them
+bool getPids(ByteReader& in, std::vector<int>& pids, size_t limit) {
+    size_t count = 0;
+    pids.clear();
+    if (!in.getCount(count, std::min(limit, in.remaining()))) {
+        return false;
+    }
+    int64_t last = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t delta = 0;
+        if (!in.getVarint(delta) || delta == 0 ||
+            delta > static_cast<uint64_t>(std::numeric_limits<int>::max() - last)) {
+            in.fail();
+            return false;
+        }
+        last += static_cast<int64_t>(delta);
+        pids.push_back(static_cast<int>(last));
+    }
+    return true;
+}
+
+} // namespace
+
+ProcessTableEncoder::ProcessTableEncoder() : dictionary_(new StringPool()), dictionary_sent_(1), encodes_(0), pool_generation_(0) {}
+
+void ProcessTableEncoder::reset() {
+    previous_.clear();
+    dictionary_.reset(new StringPool());
+    dictionary_sent_ = 1; // the empty string is ID 0 on both sides
+    pool_to_dictionary_.clear();
+    pool_checked_.clear();
+}
+
+uint32_t ProcessTableEncoder::dictionaryId(StringPool::Id id, const StringPool& strings) {
+    uint32_t& cached = pool_to_dictionary_[id];
+    if (pool_checked_[id] == encodes_) {
+        return cached;
+    }
+    pool_checked_[id] = encodes_;
+    const std::string& value = strings.get(id);
+    if (cached == kNoId || cached >= dictionary_->size() || dictionary_->get(cached) != value) {
+        cached = dictionary_->intern(value);
+    }
+    return cached;
+}
+
+void ProcessTableEncoder::encode(const ProcessTable& table, const StringPool& strings, bool keyframe,
+                                 std::vector<uint8_t>& out) {
+    if (keyframe) {
+        reset();
+    }
+    const size_t rows = table.size();
+    current_ = table;
+    ++encodes_;
+    pool_generation_ = strings.generation();
+    pool_to_dictionary_.resize(std::max(pool_to_dictionary_.size(), strings.size()), kNoId);
+    pool_checked_.resize(pool_to_dictionary_.size(), encodes_ - 1);
+    for (size_t row = 0; row < rows; ++row) {
+        current_.name[row] = dictionaryId(table.name[row], strings);
+        current_.user[row] = dictionaryId(table.user[row], strings);
+    }
+    
+    // Both tables are in PID order; a reused PID is a new process
+    source_.assign(rows, -1);
+    removed_.clear();
+    added_.clear();
+    size_t before = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        const int pid = current_.pid[row];
+        while (before < previous_.size() && previous_.pid[before] < pid) {
+            removed_.push_back(previous_.pid[before++]);
+        }
+        if (before < previous_.size() && previous_.pid[before] == pid) {
+            if (previous_.start_time[before] == current_.start_time[row]) {
+                source_[row] = static_cast<int32_t>(before);
+            } else {
+                removed_.push_back(pid);
+                added_.push_back(pid);
+            }
+            ++before;
+        } else {
+            added_.push_back(pid);
+        }
+    }
+    while (before < previous_.size()) {
+        removed_.push_back(previous_.pid[before++]);
+    }
+    
+    putVarint(out, rows);
+    putPids(out, removed_);
+    putPids(out, added_);
+    putVarint(out, dictionary_->size() - dictionary_sent_);
+    for (size_t id = dictionary_sent_; id < dictionary_->size(); ++id) {
+        const std::string& value = dictionary_->get(static_cast<StringPool::Id>(id));
+        putVarint(out, value.size());
+        out.insert(out.end(), value.begin(), value.end());
+    }
+    dictionary_sent_ = dictionary_->size();
+    
+    forEachIntColumn([&](const auto& column) {
+        RunWriter writer(out);
+        for (size_t row = 0; row < rows; ++row) {
+            const uint64_t reference = source_[row] >= 0 ? column.predict(previous_, source_[row]) : 0;
+            writer.add(column.get(current_, row), reference);
+        }
+        writer.finish();
+    });
+    
+    // A surviving process keeps its start time, so only new ones cost
+    // anything; they tend to arrive in PID order, close together
+    RunWriter start_times(out);
+    uint64_t last_start = 0;
+    uint64_t last_step = 0;
+    for (size_t row = 0; row < rows; ++row) {
+        if (source_[row] >= 0) {
+            start_times.add(0, 0);
+            continue;
+        }
+        const uint64_t step = current_.start_time[row] - last_start;
+        start_times.add(step, last_step);
+        last_start = current_.start_time[row];
+        last_step = step;
+    }
+    start_times.finish();
+    
+    BitWriter bits(out);
+    forEachDoubleColumn([&](std::vector<double> ProcessTable::* column) {
+        XorWriter writer(bits);
+        for (size_t row = 0; row < rows; ++row) {
+            const double reference = source_[row] >= 0 ? (previous_.*column)[source_[row]] : 0.0;
+            writer.add((current_.*column)[row], reference);
+        }
+    });
+    bits.flush();
+    
+    std::swap(previous_, current_);
+}
+
+ProcessTableDecoder::ProcessTableDecoder() : dictionary_(1), primed_(false) {}
+
+void ProcessTableDecoder::reset() {
+    previous_.clear();
+    dictionary_.assign(1, std::string());
+    primed_ = false;
+}
+
+bool ProcessTableDecoder::decode(const uint8_t* data, size_t size, bool keyframe) {
+    if (keyframe) {
+        reset();
+    } else if (!primed_) {
+        return false;
+    }
+    // Stays unprimed unless this tick decodes in full
+    primed_ = false;
+    ByteReader in(data, size);
+    
+    size_t rows = 0;
+    if (!in.getCount(rows, previous_.size() + in.remaining()) ||
+        !getPids(in, removed_, previous_.size()) || !getPids(in, added_, rows) ||
+        previous_.size() - removed_.size() + added_.size() != rows) {
+        return false;
+    }
+    
+    // Survivors of the previous tick merged with the new PIDs
+    resizeTable(current_, rows);
+    source_.resize(rows);
+    size_t filled = 0;
+    size_t removed = 0;
+    size_t added = 0;
+    auto emit = [&](int pid, int32_t source) {
+        if (filled == rows) {
+            return false;
+        }
+        current_.pid[filled] = pid;
+        source_[filled++] = source;
+        return true;
+    };
+    for (size_t before = 0; before < previous_.size(); ++before) {
+        const int pid = previous_.pid[before];
+        if (removed < removed_.size() && removed_[removed] == pid) {
+            ++removed;
+            continue;
+        }
+        while (added < added_.size() && added_[added] < pid) {
+            if (!emit(added_[added++], -1)) {
+                return false;
+            }
+        }
+        if ((added < added_.size() && added_[added] == pid) || !emit(pid, static_cast<int32_t>(before))) {
+            return false;
+        }
+    }
+    while (added < added_.size()) {
+        if (!emit(added_[added++], -1)) {
+            return false;
+        }
+    }
+    if (removed != removed_.size() || filled != rows) {
+        return false;
+    }
+    
+    size_t new_strings = 0;
+    if (!in.getCount(new_strings, in.remaining())) {
+        return false;
+    }
+    for (size_t i = 0; i < new_strings; ++i) {
+        dictionary_.emplace_back();
+        if (!in.getString(dictionary_.back())) {
+            return false;
+        }
+    }
+    
+    forEachIntColumn([&](const auto& column) {
+        getRuns(in, rows, [&](size_t row, uint64_t delta) {
+            const uint64_t reference = source_[row] >= 0 ? column.predict(previous_, source_[row]) : 0;
+            column.set(current_, row, reference + delta);
+        });
+    });
+    
+    uint64_t last_start = 0;
+    uint64_t last_step = 0;
+    getRuns(in, rows, [&](size_t row, uint64_t delta) {
+        if (source_[row] >= 0) {
+            current_.start_time[row] = previous_.start_time[source_[row]] + delta;
+            return;
+        }
+        last_step += delta;
+        last_start += last_step;
+        current_.start_time[row] = last_start;
+    });
+    if (!in.ok()) {
+        return false;
+    }
+    
+    BitReader bits(in.position(), in.remaining());
+    forEachDoubleColumn([&](std::vector<double> ProcessTable::* column) {
+        XorReader reader(bits);
+        for (size_t row = 0; row < rows; ++row) {
+            const double reference = source_[row] >= 0 ? (previous_.*column)[source_[row]] : 0.0;
+            if (!reader.next(reference, (current_.*column)[row])) {
+                break;
+            }
+        }
+    });
+    // Every failed next() leaves the reader failed, so the columns after
+    // one that stopped early read nothing and the tick is rejected
+    if (!bits.ok()) {
+        return false;
+    }
+    for (size_t row = 0; row < rows; ++row) {
+        if (current_.name[row] >= dictionary_.size() || current_.user[row] >= dictionary_.size()) {
+            return false;
+        }
+    }
+    
+    std::swap(previous_, current_);
+    primed_ = true;
+    return true;
+}
+
+void ProcessTableDecoder::output(ProcessTable& table, StringPool& strings) {
+    table = previous_;
+    dictionary_to_pool_.assign(dictionary_.size(), kNoId);
+    auto poolId = [&](uint32_t id) {
+        if (dictionary_to_pool_[id] == kNoId) {
+            dictionary_to_pool_[id] = strings.intern(dictionary_[id]);
+        }
+        return dictionary_to_pool_[id];
+    };
+    for (size_t row = 0; row < table.size(); ++row) {
+        table.name[row] = poolId(table.name[row]);
+        table.user[row] = poolId(table.user[row]);
+    }
+}
@@ -1,32 +1,261 @@
 #include "fuzzy_search.hpp"
 #include <algorithm>
-#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
-int FuzzySearch::levenshteinDistance(const std::string& s1, const std::string& s2) {
-    const size_t m = s1.size();
-    const size_t n = s2.size();
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define TBM_SEARCH_X86 1
+#endif
+
+namespace {
+
+// Longest pattern the bit-parallel distance takes: one bit per character
+constexpr size_t kWordBits = 64;
+
+// Myers' bit-parallel edit distance, in Hyyrö's formulation. Each DP
+// column is kept as two bit vectors marking where it steps up or down by
+// one from the row above, so a text character advances the whole column
+// in a few word operations. The last row can only fall by one per
+// remaining text character, which gives the early exit.
+int bitParallelDistance(const std::string& pattern, const std::string& text, int limit) {
+    // Only entries for characters of the text are ever read
+    uint64_t peq[256];
+    for (unsigned char c : text) peq[c] = 0;
+    for (unsigned char c : pattern) peq[c] = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+    
+    const uint64_t last = uint64_t(1) << (pattern.size() - 1);
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    int score = static_cast<int>(pattern.size());
+    int remaining = static_cast<int>(text.size());
+    for (unsigned char c : text) {
+        const uint64_t eq = peq[c];
+        const uint64_t xv = eq | mv;
+        const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            ++score;
+        } else if (mh & last) {
+            --score;
+        }
+        // Row 0 grows by one per text character
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        if (score - --remaining > limit) {
+            return limit + 1;
+        }
+    }
+    return std::min(score, limit + 1);
+}
+
+// Ukkonen's band: an alignment with at most limit edits stays within limit
+// cells of the diagonal, so only those cells are computed. The row is
+// reused across calls and only grows for a longer string than any before.
+// Needs both strings non-empty and their lengths at most limit apart.
+int bandedDistance(const std::string& s1, const std::string& s2, int limit) {
+    const int m = static_cast<int>(s1.size());
+    const int n = static_cast<int>(s2.size());
+    const int over = limit + 1;
+    thread_local std::vector<int> row;
+    row.resize(static_cast<size_t>(n) + 1);
+    for (int j = 0; j <= n; ++j) {
+        row[j] = std::min(j, over);
+    }
+    
+    for (int i = 1; i <= m; ++i) {
+        const int lo = std::max(1, i - limit);
+        const int hi = std::min(n, i + limit);
+        int diag = row[lo - 1];
+        row[lo - 1] = lo == 1 ? std::min(i, over) : over;
+        int best = row[lo - 1];
+        for (int j = lo; j <= hi; ++j) {
+            const int up = row[j];
+            const int cost = s1[i - 1] == s2[j - 1] ? 0 : 1;
+            const int cell = std::min({up + 1, row[j - 1] + 1, diag + cost, over});
+            diag = up;
+            row[j] = cell;
+            best = std::min(best, cell);
+        }
+        if (best > limit) {
+            return over;
+        }
+    }
+    return row[n];
+}
+
+// Compares count bytes of text, folded to lowercase, with lower
+bool equalsFolded(const char* text, const char* lower, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (FuzzySearch::toLowerAscii(text[i]) != lower[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t findScalar(std::string_view text, std::string_view query, size_t from) {
+    const char first = query[0];
+    for (size_t i = from; i + query.size() <= text.size(); ++i) {
+        if (FuzzySearch::toLowerAscii(text[i]) == first &&
+            equalsFolded(text.data() + i + 1, query.data() + 1, query.size() - 1)) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+#ifdef TBM_SEARCH_X86
+// Adding 128 - 'A' moves 'A'..'Z' to -128..-103, the only bytes that end up
+// below -102 as signed values; those get 0x20 ORed in.
+struct Sse2 {
+    static constexpr size_t kWidth = 16;
     
-    if (m == 0) return static_cast<int>(n);
-    if (n == 0) return static_cast<int>(m);
+    static __m128i fold(__m128i bytes) {
+        const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(128 - 'A')));
+        const __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+        return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
     
-    std::vector<std::vector<int>> dp(m + 1, std::vector<int>(n + 1));
+    // Bit j set when block[j] folds to first and block[j + last_offset] to last
+    static uint32_t candidates(const char* block, size_t last_offset, char first, char last) {
+        const __m128i head = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)));
+        const __m128i tail = fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + last_offset)));
+        const __m128i both = _mm_and_si128(_mm_cmpeq_epi8(head, _mm_set1_epi8(first)),
+                                           _mm_cmpeq_epi8(tail, _mm_set1_epi8(last)));
+        return static_cast<uint32_t>(_mm_movemask_epi8(both));
+    }
+};
+
+struct Avx2 {
+    static constexpr size_t kWidth = 32;
     
-    for (size_t i = 0; i <= m; ++i) dp[i][0] = static_cast<int>(i);
-    for (size_t j = 0; j <= n; ++j) dp[0][j] = static_cast<int>(j);
+    __attribute__((target("avx2"))) static __m256i fold(__m256i bytes) {
+        const __m256i shifted = _mm256_add_epi8(bytes, _mm256_set1_epi8(static_cast<char>(128 - 'A')));
+        const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), shifted);
+        return _mm256_or_si256(bytes, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+    }
     
-    for (size_t i = 1; i <= m; ++i) {
-        for (size_t j = 1; j <= n; ++j) {
-            int cost = (s1[i - 1] == s2[j - 1]) ? 0 : 1;
-            dp[i][j] = std::min({
-                dp[i - 1][j] + 1,
-                dp[i][j - 1] + 1,
-                dp[i - 1][j - 1] + cost
-            });
+    __attribute__((target("avx2"))) static uint32_t candidates(const char* block, size_t last_offset, char first,
+                                                               char last) {
+        const __m256i head = fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)));
+        const __m256i tail = fold(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + last_offset)));
+        const __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(head, _mm256_set1_epi8(first)),
+                                              _mm256_cmpeq_epi8(tail, _mm256_set1_epi8(last)));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(both));
+    }
+};
+
+// Longest tail copied into a padded buffer rather than scanned byte by byte
+constexpr size_t kPaddedTail = 64;
+
+// Returns the first candidate in mask whose middle bytes match too
+size_t firstMatch(uint32_t mask, const char* block, std::string_view query) {
+    const size_t middle = query.size() > 2 ? query.size() - 2 : 0;
+    while (mask != 0) {
+        const size_t offset = static_cast<size_t>(__builtin_ctz(mask));
+        if (equalsFolded(block + offset + 1, query.data() + 1, middle)) {
+            return offset;
+        }
+        mask &= mask - 1;
+    }
+    return std::string::npos;
+}
+
+// Muła's first/last byte filter: a vector of starting positions is checked
+// against the query's first and last bytes at once, and only positions
+// passing both are compared in full.
+template <typename Kernel>
+size_t findVector(std::string_view text, std::string_view query) {
+    constexpr size_t kWidth = Kernel::kWidth;
+    const size_t last_offset = query.size() - 1;
+    const char first = query[0];
+    const char last = query[last_offset];
+    size_t i = 0;
+    for (; i + last_offset + kWidth <= text.size(); i += kWidth) {
+        const size_t found = firstMatch(Kernel::candidates(text.data() + i, last_offset, first, last),
+                                        text.data() + i, query);
+        if (found != std::string::npos) {
+            return i + found;
         }
     }
     
-    return dp[m][n];
+    // Fewer than kWidth starting positions are left. Most process names are
+    // shorter than a vector, so a short tail is copied into a zero-padded
+    // buffer rather than falling back to bytes.
+    const size_t rest = text.size() - i;
+    if (rest < query.size()) {
+        return std::string::npos;
+    }
+    if (rest > kPaddedTail) {
+        return findScalar(text, query, i);
+    }
+    // Loads reach at most last_offset + kWidth < rest + kWidth bytes in
+    char padded[kPaddedTail + kWidth];
+    std::memcpy(padded, text.data() + i, rest);
+    std::memset(padded + rest, 0, kWidth);
+    const size_t starts = rest - query.size() + 1;
+    const uint32_t mask = Kernel::candidates(padded, last_offset, first, last) & ((uint32_t(1) << starts) - 1);
+    const size_t found = firstMatch(mask, padded, query);
+    return found == std::string::npos ? found : i + found;
+}
+#endif
+
+FuzzySearch::Isa detectIsa() {
+#ifdef TBM_SEARCH_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? FuzzySearch::Isa::AVX2 : FuzzySearch::Isa::SSE2;
+#else
+    return FuzzySearch::Isa::Scalar;
+#endif
+}
+
+} // namespace
+
+int FuzzySearch::levenshteinDistance(const std::string& s1, const std::string& s2) {
+    const std::string& shorter = s1.size() <= s2.size() ? s1 : s2;
+    const std::string& longer = s1.size() <= s2.size() ? s2 : s1;
+    const int max_len = static_cast<int>(longer.size());
+    if (shorter.empty()) return max_len;
+    if (shorter.size() <= kWordBits) {
+        return bitParallelDistance(shorter, longer, max_len);
+    }
+    
+    // Doubling the band until the distance fits in it costs at most twice
+    // the final band, and similar strings stay on a narrow one
+    const int length_gap = static_cast<int>(longer.size() - shorter.size());
+    for (int limit = std::max(length_gap, 16);; limit *= 2) {
+        limit = std::min(limit, max_len);
+        const int distance = bandedDistance(shorter, longer, limit);
+        if (distance <= limit) {
+            return distance;
+        }
+    }
+}
+
+int FuzzySearch::levenshteinDistance(const std::string& s1, const std::string& s2, int max_distance) {
+    const std::string& shorter = s1.size() <= s2.size() ? s1 : s2;
+    const std::string& longer = s1.size() <= s2.size() ? s2 : s1;
+    // Every edit changes the length by at most one
+    if (longer.size() - shorter.size() > static_cast<size_t>(max_distance)) {
+        return max_distance + 1;
+    }
+    if (shorter.empty()) return static_cast<int>(longer.size());
+    
+    const int limit = std::min(max_distance, static_cast<int>(longer.size()));
+    if (shorter.size() <= kWordBits) {
+        return bitParallelDistance(shorter, longer, limit);
+    }
+    const int distance = bandedDistance(shorter, longer, limit);
+    return distance > limit ? max_distance + 1 : distance;
 }
 
 double FuzzySearch::similarity(const std::string& s1, const std::string& s2) {
@@ -42,34 +271,96 @@ double FuzzySearch::similarity(const std::string& s1, const std::string& s2) {
 bool FuzzySearch::matches(const std::string& text, const std::string& query, double threshold) {
     if (query.empty()) return true;
     
-    std::string lower_text = toLower(text);
     std::string lower_query = toLower(query);
     
-    if (lower_text.find(lower_query) != std::string::npos) {
+    if (findIgnoreCase(text, lower_query) != std::string::npos) {
         return true;
     }
     
-    return similarity(lower_text, lower_query) >= threshold;
+    return isSimilar(toLower(text), lower_query, threshold);
 }
 
 double FuzzySearch::getMatchScore(const std::string& text, const std::string& query) {
     if (query.empty()) return 1.0;
     
-    std::string lower_text = toLower(text);
     std::string lower_query = toLower(query);
     
-    size_t pos = lower_text.find(lower_query);
+    size_t pos = findIgnoreCase(text, lower_query);
     if (pos != std::string::npos) {
         return 1.0 + (1.0 / static_cast<double>(pos + 1));
     }
     
-    return similarity(lower_text, lower_query);
+    return similarity(toLower(text), lower_query);
+}
+
+double FuzzySearch::scoreLowered(const std::string& lower_text, const std::string& lower_query, double threshold) {
+    if (lower_query.empty()) return 1.0;
+    
+    size_t pos = findIgnoreCase(lower_text, lower_query);
+    if (pos != std::string::npos) {
+        return 1.0 + (1.0 / static_cast<double>(pos + 1));
+    }
+    if (lower_text.empty()) {
+        return 0.0 >= threshold ? 0.0 : -1.0;
+    }
+    
+    const int limit = distanceLimit(lower_text.size(), lower_query.size(), threshold);
+    if (limit < 0) return -1.0;
+    const int distance = levenshteinDistance(lower_text, lower_query, limit);
+    if (distance > limit) return -1.0;
+    const size_t max_len = std::max(lower_text.size(), lower_query.size());
+    return 1.0 - (static_cast<double>(distance) / max_len);
+}
+
+size_t FuzzySearch::findIgnoreCase(std::string_view text, std::string_view lower_query, Isa isa) {
+    if (lower_query.empty()) return 0;
+    if (lower_query.size() > text.size()) return std::string::npos;
+    
+    const Isa supported = supportedIsa();
+    if (isa == Isa::Auto || isa > supported) {
+        isa = supported;
+    }
+    switch (isa) {
+#ifdef TBM_SEARCH_X86
+        case Isa::AVX2:
+            return findVector<Avx2>(text, lower_query);
+        case Isa::SSE2:
+            return findVector<Sse2>(text, lower_query);
+#endif
+        default:
+            return findScalar(text, lower_query, 0);
+    }
+}
+
+FuzzySearch::Isa FuzzySearch::supportedIsa() {
+    static const Isa supported = detectIsa();
+    return supported;
 }
 
 std::string FuzzySearch::toLower(const std::string& str) {
     std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
+    std::transform(result.begin(), result.end(), result.begin(), toLowerAscii);
     return result;
 }
 
+
+bool FuzzySearch::isSimilar(const std::string& s1, const std::string& s2, double threshold) {
+    if (s1.empty() || s2.empty()) return similarity(s1, s2) >= threshold;
+    
+    const int limit = distanceLimit(s1.size(), s2.size(), threshold);
+    return limit >= 0 && levenshteinDistance(s1, s2, limit) <= limit;
+}
+
+int FuzzySearch::distanceLimit(size_t len1, size_t len2, double threshold) {
+    // Settled with the same arithmetic as similarity() so the two agree at
+    // the boundary
+    const int max_len = static_cast<int>(std::max(len1, len2));
+    auto scores = [&](int distance) {
+        return 1.0 - (static_cast<double>(distance) / max_len) >= threshold;
+    };
+    const double bound = (1.0 - threshold) * max_len;
+    int limit = !(bound >= 0.0) ? -1 : bound >= max_len ? max_len : static_cast<int>(std::floor(bound));
+    while (limit < max_len && scores(limit + 1)) ++limit;
+    while (limit >= 0 && !scores(limit)) --limit;
+    return limit;
+}
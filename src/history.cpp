@@ -0,0 +1,163 @@
+#include "history.hpp"
+#include <algorithm>
+
+namespace {
+
+// Bucket widths of the downsampled tiers, in seconds
+constexpr int64_t kBucketSeconds[kHistoryTiers - 1] = {10, 60};
+
+} // namespace
+
+HistoryRing::HistoryRing(size_t capacity) : points_(capacity), head_(0), size_(0) {}
+
+void HistoryRing::push(const HistoryPoint& point) {
+    if (points_.empty()) {
+        return;
+    }
+    points_[head_] = point;
+    head_ = (head_ + 1) % points_.size();
+    size_ = std::min(size_ + 1, points_.size());
+}
+
+const HistoryPoint& HistoryRing::at(size_t index) const {
+    const size_t oldest = (head_ + points_.size() - size_) % points_.size();
+    return points_[(oldest + index) % points_.size()];
+}
+
+MetricHistory::MetricHistory(const HistoryLayout& layout)
+    : rings_{HistoryRing(layout.raw_points), HistoryRing(layout.ten_second_points),
+             HistoryRing(layout.minute_points)} {}
+
+void MetricHistory::add(double value, Clock::time_point when) {
+    const float sample = static_cast<float>(value);
+    rings_[0].push(HistoryPoint(sample));
+    
+    const int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(when.time_since_epoch()).count();
+    for (size_t i = 0; i < kHistoryTiers - 1; ++i) {
+        Bucket& bucket = open_[i];
+        const int64_t index = seconds / kBucketSeconds[i];
+        if (bucket.index != index) {
+            if (bucket.count > 0) {
+                HistoryPoint point;
+                point.min = bucket.min;
+                point.max = bucket.max;
+                point.avg = static_cast<float>(bucket.sum / bucket.count);
+                rings_[i + 1].push(point);
+            }
+            bucket = Bucket();
+            bucket.index = index;
+            bucket.min = sample;
+            bucket.max = sample;
+        }
+        bucket.min = std::min(bucket.min, sample);
+        bucket.max = std::max(bucket.max, sample);
+        bucket.sum += value;
+        ++bucket.count;
+    }
+}
+
+void MetricHistory::clear() {
+    for (auto& ring : rings_) {
+        ring.clear();
+    }
+    for (auto& bucket : open_) {
+        bucket = Bucket();
+    }
+}
+
+size_t MetricHistory::memoryBytes() const {
+    size_t bytes = sizeof(*this);
+    for (const auto& ring : rings_) {
+        bytes += ring.capacity() * sizeof(HistoryPoint);
+    }
+    return bytes;
+}
+
+History::History(size_t process_slots, const HistoryLayout& layout)
+    : layout_(layout), cpu_(layout), memory_(layout), swap_(layout),
+      processes_(process_slots, ProcessSeries(layout)) {}
+
+void History::recordSystem(double cpu_percent, const std::vector<double>& core_percent, double memory_percent,
+                           double swap_percent, Clock::time_point when) {
+    cpu_.add(cpu_percent, when);
+    memory_.add(memory_percent, when);
+    swap_.add(swap_percent, when);
+    // Grows only if CPUs come online; core series are never shrunk
+    while (cores_.size() < core_percent.size()) {
+        cores_.emplace_back(layout_);
+    }
+    for (size_t i = 0; i < core_percent.size(); ++i) {
+        cores_[i].add(core_percent[i], when);
+    }
+}
+
+void History::recordProcesses(const ProcessTable& table, const std::vector<uint32_t>& top, Clock::time_point when) {
+    for (uint32_t row : top) {
+        const int pid = table.pid[row];
+        const uint64_t start_time = table.start_time[row];
+        auto tracked = std::find_if(processes_.begin(), processes_.end(), [&](const ProcessSeries& series) {
+            return series.pid == pid && series.start_time == start_time;
+        });
+        if (tracked != processes_.end()) {
+            tracked->last_top = when;
+            continue;
+        }
+        
+        // A free slot first, else the one whose process left the top longest ago
+        ProcessSeries* slot = nullptr;
+        for (auto& series : processes_) {
+            if (series.pid != 0 && series.last_top == when) {
+                continue; // claimed this update
+            }
+            if (!slot || series.pid == 0 || (slot->pid != 0 && series.last_top < slot->last_top)) {
+                slot = &series;
+            }
+            if (slot->pid == 0) {
+                break;
+            }
+        }
+        if (!slot) {
+            break; // more busy processes than slots
+        }
+        slot->pid = pid;
+        slot->start_time = start_time;
+        slot->last_top = when;
+        slot->cpu_percent.clear();
+        slot->memory_bytes.clear();
+    }
+    
+    // The table is in PID order
+    for (auto& series : processes_) {
+        if (series.pid == 0) {
+            continue;
+        }
+        auto it = std::lower_bound(table.pid.begin(), table.pid.end(), series.pid);
+        const size_t row = static_cast<size_t>(it - table.pid.begin());
+        if (it == table.pid.end() || *it != series.pid || table.start_time[row] != series.start_time) {
+            series.pid = 0; // exited
+            continue;
+        }
+        series.cpu_percent.add(table.cpu_percent[row], when);
+        series.memory_bytes.add(static_cast<double>(table.memory_bytes[row]), when);
+    }
+}
+
+const History::ProcessSeries* History::findProcess(int pid) const {
+    for (const auto& series : processes_) {
+        if (series.pid == pid) {
+            return &series;
+        }
+    }
+    return nullptr;
+}
+
+size_t History::memoryBytes() const {
+    size_t bytes = cpu_.memoryBytes() + memory_.memoryBytes() + swap_.memoryBytes();
+    for (const auto& core : cores_) {
+        bytes += core.memoryBytes();
+    }
+    for (const auto& series : processes_) {
+        bytes += series.cpu_percent.memoryBytes() + series.memory_bytes.memoryBytes();
+    }
+    return bytes;
+}
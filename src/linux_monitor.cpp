@@ -1,68 +1,660 @@
 #include "linux_monitor.hpp"
-#include <fstream>
-#include <sstream>
+#include "thread_pool.hpp"
+#include "user_cache.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
-#include <pwd.h>
+#include <sys/resource.h>
 #include <algorithm>
 
 namespace LinuxMonitor {
 
+namespace {
+
+// Per-thread scratch buffer shared by all /proc reads. Large enough for
+// /proc/<pid>/status and /proc/meminfo; longer files are truncated, which
+// is harmless because the keys we need appear near the top.
+constexpr size_t kReadBufferSize = 16384;
+
+// PIDs handed to a scan worker at a time
+constexpr size_t kScanChunkSize = 32;
+
+// Soft fd limit raiseFileLimit() asks for, within the hard limit
+constexpr rlim_t kRaisedFileLimit = 65536;
+
+char* readBuffer() {
+    thread_local char buffer[kReadBufferSize];
+    return buffer;
+}
+
+uint64_t pageSize() {
+    static const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+void skipSpaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+}
+
+void skipField(const char*& p, const char* end) {
+    skipSpaces(p, end);
+    while (p < end && *p != ' ' && *p != '\n') {
+        ++p;
+    }
+}
+
+uint64_t parseUnsigned(const char*& p, const char* end) {
+    skipSpaces(p, end);
+    uint64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + static_cast<uint64_t>(*p - '0');
+        ++p;
+    }
+    return value;
+}
+
+// Returns the value of "Key:   <number>" when the line at p starts with key
+bool matchKey(const char* p, const char* end, const char* key, size_t key_len, uint64_t& value) {
+    if (static_cast<size_t>(end - p) < key_len || std::memcmp(p, key, key_len) != 0) {
+        return false;
+    }
+    p += key_len;
+    value = parseUnsigned(p, end);
+    return true;
+}
+
+const char* nextLine(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+int formatProcPath(char* out, size_t size, int pid, const char* leaf) {
+    return std::snprintf(out, size, "/proc/%d/%s", pid, leaf);
+}
+
+struct ReadCounters {
+    std::atomic<uint64_t> opens{0};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> closes{0};
+    std::atomic<uint64_t> cache_hits{0};
+    std::atomic<uint64_t> cache_misses{0};
+    std::atomic<uint64_t> invalidations{0};
+    std::atomic<uint64_t> permission_skips{0};
+};
+
+ReadCounters& counters() {
+    static ReadCounters instance;
+    return instance;
+}
+
+void bump(std::atomic<uint64_t>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+int openProc(const char* path) {
+    bump(counters().opens);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+void closeProc(int fd) {
+    bump(counters().closes);
+    close(fd);
+}
+
+// Reads an open /proc fd from offset 0. procfs fills as much of the buffer
+// as it can per call, so a short read means we hit EOF and can skip the
+// extra zero-length read.
+ssize_t preadAll(int fd, char* buf, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        const size_t wanted = size - total;
+        ssize_t n = pread(fd, buf + total, wanted, static_cast<off_t>(total));
+        bump(counters().reads);
+        if (n < 0) {
+            return total > 0 ? static_cast<ssize_t>(total) : -1;
+        }
+        total += static_cast<size_t>(n);
+        if (static_cast<size_t>(n) < wanted) {
+            break;
+        }
+    }
+    return static_cast<ssize_t>(total);
+}
+
+enum ProcFile { kStatFile = 0, kStatusFile = 1, kIoFile = 2, kProcFileCount };
+
+const char* const kProcFileNames[kProcFileCount] = {"stat", "status", "io"};
+
+bool isPermissionError(int error) {
+    return error == EACCES || error == EPERM;
+}
+
+// Keeps /proc/<pid>/{stat,status,io} open across ticks so that re-sampling a
+// long-lived process costs one pread per file instead of open/read/close.
+// Files we may not read (io of another user's process) are remembered as
+// denied for the life of the entry, so they cost nothing on later ticks.
+// Entries not touched for more than the caller's idle allowance are closed
+// by sweep(); when full, new PIDs are read uncached rather than evicting
+// entries still in use.
+// The shard lock only covers the bookkeeping: a reader pins its entry and
+// does the open and pread unlocked. An entry dropped while pinned moves to
+// retired_, and the last reader to unpin it closes its fds.
+class ProcFdCacheShard {
+public:
+    ProcFdCacheShard() : capacity_(0), generation_(0) {}
+    
+    ~ProcFdCacheShard() {
+        for (auto& entry : lru_) {
+            closeEntry(entry);
+        }
+        for (auto& entry : retired_) {
+            closeEntry(entry);
+        }
+    }
+    
+    ssize_t read(int pid, ProcFile file, char* buf, size_t size) {
+        const unsigned bit = 1u << file;
+        std::unique_lock<std::mutex> lock(mutex_);
+        
+        Slot slot = acquire(pid);
+        if (slot == lru_.end()) {
+            lock.unlock();
+            char path[64];
+            formatProcPath(path, sizeof(path), pid, kProcFileNames[file]);
+            return readProcFile(path, buf, size);
+        }
+        
+        if (slot->denied & bit) {
+            bump(counters().permission_skips);
+            return -1;
+        }
+        
+        if (slot->fds[file] >= 0) {
+            const int fd = slot->fds[file];
+            ++slot->pins;
+            lock.unlock();
+            const ssize_t len = preadAll(fd, buf, size);
+            const int error = errno;
+            lock.lock();
+            if (len >= 0) {
+                bump(counters().cache_hits);
+                unpin(slot);
+                return len;
+            }
+            if (isPermissionError(error)) {
+                // Lost access, e.g. after exec of a setuid binary
+                if (!slot->retired && slot->fds[file] == fd) {
+                    closeProc(fd);
+                    slot->fds[file] = -1;
+                    slot->denied |= bit;
+                }
+                unpin(slot);
+                errno = error;
+                return -1;
+            }
+            // ESRCH: the task behind this fd is gone, even if the PID is back
+            if (!slot->retired) {
+                bump(counters().invalidations);
+                retire(slot);
+            }
+            unpin(slot);
+            slot = acquire(pid);
+            if (slot == lru_.end()) {
+                errno = error;
+                return -1;
+            }
+        }
+        
+        ++slot->pins;
+        lock.unlock();
+        char path[64];
+        formatProcPath(path, sizeof(path), pid, kProcFileNames[file]);
+        int fd = openProc(path);
+        int error = errno;
+        ssize_t len = -1;
+        if (fd >= 0) {
+            bump(counters().cache_misses);
+            // procfs checks ptrace access on read for some files, not on open
+            len = preadAll(fd, buf, size);
+            error = errno;
+            if (len < 0 && isPermissionError(error)) {
+                closeProc(fd);
+                fd = -1;
+            }
+        }
+        lock.lock();
+        if (fd < 0) {
+            if (isPermissionError(error) && !slot->retired) {
+                slot->denied |= bit;
+            }
+        } else if (slot->retired || slot->fds[file] >= 0) {
+            // Dropped meanwhile, or another reader of this PID cached it first
+            closeProc(fd);
+        } else {
+            slot->fds[file] = fd;
+        }
+        unpin(slot);
+        errno = error;
+        return len;
+    }
+    
+    // Returns true when the cached fds belonged to an earlier process with
+    // the same PID; they are dropped and the caller must re-read
+    bool checkStartTime(int pid, uint64_t start_time) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(pid);
+        if (it == index_.end()) {
+            return false;
+        }
+        Entry& entry = *it->second;
+        if (entry.start_time == 0 || entry.start_time == start_time) {
+            entry.start_time = start_time;
+            return false;
+        }
+        bump(counters().invalidations);
+        retire(it->second);
+        return true;
+    }
+    
+    void beginTick() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+    }
+    
+    // Untouched entries sit at the LRU tail, so this is O(exited PIDs)
+    void sweep(uint64_t max_idle_ticks) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!lru_.empty() && lru_.back().generation + max_idle_ticks < generation_) {
+            retire(std::prev(lru_.end()));
+        }
+    }
+    
+    void setCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        while (lru_.size() > capacity_) {
+            retire(std::prev(lru_.end()));
+        }
+    }
+    
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lru_.size();
+    }
+
+private:
+    struct Entry {
+        int pid;
+        int fds[kProcFileCount];
+        unsigned denied;    // bit per ProcFile that failed with EACCES/EPERM
+        unsigned pins;      // readers using the fds outside the lock
+        bool retired;       // dropped from the cache, closed on the last unpin
+        uint64_t start_time;
+        uint64_t generation;
+    };
+    using Slot = std::list<Entry>::iterator;
+    
+    std::list<Entry> lru_;
+    std::list<Entry> retired_;
+    std::unordered_map<int, Slot> index_;
+    size_t capacity_;
+    uint64_t generation_;
+    mutable std::mutex mutex_;
+    
+    // lru_.end() when the shard is full of entries in use this tick
+    Slot acquire(int pid) {
+        auto it = index_.find(pid);
+        if (it != index_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            it->second->generation = generation_;
+            return it->second;
+        }
+        
+        if (lru_.size() >= capacity_) {
+            // Only reclaim entries that were not needed this tick; evicting
+            // live ones would thrash on hosts with more PIDs than capacity
+            if (lru_.empty() || lru_.back().generation == generation_) {
+                return lru_.end();
+            }
+            retire(std::prev(lru_.end()));
+        }
+        
+        Entry entry;
+        entry.pid = pid;
+        std::fill(std::begin(entry.fds), std::end(entry.fds), -1);
+        entry.denied = 0;
+        entry.pins = 0;
+        entry.retired = false;
+        entry.start_time = 0;
+        entry.generation = generation_;
+        lru_.push_front(entry);
+        index_[pid] = lru_.begin();
+        return lru_.begin();
+    }
+    
+    // Drops slot from the cache, closing its fds unless a reader holds them
+    void retire(Slot slot) {
+        index_.erase(slot->pid);
+        if (slot->pins == 0) {
+            closeEntry(*slot);
+            lru_.erase(slot);
+            return;
+        }
+        slot->retired = true;
+        retired_.splice(retired_.end(), lru_, slot);
+    }
+    
+    void unpin(Slot slot) {
+        if (--slot->pins == 0 && slot->retired) {
+            closeEntry(*slot);
+            retired_.erase(slot);
+        }
+    }
+    
+    static void closeEntry(Entry& entry) {
+        for (int& fd : entry.fds) {
+            if (fd >= 0) {
+                closeProc(fd);
+                fd = -1;
+            }
+        }
+    }
+};
+
+// Splits the cache by PID so parallel scan workers rarely share a lock
+class ProcFdCache {
+public:
+    ProcFdCache() : limit_(capacityFromRlimit()) {
+        distributeCapacity(limit_);
+    }
+    
+    ProcFdCacheShard& shard(int pid) {
+        return shards_[static_cast<unsigned>(pid) % kShardCount];
+    }
+    
+    void beginTick() {
+        for (auto& s : shards_) {
+            s.beginTick();
+        }
+    }
+    
+    void sweep(uint64_t max_idle_ticks) {
+        for (auto& s : shards_) {
+            s.sweep(max_idle_ticks);
+        }
+    }
+    
+    void setCapacity(size_t capacity) {
+        distributeCapacity(std::min(capacity, limit_));
+    }
+    
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& s : shards_) {
+            total += s.size();
+        }
+        return total;
+    }
+
+private:
+    static constexpr size_t kShardCount = 16;
+    static constexpr size_t kMaxEntries = 16384;
+    static constexpr rlim_t kReservedFds = 256;
+    
+    ProcFdCacheShard shards_[kShardCount];
+    size_t limit_;
+    
+    void distributeCapacity(size_t capacity) {
+        for (auto& s : shards_) {
+            s.setCapacity((capacity + kShardCount - 1) / kShardCount);
+        }
+    }
+    
+    // Sized from the soft limit as it stands when the cache is first used;
+    // main() raises it before the monitor starts
+    static size_t capacityFromRlimit() {
+        struct rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            return 0;
+        }
+        if (limit.rlim_cur == RLIM_INFINITY) {
+            return kMaxEntries;
+        }
+        if (limit.rlim_cur <= kReservedFds * 2) {
+            return 0;
+        }
+        // Use at most half of the remaining budget, one fd per ProcFile per entry
+        return std::min<size_t>(kMaxEntries, (limit.rlim_cur - kReservedFds) / 2 / kProcFileCount);
+    }
+};
+
+ProcFdCache& fdCache() {
+    static ProcFdCache instance;
+    return instance;
+}
+
+} // namespace
+
+void raiseFileLimit() {
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY ||
+        limit.rlim_cur >= limit.rlim_max || limit.rlim_cur >= kRaisedFileLimit) {
+        return;
+    }
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, kRaisedFileLimit);
+    setrlimit(RLIMIT_NOFILE, &limit);
+}
+
+ssize_t readProcFile(const char* path, char* buf, size_t size) {
+    int fd = openProc(path);
+    if (fd < 0) {
+        return -1;
+    }
+    
+    ssize_t len = preadAll(fd, buf, size);
+    closeProc(fd);
+    return len;
+}
+
+ProcReadStats getProcReadStats() {
+    ReadCounters& c = counters();
+    ProcReadStats stats;
+    stats.opens = c.opens.load(std::memory_order_relaxed);
+    stats.reads = c.reads.load(std::memory_order_relaxed);
+    stats.closes = c.closes.load(std::memory_order_relaxed);
+    stats.cache_hits = c.cache_hits.load(std::memory_order_relaxed);
+    stats.cache_misses = c.cache_misses.load(std::memory_order_relaxed);
+    stats.invalidations = c.invalidations.load(std::memory_order_relaxed);
+    stats.permission_skips = c.permission_skips.load(std::memory_order_relaxed);
+    stats.cached_processes = fdCache().size();
+    return stats;
+}
+
+void setFdCacheCapacity(size_t max_processes) {
+    fdCache().setCapacity(max_processes);
+}
+
 std::string readFile(const std::string& path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
+    char* buf = readBuffer();
+    ssize_t len = readProcFile(path.c_str(), buf, kReadBufferSize);
+    if (len <= 0) {
         return "";
     }
     
-    std::string line;
-    std::getline(file, line);
-    return line;
+    const char* end = buf + len;
+    const char* eol = static_cast<const char*>(std::memchr(buf, '\n', len));
+    return std::string(static_cast<const char*>(buf), eol ? eol : end);
 }
 
+namespace {
+
+// Parses the counters after a "cpu" / "cpuN" label
+void parseCPUFields(const char*& p, const char* end, CPUStats& stats) {
+    stats.user = static_cast<double>(parseUnsigned(p, end));
+    stats.nice = static_cast<double>(parseUnsigned(p, end));
+    stats.system = static_cast<double>(parseUnsigned(p, end));
+    stats.idle = static_cast<double>(parseUnsigned(p, end));
+    stats.iowait = static_cast<double>(parseUnsigned(p, end));
+    stats.irq = static_cast<double>(parseUnsigned(p, end));
+    stats.softirq = static_cast<double>(parseUnsigned(p, end));
+    stats.steal = static_cast<double>(parseUnsigned(p, end));
+    stats.guest = static_cast<double>(parseUnsigned(p, end));
+    stats.guest_nice = static_cast<double>(parseUnsigned(p, end));
+    
+    // guest and guest_nice are already included in user and nice
+    stats.total = stats.user + stats.nice + stats.system + stats.idle
+                  + stats.iowait + stats.irq + stats.softirq + stats.steal;
+}
+
+} // namespace
+
 CPUStats parseCPUStats(const std::string& stat_line) {
     CPUStats stats;
-    std::istringstream iss(stat_line);
-    std::string cpu_label;
-    
-    iss >> cpu_label; // Skip "cpu"
-    iss >> stats.user >> stats.nice >> stats.system >> stats.idle 
-        >> stats.iowait >> stats.irq >> stats.softirq;
-    
-    stats.total = stats.user + stats.nice + stats.system + stats.idle 
-                  + stats.iowait + stats.irq + stats.softirq;
+    const char* p = stat_line.data();
+    const char* end = p + stat_line.size();
     
+    skipField(p, end); // Skip "cpu"
+    parseCPUFields(p, end, stats);
     return stats;
 }
 
-MemoryStats parseMemoryStats() {
-    MemoryStats stats;
-    std::ifstream file("/proc/meminfo");
+bool parseCPUStatsBuffer(const char* data, size_t len, CPUStats& total, std::vector<CPUStats>& cores,
+                         size_t& online) {
+    const char* p = data;
+    const char* end = data + len;
+    size_t core_count = 0;
+    bool found_total = false;
+    online = 0;
     
-    if (!file.is_open()) {
-        return stats;
+    // All cpu lines come first; stop at the first line that is not one
+    while (p + 3 <= end && std::memcmp(p, "cpu", 3) == 0) {
+        p += 3;
+        if (p < end && *p == ' ') {
+            parseCPUFields(p, end, total);
+            found_total = true;
+        } else {
+            size_t index = static_cast<size_t>(parseUnsigned(p, end));
+            // Offline CPUs are skipped by the kernel, so index may jump ahead;
+            // their slots are zeroed rather than left with old counters
+            if (index >= cores.size()) {
+                cores.resize(index + 1);
+            }
+            for (size_t skipped = core_count; skipped < index; ++skipped) {
+                cores[skipped] = CPUStats();
+            }
+            parseCPUFields(p, end, cores[index]);
+            core_count = index + 1;
+            ++online;
+        }
+        p = nextLine(p, end);
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string key;
-        uint64_t value;
-        std::string unit;
-        
-        iss >> key >> value >> unit;
+    cores.resize(core_count);
+    return found_total;
+}
+
+bool readCPUStats(CPUStats& total, std::vector<CPUStats>& cores, size_t& online) {
+    // One line per CPU; grow until every cpu line fits on large hosts
+    thread_local std::vector<char> buffer(65536);
+    while (true) {
+        ssize_t len = readProcFile("/proc/stat", buffer.data(), buffer.size());
+        if (len <= 0) {
+            return false;
+        }
+        if (static_cast<size_t>(len) < buffer.size() ||
+            memmem(buffer.data(), static_cast<size_t>(len), "\nintr", 5) != nullptr) {
+            return parseCPUStatsBuffer(buffer.data(), static_cast<size_t>(len), total, cores, online);
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+}
+
+namespace {
+
+struct MemInfoKey {
+    const char* name;      // including the trailing ':'
+    size_t length;
+    uint64_t MemoryStats::*field;
+    uint64_t scale;        // kB lines become bytes, HugePages_* counts stay as-is
+};
+
+#define MEMINFO_KEY(name, field, scale) {name, sizeof(name) - 1, &MemoryStats::field, scale}
+
+// Listed in the order the kernel prints them so the lookup cursor below
+// usually matches on the first compare
+const MemInfoKey kMemInfoKeys[] = {
+    MEMINFO_KEY("MemTotal:", total, 1024),
+    MEMINFO_KEY("MemFree:", free, 1024),
+    MEMINFO_KEY("MemAvailable:", available, 1024),
+    MEMINFO_KEY("Buffers:", buffers, 1024),
+    MEMINFO_KEY("Cached:", cached, 1024),
+    MEMINFO_KEY("SwapCached:", swap_cached, 1024),
+    MEMINFO_KEY("SwapTotal:", swap_total, 1024),
+    MEMINFO_KEY("SwapFree:", swap_free, 1024),
+    MEMINFO_KEY("Dirty:", dirty, 1024),
+    MEMINFO_KEY("Writeback:", writeback, 1024),
+    MEMINFO_KEY("Shmem:", shmem, 1024),
+    MEMINFO_KEY("Slab:", slab, 1024),
+    MEMINFO_KEY("SReclaimable:", slab_reclaimable, 1024),
+    MEMINFO_KEY("HugePages_Total:", hugepages_total, 1),
+    MEMINFO_KEY("HugePages_Free:", hugepages_free, 1),
+    MEMINFO_KEY("HugePages_Rsvd:", hugepages_reserved, 1),
+    MEMINFO_KEY("HugePages_Surp:", hugepages_surplus, 1),
+    MEMINFO_KEY("Hugepagesize:", hugepage_size, 1024),
+};
+
+#undef MEMINFO_KEY
+
+constexpr size_t kMemInfoKeyCount = sizeof(kMemInfoKeys) / sizeof(kMemInfoKeys[0]);
+
+} // namespace
+
+MemoryStats parseMemInfoBuffer(const char* data, size_t len) {
+    MemoryStats stats;
+    const char* p = data;
+    const char* end = data + len;
+    bool has_available = false;
+    size_t cursor = 0;
+    
+    while (p < end) {
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', end - p));
+        if (!colon) {
+            break;
+        }
+        const size_t key_length = static_cast<size_t>(colon - p) + 1;
         
-        if (key == "MemTotal:") {
-            stats.total = value * 1024; // Convert from KB to bytes
-        } else if (key == "MemFree:") {
-            stats.free = value * 1024;
-        } else if (key == "Cached:") {
-            stats.cached = value * 1024;
-        } else if (key == "Buffers:") {
-            stats.buffers = value * 1024;
+        // Resume from the last match; wraps at most once per line
+        for (size_t tried = 0; tried < kMemInfoKeyCount; ++tried) {
+            const MemInfoKey& key = kMemInfoKeys[cursor];
+            cursor = (cursor + 1) % kMemInfoKeyCount;
+            if (key.length == key_length && std::memcmp(p, key.name, key_length) == 0) {
+                const char* value = colon + 1;
+                stats.*key.field = parseUnsigned(value, end) * key.scale;
+                has_available |= key.field == &MemoryStats::available;
+                break;
+            }
         }
+        p = nextLine(colon, end);
     }
     
-    stats.used = stats.total - stats.free - stats.cached - stats.buffers;
+    if (has_available) {
+        stats.used = stats.total > stats.available ? stats.total - stats.available : 0;
+    } else {
+        // Pre-3.14 kernels: approximate MemAvailable from reclaimable pools
+        const uint64_t reclaimable = stats.free + stats.cached + stats.buffers + stats.slab_reclaimable;
+        stats.used = stats.total > reclaimable ? stats.total - reclaimable : 0;
+        stats.available = stats.total - stats.used;
+    }
     if (stats.total > 0) {
         stats.percent_used = (static_cast<double>(stats.used) / stats.total) * 100.0;
     }
@@ -70,122 +662,743 @@ MemoryStats parseMemoryStats() {
     return stats;
 }
 
-std::vector<ProcessInfo> parseProcesses() {
-    std::vector<ProcessInfo> processes;
-    DIR* proc_dir = opendir("/proc");
+MemoryStats parseMemoryStats() {
+    char* buf = readBuffer();
+    ssize_t len = readProcFile("/proc/meminfo", buf, kReadBufferSize);
+    if (len <= 0) {
+        return MemoryStats();
+    }
+    return parseMemInfoBuffer(buf, static_cast<size_t>(len));
+}
+
+namespace {
+
+// Reads a whole /proc file, doubling buffer until the read comes up short
+ssize_t readWholeProcFile(const char* path, std::vector<char>& buffer) {
+    while (true) {
+        ssize_t len = readProcFile(path, buffer.data(), buffer.size());
+        if (len < 0 || static_cast<size_t>(len) < buffer.size()) {
+            return len;
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+}
+
+bool isVirtualDisk(const char* name, size_t len) {
+    return (len > 4 && std::memcmp(name, "loop", 4) == 0) ||
+           (len > 3 && std::memcmp(name, "ram", 3) == 0);
+}
+
+// Partitions have a "partition" attribute in sysfs. The answer never changes
+// for a device number, so each one is looked up once per run.
+bool isPartition(unsigned major, unsigned minor) {
+    static std::mutex mutex;
+    static std::unordered_map<uint64_t, bool> known;
+    const uint64_t key = (static_cast<uint64_t>(major) << 32) | minor;
     
-    if (!proc_dir) {
-        return processes;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = known.find(key);
+    if (it != known.end()) {
+        return it->second;
+    }
+    char path[64];
+    std::snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/partition", major, minor);
+    const bool partition = access(path, F_OK) == 0;
+    known.emplace(key, partition);
+    return partition;
+}
+
+} // namespace
+
+void parseDiskStatsBuffer(const char* data, size_t len, std::vector<DiskStats>& disks, const DiskFilter& filter) {
+    const char* p = data;
+    const char* end = data + len;
+    size_t count = 0;
+    
+    while (p < end) {
+        const char* line = p;
+        p = nextLine(p, end);
+        
+        const char* cursor = line;
+        const unsigned major = static_cast<unsigned>(parseUnsigned(cursor, p));
+        const unsigned minor = static_cast<unsigned>(parseUnsigned(cursor, p));
+        skipSpaces(cursor, p);
+        const char* name = cursor;
+        skipField(cursor, p);
+        const size_t name_len = static_cast<size_t>(cursor - name);
+        if (name_len == 0) {
+            continue;
+        }
+        
+        // Reject filtered devices before touching their counters
+        if (!filter.virtual_devices && isVirtualDisk(name, name_len)) {
+            continue;
+        }
+        const bool partition = isPartition(major, minor);
+        if (!filter.partitions && partition) {
+            continue;
+        }
+        
+        if (count == disks.size()) {
+            disks.emplace_back();
+        }
+        DiskStats& disk = disks[count++];
+        if (disk.name.size() != name_len || std::memcmp(disk.name.data(), name, name_len) != 0) {
+            disk.name.assign(name, name_len);
+        }
+        disk.major = major;
+        disk.minor = minor;
+        disk.is_partition = partition;
+        
+        disk.reads = parseUnsigned(cursor, p);
+        skipField(cursor, p); // reads merged
+        disk.sectors_read = parseUnsigned(cursor, p);
+        disk.read_time_ms = parseUnsigned(cursor, p);
+        disk.writes = parseUnsigned(cursor, p);
+        skipField(cursor, p); // writes merged
+        disk.sectors_written = parseUnsigned(cursor, p);
+        disk.write_time_ms = parseUnsigned(cursor, p);
+        disk.in_flight = parseUnsigned(cursor, p);
+        disk.io_time_ms = parseUnsigned(cursor, p);
+    }
+    
+    disks.resize(count);
+}
+
+bool readDiskStats(std::vector<DiskStats>& disks, const DiskFilter& filter) {
+    // About 100 bytes per device; grows on hosts with hundreds of them
+    thread_local std::vector<char> buffer(16384);
+    ssize_t len = readWholeProcFile("/proc/diskstats", buffer);
+    if (len < 0) {
+        disks.clear();
+        return false;
+    }
+    parseDiskStatsBuffer(buffer.data(), static_cast<size_t>(len), disks, filter);
+    return true;
+}
+
+void parseNetDevBuffer(const char* data, size_t len, NetInterfaceTable& table) {
+    const uint64_t tick = ++table.tick;
+    const char* p = data;
+    const char* end = data + len;
+    
+    // Interface names fit in IFNAMSIZ, so the lookup key stays in the
+    // string's inline buffer and never allocates
+    std::string key;
+    
+    while (p < end) {
+        const char* line = p;
+        p = nextLine(p, end);
+        
+        // The two header lines have no ':'
+        const char* colon = static_cast<const char*>(std::memchr(line, ':', p - line));
+        if (!colon) {
+            continue;
+        }
+        const char* name = line;
+        skipSpaces(name, colon);
+        key.assign(name, colon);
+        
+        size_t slot;
+        auto it = table.index.find(key);
+        if (it != table.index.end()) {
+            slot = it->second;
+        } else {
+            if (!table.free_slots.empty()) {
+                slot = table.free_slots.back();
+                table.free_slots.pop_back();
+            } else {
+                slot = table.slots.size();
+                table.slots.emplace_back();
+            }
+            table.index.emplace(key, slot);
+            table.slots[slot].name = key;
+            table.slots[slot].first_seen = tick;
+        }
+        
+        NetStats& iface = table.slots[slot];
+        iface.active = true;
+        iface.last_seen = tick;
+        
+        const char* cursor = colon + 1;
+        NetCounters& counters = iface.counters;
+        counters.rx_bytes = parseUnsigned(cursor, p);
+        counters.rx_packets = parseUnsigned(cursor, p);
+        counters.rx_errors = parseUnsigned(cursor, p);
+        counters.rx_dropped = parseUnsigned(cursor, p);
+        for (int skipped = 0; skipped < 4; ++skipped) {
+            skipField(cursor, p); // fifo frame compressed multicast
+        }
+        counters.tx_bytes = parseUnsigned(cursor, p);
+        counters.tx_packets = parseUnsigned(cursor, p);
+        counters.tx_errors = parseUnsigned(cursor, p);
+        counters.tx_dropped = parseUnsigned(cursor, p);
+    }
+    
+    // Interfaces missing from this read were removed; free their slots
+    for (size_t slot = 0; slot < table.slots.size(); ++slot) {
+        NetStats& iface = table.slots[slot];
+        if (iface.active && iface.last_seen != tick) {
+            iface.active = false;
+            table.index.erase(iface.name);
+            table.free_slots.push_back(slot);
+        }
+    }
+}
+
+bool readNetDevStats(NetInterfaceTable& table) {
+    thread_local std::vector<char> buffer(16384);
+    ssize_t len = readWholeProcFile("/proc/net/dev", buffer);
+    if (len < 0) {
+        return false;
+    }
+    parseNetDevBuffer(buffer.data(), static_cast<size_t>(len), table);
+    return true;
+}
+
+namespace {
+
+// Parses "12.34" without strtod, which depends on the C locale
+double parseDecimal(const char*& p, const char* end) {
+    double value = static_cast<double>(parseUnsigned(p, end));
+    if (p < end && *p == '.') {
+        ++p;
+        double scale = 0.1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value += (*p - '0') * scale;
+            scale *= 0.1;
+            ++p;
+        }
+    }
+    return value;
+}
+
+// Upper bounds on the cgroup walk so hosts with thousands of pods stay cheap
+constexpr int kCgroupPressureDepth = 2;
+constexpr size_t kMaxCgroupPressure = 256;
+
+bool readPressureFile(const char* path, PressureStats& stats) {
+    char buf[256];
+    ssize_t len = readProcFile(path, buf, sizeof(buf));
+    if (len <= 0) {
+        stats = PressureStats();
+        return false;
+    }
+    return parsePressureBuffer(buf, static_cast<size_t>(len), stats);
+}
+
+void walkCgroupPressure(const std::string& root, const std::string& relative, int depth,
+                        std::vector<CgroupPressure>& groups) {
+    DIR* dir = opendir((root + "/" + relative).c_str());
+    if (!dir) {
+        return;
     }
     
     struct dirent* entry;
-    while ((entry = readdir(proc_dir)) != nullptr) {
-        if (entry->d_type == DT_DIR) {
-            int pid = 0;
-            try {
-                pid = std::stoi(entry->d_name);
-            } catch (...) {
-                continue;
-            }
-            
-            ProcessInfo proc = parseProcessInfo(pid);
-            if (proc.pid > 0) {
-                processes.push_back(proc);
+    while ((entry = readdir(dir)) != nullptr && groups.size() < kMaxCgroupPressure) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') {
+            continue;
+        }
+        CgroupPressure group;
+        group.path = relative.empty() ? entry->d_name : relative + "/" + entry->d_name;
+        const std::string base = root + "/" + group.path;
+        readPressureFile((base + "/cpu.pressure").c_str(), group.cpu);
+        readPressureFile((base + "/memory.pressure").c_str(), group.memory);
+        if (!group.cpu.available && !group.memory.available) {
+            continue;
+        }
+        groups.push_back(group);
+        if (depth > 1) {
+            walkCgroupPressure(root, group.path, depth - 1, groups);
+        }
+    }
+    closedir(dir);
+}
+
+} // namespace
+
+bool parsePressureBuffer(const char* data, size_t len, PressureStats& stats) {
+    const char* p = data;
+    const char* end = data + len;
+    stats = PressureStats();
+    
+    while (p < end) {
+        const char* eol = nextLine(p, end);
+        PressureLine* line = nullptr;
+        if (eol - p > 5 && std::memcmp(p, "some ", 5) == 0) {
+            line = &stats.some;
+        } else if (eol - p > 5 && std::memcmp(p, "full ", 5) == 0) {
+            line = &stats.full;
+        }
+        if (line) {
+            stats.available = true;
+            const char* cursor = p + 5;
+            while (true) {
+                skipSpaces(cursor, eol);
+                const char* key = cursor;
+                const char* equals = static_cast<const char*>(std::memchr(key, '=', eol - key));
+                if (!equals) {
+                    break;
+                }
+                const size_t key_len = static_cast<size_t>(equals - key);
+                cursor = equals + 1;
+                if (key_len == 5 && std::memcmp(key, "total", 5) == 0) {
+                    line->total_us = parseUnsigned(cursor, eol);
+                } else if (key_len == 5 && std::memcmp(key, "avg10", 5) == 0) {
+                    line->avg10 = parseDecimal(cursor, eol);
+                } else if (key_len == 5 && std::memcmp(key, "avg60", 5) == 0) {
+                    line->avg60 = parseDecimal(cursor, eol);
+                } else if (key_len == 6 && std::memcmp(key, "avg300", 6) == 0) {
+                    line->avg300 = parseDecimal(cursor, eol);
+                } else {
+                    skipField(cursor, eol);
+                }
             }
         }
+        p = eol;
     }
     
-    closedir(proc_dir);
-    return processes;
+    return stats.available;
 }
 
-ProcessInfo parseProcessInfo(int pid) {
-    ProcessInfo proc;
-    proc.pid = pid;
+bool readSystemPressure(SystemPressure& pressure) {
+    const bool cpu = readPressureFile("/proc/pressure/cpu", pressure.cpu);
+    const bool memory = readPressureFile("/proc/pressure/memory", pressure.memory);
+    const bool io = readPressureFile("/proc/pressure/io", pressure.io);
+    return cpu || memory || io;
+}
+
+const std::string& cgroupRoot() {
+    // Pure v2 hosts mount it at /sys/fs/cgroup, hybrid ones at .../unified;
+    // mountinfo covers both and anything custom
+    static const std::string root = [] {
+        std::vector<char> buffer(16384);
+        ssize_t len = readWholeProcFile("/proc/self/mountinfo", buffer);
+        const char* p = buffer.data();
+        const char* end = p + std::max<ssize_t>(len, 0);
+        while (p < end) {
+            const char* eol = nextLine(p, end);
+            const char* separator = static_cast<const char*>(memmem(p, eol - p, " - cgroup2 ", 11));
+            if (separator) {
+                // Field 5 is the mount point
+                const char* field = p;
+                for (int i = 0; i < 4; ++i) {
+                    skipField(field, separator);
+                }
+                skipSpaces(field, separator);
+                const char* mount_end = field;
+                skipField(mount_end, separator);
+                return std::string(field, mount_end);
+            }
+            p = eol;
+        }
+        return std::string();
+    }();
+    return root;
+}
+
+bool readCgroupPressure(std::vector<CgroupPressure>& groups) {
+    groups.clear();
+    const std::string& root = cgroupRoot();
+    if (root.empty()) {
+        return false;
+    }
+    walkCgroupPressure(root, "", kCgroupPressureDepth, groups);
+    return !groups.empty();
+}
+
+std::string parseCgroupBuffer(const char* data, size_t len) {
+    const char* p = data;
+    const char* end = data + len;
+    
+    // The v2 entry is "0::<path>"; hybrid hosts list v1 controllers too
+    while (p < end) {
+        const char* eol = nextLine(p, end);
+        if (eol - p >= 3 && std::memcmp(p, "0::", 3) == 0) {
+            const char* path_end = eol;
+            if (path_end > p + 3 && *(path_end - 1) == '\n') {
+                --path_end;
+            }
+            return std::string(p + 3, path_end);
+        }
+        p = eol;
+    }
+    return std::string();
+}
+
+std::string readProcessCgroup(int pid) {
+    char path[64];
+    formatProcPath(path, sizeof(path), pid, "cgroup");
+    char* buf = readBuffer();
+    ssize_t len = readProcFile(path, buf, kReadBufferSize);
+    if (len <= 0) {
+        return std::string();
+    }
+    return parseCgroupBuffer(buf, static_cast<size_t>(len));
+}
+
+bool readCgroupStats(CgroupStats& group) {
+    const std::string& root = cgroupRoot();
+    if (root.empty()) {
+        return false;
+    }
+    const std::string base = root + (group.path == "/" ? "" : group.path);
+    char buf[512];
     
-    // Read /proc/pid/stat
-    std::string stat_path = "/proc/" + std::to_string(pid) + "/stat";
-    std::ifstream stat_file(stat_path);
+    // usage_usec is the first line of cpu.stat
+    ssize_t len = readProcFile((base + "/cpu.stat").c_str(), buf, sizeof(buf));
+    uint64_t usage = 0;
+    if (len <= 0 || !matchKey(buf, buf + len, "usage_usec", 10, usage)) {
+        return false;
+    }
+    group.usage_usec = usage;
     
-    if (!stat_file.is_open()) {
-        return proc;
+    // The root group has no memory.current; report it as zero
+    len = readProcFile((base + "/memory.current").c_str(), buf, sizeof(buf));
+    if (len > 0) {
+        const char* p = buf;
+        group.memory_current = parseUnsigned(p, buf + len);
+    }
+    len = readProcFile((base + "/memory.max").c_str(), buf, sizeof(buf));
+    if (len > 0 && !(len >= 3 && std::memcmp(buf, "max", 3) == 0)) {
+        const char* p = buf;
+        group.memory_max = parseUnsigned(p, buf + len);
     }
+    return true;
+}
+
+bool parseStatBuffer(const char* data, size_t len, ProcessInfo& proc) {
+    const char* end = data + len;
     
-    std::string line;
-    std::getline(stat_file, line);
-    std::istringstream iss(line);
+    // comm may itself contain spaces and ')', so it spans from the first
+    // '(' to the last ')' on the line
+    const char* open_paren = static_cast<const char*>(std::memchr(data, '(', len));
+    if (!open_paren) {
+        return false;
+    }
+    const char* close_paren = end;
+    while (close_paren > open_paren && *(close_paren - 1) != ')') {
+        --close_paren;
+    }
+    if (close_paren == open_paren) {
+        return false;
+    }
+    --close_paren;
+    proc.name.assign(open_paren + 1, close_paren);
     
-    std::string token;
-    int field = 0;
+    // Fields after comm start at 3 (state)
+    const char* p = close_paren + 1;
+    skipSpaces(p, end);
+    if (p >= end) {
+        return false;
+    }
+    proc.state = *p++;
     
-    while (iss >> token) {
-        field++;
+    for (int field = 4; field <= 24 && p < end; ++field) {
         switch (field) {
-            case 2: // Process name (in parentheses)
-                proc.name = token;
-                if (proc.name.front() == '(' && proc.name.back() == ')') {
-                    proc.name = proc.name.substr(1, proc.name.length() - 2);
-                }
-                break;
-            case 3: // State
-                proc.state = token;
+            case 4: // parent pid
+                proc.ppid = static_cast<int>(parseUnsigned(p, end));
                 break;
             case 14: // utime
+                proc.utime = parseUnsigned(p, end);
+                break;
             case 15: // stime
-                // CPU time - would need to calculate from previous values
+                proc.stime = parseUnsigned(p, end);
+                break;
+            case 20: // thread count
+                proc.num_threads = static_cast<int>(parseUnsigned(p, end));
+                break;
+            case 22: // start time
+                proc.start_time = parseUnsigned(p, end);
+                break;
+            case 23: // virtual memory
+                proc.virtual_memory = parseUnsigned(p, end);
                 break;
-            case 22: // virtual memory
-                try {
-                    proc.virtual_memory = std::stoull(token);
-                } catch (...) {}
+            case 24: // resident memory
+                proc.resident_memory = parseUnsigned(p, end) * pageSize(); // pages to bytes
                 break;
-            case 23: // resident memory
-                try {
-                    proc.resident_memory = std::stoull(token) * 4096; // pages to bytes
-                } catch (...) {}
+            default:
+                skipField(p, end);
                 break;
         }
     }
     
-    // Read /proc/pid/status for memory info
-    std::string status_path = "/proc/" + std::to_string(pid) + "/status";
-    std::ifstream status_file(status_path);
-    
-    if (status_file.is_open()) {
-        std::string status_line;
-        while (std::getline(status_file, status_line)) {
-            if (status_line.find("VmRSS:") == 0) {
-                std::istringstream ss(status_line);
-                std::string key, value, unit;
-                ss >> key >> value >> unit;
-                try {
-                    uint64_t kb = std::stoull(value);
-                    proc.memory_bytes = kb * 1024;
-                } catch (...) {}
-            }
-        }
-    }
-    
-    if (status_file.is_open()) {
-        status_file.seekg(0);
-        std::string uid_line;
-        while (std::getline(status_file, uid_line)) {
-            if (uid_line.find("Uid:") == 0) {
-                std::istringstream ss(uid_line);
-                std::string key, uid_str;
-                ss >> key >> uid_str;
-                try {
-                    uid_t uid = std::stoi(uid_str);
-                    struct passwd* pw = getpwuid(uid);
-                    if (pw) {
-                        proc.user = pw->pw_name;
-                    }
-                } catch (...) {}
-                break;
+    return true;
+}
+
+bool parseStatusBuffer(const char* data, size_t len, uint64_t& rss_bytes, unsigned& uid) {
+    const char* p = data;
+    const char* end = data + len;
+    bool found_uid = false;
+    
+    // Uid: precedes VmRSS: in every kernel layout, so stop once both are seen
+    while (p < end) {
+        uint64_t value = 0;
+        if (!found_uid && matchKey(p, end, "Uid:", 4, value)) {
+            uid = static_cast<unsigned>(value);
+            found_uid = true;
+        } else if (matchKey(p, end, "VmRSS:", 6, value)) {
+            rss_bytes = value * 1024;
+            break;
+        }
+        p = nextLine(p, end);
+    }
+    
+    return found_uid;
+}
+
+bool parseIoBuffer(const char* data, size_t len, ProcessInfo& proc) {
+    const char* p = data;
+    const char* end = data + len;
+    int found = 0;
+    
+    // rchar/wchar also count page cache hits and pipes; read_bytes and
+    // write_bytes are what actually reached the block layer
+    while (p < end && found < 4) {
+        uint64_t value = 0;
+        if (matchKey(p, end, "syscr:", 6, value)) {
+            proc.io_syscr = value;
+            ++found;
+        } else if (matchKey(p, end, "syscw:", 6, value)) {
+            proc.io_syscw = value;
+            ++found;
+        } else if (matchKey(p, end, "read_bytes:", 11, value)) {
+            proc.io_read_bytes = value;
+            ++found;
+        } else if (matchKey(p, end, "write_bytes:", 12, value)) {
+            proc.io_write_bytes = value;
+            ++found;
+        }
+        p = nextLine(p, end);
+    }
+    
+    proc.io_available = found == 4;
+    return proc.io_available;
+}
+
+bool parseSmapsRollupBuffer(const char* data, size_t len, MemoryFootprint& footprint) {
+    const char* p = data;
+    const char* end = data + len;
+    bool found_pss = false;
+    
+    // The first line is the "[rollup]" pseudo-mapping header; the keys
+    // carry their colon so Pss: does not also match Pss_Anon:
+    while (p < end) {
+        uint64_t value = 0;
+        if (matchKey(p, end, "Rss:", 4, value)) {
+            footprint.rss = value * 1024;
+        } else if (matchKey(p, end, "Pss:", 4, value)) {
+            footprint.pss = value * 1024;
+            found_pss = true;
+        } else if (matchKey(p, end, "Private_Clean:", 14, value)) {
+            footprint.uss += value * 1024;
+        } else if (matchKey(p, end, "Private_Dirty:", 14, value)) {
+            footprint.uss += value * 1024;
+        } else if (matchKey(p, end, "Swap:", 5, value)) {
+            footprint.swap = value * 1024;
+        } else if (matchKey(p, end, "SwapPss:", 8, value)) {
+            footprint.swap_pss = value * 1024;
+        }
+        p = nextLine(p, end);
+    }
+    
+    return found_pss;
+}
+
+bool readSmapsRollup(int pid, MemoryFootprint& footprint) {
+    char path[64];
+    formatProcPath(path, sizeof(path), pid, "smaps_rollup");
+    char* buf = readBuffer();
+    ssize_t len = readProcFile(path, buf, kReadBufferSize);
+    if (len <= 0) {
+        return false;
+    }
+    footprint = MemoryFootprint();
+    return parseSmapsRollupBuffer(buf, static_cast<size_t>(len), footprint);
+}
+
+std::vector<int> listPids() {
+    std::vector<int> pids;
+    DIR* proc_dir = opendir("/proc");
+    
+    if (!proc_dir) {
+        return pids;
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(proc_dir)) != nullptr) {
+        if (entry->d_type != DT_DIR) {
+            continue;
+        }
+        
+        int pid = 0;
+        const char* c = entry->d_name;
+        for (; *c >= '0' && *c <= '9'; ++c) {
+            pid = pid * 10 + (*c - '0');
+        }
+        if (*c == '\0' && pid > 0) {
+            pids.push_back(pid);
+        }
+    }
+    
+    closedir(proc_dir);
+    return pids;
+}
+
+std::vector<ProcessInfo> parseProcesses() {
+    return parseProcesses(listPids(), nullptr);
+}
+
+std::vector<ProcessInfo> parseProcesses(const std::vector<int>& pids, ThreadPool* pool) {
+    beginScanTick();
+    std::vector<ProcessInfo> processes = scanProcesses(pids, pool, ScanDepth::Full);
+    endScanTick(0);
+    return processes;
+}
+
+void beginScanTick() {
+    fdCache().beginTick();
+}
+
+void endScanTick(unsigned max_idle_ticks) {
+    fdCache().sweep(max_idle_ticks);
+}
+
+std::vector<ProcessInfo> scanProcesses(const std::vector<int>& pids, ThreadPool* pool, ScanDepth depth) {
+    std::vector<ProcessInfo> processes;
+    auto parse = depth == ScanDepth::Full ? &parseProcessInfo : &parseProcessStat;
+    
+    if (!pool || pool->size() == 1) {
+        processes.reserve(pids.size());
+        for (int pid : pids) {
+            ProcessInfo proc = parse(pid);
+            if (proc.pid > 0) {
+                processes.push_back(std::move(proc));
+            }
+        }
+    } else {
+        // Each worker appends to its own buffer; chunks are claimed
+        // dynamically so slow PIDs do not stall a static partition
+        std::vector<std::vector<ProcessInfo>> per_worker(pool->size());
+        pool->parallelFor(pids.size(), kScanChunkSize, [&](size_t worker, size_t begin, size_t end) {
+            auto& out = per_worker[worker];
+            for (size_t i = begin; i < end; ++i) {
+                ProcessInfo proc = parse(pids[i]);
+                if (proc.pid > 0) {
+                    out.push_back(std::move(proc));
+                }
             }
+        });
+        
+        size_t total = 0;
+        for (const auto& out : per_worker) {
+            total += out.size();
+        }
+        processes.reserve(total);
+        for (auto& out : per_worker) {
+            std::move(out.begin(), out.end(), std::back_inserter(processes));
+        }
+    }
+    
+    return processes;
+}
+
+std::vector<ThreadInfo> parseThreads(int pid) {
+    std::vector<ThreadInfo> threads;
+    char path[64];
+    formatProcPath(path, sizeof(path), pid, "task");
+    DIR* task_dir = opendir(path);
+    if (!task_dir) {
+        return threads;
+    }
+    
+    // Threads come and go too quickly to be worth a cached fd each, so
+    // every task stat is a plain open/read/close
+    char* buf = readBuffer();
+    ProcessInfo task;
+    struct dirent* entry;
+    while ((entry = readdir(task_dir)) != nullptr) {
+        int tid = 0;
+        const char* c = entry->d_name;
+        for (; *c >= '0' && *c <= '9'; ++c) {
+            tid = tid * 10 + (*c - '0');
+        }
+        if (*c != '\0' || tid <= 0) {
+            continue;
+        }
+        
+        char stat_path[96];
+        std::snprintf(stat_path, sizeof(stat_path), "/proc/%d/task/%d/stat", pid, tid);
+        ssize_t len = readProcFile(stat_path, buf, kReadBufferSize);
+        if (len <= 0 || !parseStatBuffer(buf, static_cast<size_t>(len), task)) {
+            continue; // exited since readdir
+        }
+        
+        ThreadInfo thread;
+        thread.tid = tid;
+        thread.name = std::move(task.name);
+        thread.state = task.state;
+        thread.utime = task.utime;
+        thread.stime = task.stime;
+        thread.start_time = task.start_time;
+        threads.push_back(std::move(thread));
+    }
+    
+    closedir(task_dir);
+    return threads;
+}
+
+namespace {
+
+// Reads /proc/pid/stat through the fd cache, re-reading once if the cached
+// fds turned out to belong to an earlier process with this PID
+bool readStat(int pid, ProcFdCacheShard& cache, char* buf, ProcessInfo& proc) {
+    ssize_t len = cache.read(pid, kStatFile, buf, kReadBufferSize);
+    if (len <= 0 || !parseStatBuffer(buf, static_cast<size_t>(len), proc)) {
+        // Process vanished between readdir and open
+        return false;
+    }
+    if (cache.checkStartTime(pid, proc.start_time)) {
+        len = cache.read(pid, kStatFile, buf, kReadBufferSize);
+        if (len <= 0 || !parseStatBuffer(buf, static_cast<size_t>(len), proc)) {
+            return false;
         }
     }
+    proc.pid = pid;
+    return true;
+}
+
+} // namespace
+
+ProcessInfo parseProcessStat(int pid) {
+    ProcessInfo proc;
+    readStat(pid, fdCache().shard(pid), readBuffer(), proc);
+    return proc;
+}
+
+ProcessInfo parseProcessInfo(int pid) {
+    ProcessInfo proc;
+    char* buf = readBuffer();
+    
+    ProcFdCacheShard& cache = fdCache().shard(pid);
+    if (!readStat(pid, cache, buf, proc)) {
+        return proc;
+    }
+    
+    // Read /proc/pid/status for memory and owner
+    ssize_t len = cache.read(pid, kStatusFile, buf, kReadBufferSize);
+    unsigned uid = 0;
+    if (len > 0 && parseStatusBuffer(buf, static_cast<size_t>(len), proc.memory_bytes, uid)) {
+        proc.user = UserCache::instance().lookup(uid);
+    }
     
+    // Read /proc/pid/io; denied for other users' processes unless root
+    len = cache.read(pid, kIoFile, buf, kReadBufferSize);
+    if (len > 0) {
+        parseIoBuffer(buf, static_cast<size_t>(len), proc);
+    }
+    
+    // cpu_percent is derived from utime/stime deltas by SystemMonitor
     proc.cpu_percent = 0.0;
     proc.memory_percent = 0.0;
     
@@ -193,4 +1406,3 @@ ProcessInfo parseProcessInfo(int pid) {
 }
 
 } // namespace LinuxMonitor
-
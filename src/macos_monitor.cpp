@@ -1,4 +1,5 @@
 #include "macos_monitor.hpp"
+#include "user_cache.hpp"
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -10,7 +11,6 @@
 #include <mach/mach_init.h>
 #include <mach/mach_error.h>
 #include <libproc.h>
-#include <pwd.h>
 #include <algorithm>
 
 namespace MacOSMonitor {
@@ -74,6 +74,15 @@ MemoryStats parseMemoryStats() {
         stats.used = used_memory;
         stats.cached = vm_stat.inactive_count * page_size;
         stats.buffers = 0; // macOS doesn't have buffers like Linux
+        stats.available = free_memory + stats.cached;
+        
+        struct xsw_usage swap;
+        size_t swap_length = sizeof(swap);
+        int swap_mib[2] = {CTL_VM, VM_SWAPUSAGE};
+        if (sysctl(swap_mib, 2, &swap, &swap_length, NULL, 0) == 0) {
+            stats.swap_total = swap.xsu_total;
+            stats.swap_free = swap.xsu_avail;
+        }
         
         if (stats.total > 0) {
             stats.percent_used = (static_cast<double>(stats.used) / stats.total) * 100.0;
@@ -131,20 +140,16 @@ ProcessInfo parseProcessInfo(int pid) {
     
     if (sysctl(mib, 4, &kp, &size, NULL, 0) == 0 && size > 0) {
         uid_t uid = kp.kp_eproc.e_ucred.cr_uid;
-        struct passwd* pw = getpwuid(uid);
-        if (pw) {
-            proc.user = pw->pw_name;
-        } else {
-            proc.user = std::to_string(uid);
-        }
+        proc.user = UserCache::instance().lookup(uid);
+        proc.ppid = kp.kp_eproc.e_ppid;
         
         switch (kp.kp_proc.p_stat) {
-            case SIDL: proc.state = "I"; break;
-            case SRUN: proc.state = "R"; break;
-            case SSLEEP: proc.state = "S"; break;
-            case SSTOP: proc.state = "T"; break;
-            case SZOMB: proc.state = "Z"; break;
-            default: proc.state = "?"; break;
+            case SIDL: proc.state = 'I'; break;
+            case SRUN: proc.state = 'R'; break;
+            case SSLEEP: proc.state = 'S'; break;
+            case SSTOP: proc.state = 'T'; break;
+            case SZOMB: proc.state = 'Z'; break;
+            default: proc.state = '?'; break;
         }
         
         struct proc_taskinfo proc_info;
@@ -168,6 +173,14 @@ ProcessInfo parseProcessInfo(int pid) {
         }
     }
     
+    // Disk I/O totals; macOS has no per-process syscall counts
+    struct rusage_info_v2 usage;
+    if (proc_pid_rusage(pid, RUSAGE_INFO_V2, reinterpret_cast<rusage_info_t*>(&usage)) == 0) {
+        proc.io_read_bytes = usage.ri_diskio_bytesread;
+        proc.io_write_bytes = usage.ri_diskio_byteswritten;
+        proc.io_available = true;
+    }
+    
     proc.cpu_percent = 0.0;
     proc.memory_percent = 0.0;
     
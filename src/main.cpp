@@ -1,13 +1,115 @@
 #include "tui.hpp"
+#include "capture.hpp"
+#include "replay.hpp"
+#ifndef __APPLE__
+#include "linux_monitor.hpp"
+#endif
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <exception>
+#include <string>
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tbm [options]\n"
+              << "  -j, --workers N   Scan /proc with N threads (default 1)\n"
+              << "      --no-netlink  Find processes by scanning /proc instead of proc connector events\n"
+              << "      --threads-top N  Also collect threads of the N busiest processes (default 0)\n"
+              << "      --all-disks   Show partitions and loop/ram devices in the disk panel\n"
+              << "      --cold-interval K  Sample idle processes every K ticks (default 8, 1 = every tick)\n"
+              << "      --pss-rate N  smaps_rollup reads per second for on-screen rows (default 10, 0 = off)\n"
+              << "      --record FILE Also write every tick to a capture file\n"
+              << "      --replay FILE Play a capture back instead of monitoring this machine\n"
+              << "  -h, --help        Show this message\n";
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    MonitorOptions options;
+    std::string record_path;
+    std::string replay_path;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else if ((arg == "-j" || arg == "--workers") && i + 1 < argc) {
+            try {
+                options.worker_threads = std::stoul(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "tbm: invalid worker count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--threads-top" && i + 1 < argc) {
+            try {
+                options.thread_top_n = std::stoul(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "tbm: invalid thread count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cold-interval" && i + 1 < argc) {
+            try {
+                options.cold_interval = static_cast<unsigned>(std::stoul(argv[++i]));
+            } catch (const std::exception&) {
+                std::cerr << "tbm: invalid interval '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--pss-rate" && i + 1 < argc) {
+            try {
+                options.footprint_rate = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "tbm: invalid rate '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--all-disks") {
+            options.show_partitions = true;
+            options.show_virtual_disks = true;
+        } else if (arg == "--no-netlink") {
+            options.use_proc_connector = false;
+        } else {
+            std::cerr << "tbm: unknown option '" << arg << "'" << std::endl;
+            printUsage();
+            return 1;
+        }
+    }
+    
+    if (!record_path.empty() && !replay_path.empty()) {
+        std::cerr << "tbm: --record and --replay cannot be combined" << std::endl;
+        return 1;
+    }
+#ifndef __APPLE__
+    if (replay_path.empty()) {
+        LinuxMonitor::raiseFileLimit();
+    }
+#endif
+    std::unique_ptr<CaptureWriter> recorder;
+    if (!record_path.empty()) {
+        recorder = std::make_unique<CaptureWriter>();
+        if (!recorder->open(record_path)) {
+            std::cerr << "tbm: cannot record to '" << record_path << "': " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+    std::unique_ptr<Replay> replay;
+    if (!replay_path.empty()) {
+        replay = std::make_unique<Replay>();
+        if (!replay->open(replay_path)) {
+            std::cerr << "tbm: cannot replay '" << replay_path << "': "
+                      << (errno == EINVAL ? "not a capture file" : std::strerror(errno)) << std::endl;
+            return 1;
+        }
+    }
     
     try {
-        TUI tui;
+        TUI tui(options, std::move(recorder), std::move(replay));
         tui.run();
         return 0;
     } catch (const std::exception& e) {
@@ -15,4 +117,3 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 }
-
@@ -0,0 +1,220 @@
+#include "proc_connector.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+
+namespace {
+
+constexpr int kAckTimeoutMs = 250;
+
+void readComm(int pid, char (&comm)[16]) {
+    comm[0] = '\0';
+    char path[64];
+    std::snprintf(path, sizeof(path), "/proc/%d/comm", pid);
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t n = read(fd, comm, sizeof(comm) - 1);
+    close(fd);
+    if (n > 0) {
+        comm[n] = '\0';
+        if (comm[n - 1] == '\n') {
+            comm[n - 1] = '\0';
+        }
+    }
+}
+
+} // namespace
+
+ProcConnector::ProcConnector() : fd_(-1), wake_fd_(-1), stopping_(false), overflowed_(false) {}
+
+ProcConnector::~ProcConnector() {
+    stopping_ = true;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wake_fd_, &one, sizeof(one));
+        (void)written;
+    }
+    if (listener_.joinable()) {
+        listener_.join();
+    }
+    if (fd_ >= 0) {
+        subscribe(false);
+        close(fd_);
+    }
+    if (wake_fd_ >= 0) {
+        close(wake_fd_);
+    }
+}
+
+bool ProcConnector::open() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    
+    fd_ = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (fd_ < 0) {
+        return false;
+    }
+    
+    // Give bursts of fork/exit room before the kernel starts dropping
+    int rcvbuf = 4 * 1024 * 1024;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    
+    struct sockaddr_nl addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0;
+    
+    if (bind(fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        !subscribe(true) || !waitForAck()) {
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    
+    // Lets the destructor interrupt the listener's poll immediately
+    wake_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        subscribe(false);
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    
+    listener_ = std::thread(&ProcConnector::listenLoop, this);
+    return true;
+}
+
+bool ProcConnector::drain(std::vector<ProcEvent>& out) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    out.swap(queue_);
+    queue_.clear();
+    bool ok = !overflowed_;
+    overflowed_ = false;
+    return ok;
+}
+
+bool ProcConnector::subscribe(bool enable) {
+    constexpr size_t kPayload = sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op);
+    alignas(struct nlmsghdr) char request[NLMSG_SPACE(kPayload)];
+    std::memset(request, 0, sizeof(request));
+    
+    struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(request);
+    header->nlmsg_len = NLMSG_LENGTH(kPayload);
+    header->nlmsg_type = NLMSG_DONE;
+    header->nlmsg_pid = static_cast<__u32>(getpid());
+    
+    struct cn_msg* message = static_cast<struct cn_msg*>(NLMSG_DATA(header));
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(enum proc_cn_mcast_op);
+    
+    enum proc_cn_mcast_op op = enable ? PROC_CN_MCAST_LISTEN : PROC_CN_MCAST_IGNORE;
+    std::memcpy(message->data, &op, sizeof(op));
+    
+    return send(fd_, request, header->nlmsg_len, 0) == static_cast<ssize_t>(header->nlmsg_len);
+}
+
+// The kernel answers LISTEN with a PROC_EVENT_NONE ack; without
+// CAP_NET_ADMIN it either reports EPERM or never answers at all
+bool ProcConnector::waitForAck() {
+    struct pollfd pfd = {fd_, POLLIN, 0};
+    int remaining = kAckTimeoutMs;
+    while (remaining > 0) {
+        if (poll(&pfd, 1, 50) <= 0) {
+            remaining -= 50;
+            continue;
+        }
+        bool got_ack = false;
+        int ack_err = 0;
+        receive(got_ack, ack_err);
+        if (got_ack) {
+            return ack_err == 0;
+        }
+    }
+    return false;
+}
+
+void ProcConnector::listenLoop() {
+    struct pollfd pfds[2] = {{fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    while (!stopping_) {
+        if (poll(pfds, 2, -1) <= 0 || !(pfds[0].revents & POLLIN)) {
+            continue;
+        }
+        bool got_ack = false;
+        int ack_err = 0;
+        if (!receive(got_ack, ack_err)) {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            overflowed_ = true;
+        }
+    }
+}
+
+bool ProcConnector::receive(bool& got_ack, int& ack_err) {
+    alignas(struct nlmsghdr) char buffer[8192];
+    ssize_t len = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (len < 0) {
+        return errno != ENOBUFS;
+    }
+    
+    for (struct nlmsghdr* header = reinterpret_cast<struct nlmsghdr*>(buffer);
+         NLMSG_OK(header, static_cast<unsigned>(len));
+         header = NLMSG_NEXT(header, len)) {
+        if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) {
+            continue;
+        }
+        
+        const struct cn_msg* message = static_cast<const struct cn_msg*>(NLMSG_DATA(header));
+        if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+            continue;
+        }
+        const struct proc_event* event = reinterpret_cast<const struct proc_event*>(message->data);
+        
+        ProcEvent out;
+        std::memset(&out, 0, sizeof(out));
+        switch (event->what) {
+            case proc_event::PROC_EVENT_NONE:
+                got_ack = true;
+                ack_err = static_cast<int>(event->event_data.ack.err);
+                continue;
+            case proc_event::PROC_EVENT_FORK:
+                // New threads share the parent's tgid; only track processes
+                if (event->event_data.fork.child_pid != event->event_data.fork.child_tgid) {
+                    continue;
+                }
+                out.type = ProcEvent::Fork;
+                out.pid = event->event_data.fork.child_tgid;
+                out.parent_pid = event->event_data.fork.parent_tgid;
+                break;
+            case proc_event::PROC_EVENT_EXEC:
+                out.type = ProcEvent::Exec;
+                out.pid = event->event_data.exec.process_tgid;
+                readComm(out.pid, out.comm);
+                break;
+            case proc_event::PROC_EVENT_EXIT:
+                if (event->event_data.exit.process_pid != event->event_data.exit.process_tgid) {
+                    continue;
+                }
+                out.type = ProcEvent::Exit;
+                out.pid = event->event_data.exit.process_tgid;
+                break;
+            default:
+                continue;
+        }
+        
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.push_back(out);
+    }
+    return true;
+}
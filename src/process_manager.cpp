@@ -1,6 +1,27 @@
 #include "process_manager.hpp"
 #include "fuzzy_search.hpp"
 #include <algorithm>
+#include <numeric>
+
+namespace {
+
+constexpr double kUnscored = -2.0;
+constexpr double kNoMatch = -1.0;
+
+// Busier first: by CPU, then memory, as the monitor used to order the list
+// before the table went to PID order; PID last so that equal rows keep
+// their places from one frame to the next
+bool busier(const ProcessTable& table, uint32_t a, uint32_t b) {
+    if (table.cpu_percent[a] != table.cpu_percent[b]) {
+        return table.cpu_percent[a] > table.cpu_percent[b];
+    }
+    if (table.memory_percent[a] != table.memory_percent[b]) {
+        return table.memory_percent[a] > table.memory_percent[b];
+    }
+    return table.pid[a] < table.pid[b];
+}
+
+} // namespace
 
 ProcessManager::ProcessManager() = default;
 
@@ -43,8 +64,12 @@ void ProcessManager::sortProcesses(std::vector<ProcessInfo>& processes,
               [criteria, descending](const ProcessInfo& a, const ProcessInfo& b) {
                   switch (criteria) {
                       case SortBy::CPU:
-                          return descending ? (a.cpu_percent > b.cpu_percent) 
-                                            : (a.cpu_percent < b.cpu_percent);
+                          if (a.cpu_percent != b.cpu_percent) {
+                              return descending ? (a.cpu_percent > b.cpu_percent)
+                                                : (a.cpu_percent < b.cpu_percent);
+                          }
+                          return descending ? (a.memory_percent > b.memory_percent)
+                                            : (a.memory_percent < b.memory_percent);
                       case SortBy::MEMORY:
                           return descending ? (a.memory_percent > b.memory_percent)
                                             : (a.memory_percent < b.memory_percent);
@@ -52,9 +77,137 @@ void ProcessManager::sortProcesses(std::vector<ProcessInfo>& processes,
                           return descending ? (a.pid > b.pid) : (a.pid < b.pid);
                       case SortBy::NAME:
                           return descending ? (a.name > b.name) : (a.name < b.name);
+                      case SortBy::IO_READ:
+                          return descending ? (a.io_read_rate > b.io_read_rate)
+                                            : (a.io_read_rate < b.io_read_rate);
+                      case SortBy::IO_WRITE:
+                          return descending ? (a.io_write_rate > b.io_write_rate)
+                                            : (a.io_write_rate < b.io_write_rate);
+                      case SortBy::IO_TOTAL: {
+                          const double io_a = a.io_read_rate + a.io_write_rate;
+                          const double io_b = b.io_read_rate + b.io_write_rate;
+                          return descending ? (io_a > io_b) : (io_a < io_b);
+                      }
+                      case SortBy::IO_SYSCR:
+                          return descending ? (a.io_syscr_rate > b.io_syscr_rate)
+                                            : (a.io_syscr_rate < b.io_syscr_rate);
+                      case SortBy::IO_SYSCW:
+                          return descending ? (a.io_syscw_rate > b.io_syscw_rate)
+                                            : (a.io_syscw_rate < b.io_syscw_rate);
                       default:
                           return false;
                   }
               });
 }
 
+void ProcessManager::filterRows(const ProcessTable& table, const StringPool& strings, const std::string& query,
+                                std::vector<uint32_t>& order) const {
+    order.clear();
+    if (query.empty()) {
+        order.resize(table.size());
+        std::iota(order.begin(), order.end(), 0u);
+        return;
+    }
+    
+    // Workers of one program share a name, so each distinct name is scored
+    // once, against the lowercase copy the pool made when it first saw it
+    const std::string lower_query = FuzzySearch::toLower(query);
+    name_scores_.assign(strings.size(), kUnscored);
+    if (name_scores_.capacity() > 2 * name_scores_.size()) {
+        name_scores_.shrink_to_fit(); // the pool was compacted
+    }
+    row_scores_.resize(table.size());
+    for (uint32_t row = 0; row < table.size(); ++row) {
+        double& score = name_scores_[table.name[row]];
+        if (score == kUnscored) {
+            score = FuzzySearch::scoreLowered(strings.lower(table.name[row]), lower_query, 0.3);
+            if (score < 0.0) {
+                score = kNoMatch;
+            }
+        }
+        if (score != kNoMatch) {
+            row_scores_[row] = score;
+            order.push_back(row);
+        }
+    }
+    
+    // The table is in PID order, so equal scores (every worker of a pool)
+    // are ranked busiest first
+    std::sort(order.begin(), order.end(),
+              [this, &table](uint32_t a, uint32_t b) {
+                  if (row_scores_[a] != row_scores_[b]) {
+                      return row_scores_[a] > row_scores_[b];
+                  }
+                  return busier(table, a, b);
+              });
+}
+
+void ProcessManager::sortRows(const ProcessTable& table, const StringPool& strings, SortBy criteria,
+                              bool descending, std::vector<uint32_t>& order) const {
+    order.resize(table.size());
+    std::iota(order.begin(), order.end(), 0u);
+    
+    auto by = [&order, descending](const auto& column) {
+        std::sort(order.begin(), order.end(),
+                  [&column, descending](uint32_t a, uint32_t b) {
+                      return descending ? column[a] > column[b] : column[a] < column[b];
+                  });
+    };
+    switch (criteria) {
+        case SortBy::CPU:
+            std::sort(order.begin(), order.end(),
+                      [&table, descending](uint32_t a, uint32_t b) {
+                          return descending ? busier(table, a, b) : busier(table, b, a);
+                      });
+            break;
+        case SortBy::MEMORY:
+            by(table.memory_percent);
+            break;
+        case SortBy::PID:
+            by(table.pid);
+            break;
+        case SortBy::NAME:
+            std::sort(order.begin(), order.end(),
+                      [&](uint32_t a, uint32_t b) {
+                          const std::string& name_a = strings.get(table.name[a]);
+                          const std::string& name_b = strings.get(table.name[b]);
+                          return descending ? name_a > name_b : name_a < name_b;
+                      });
+            break;
+        case SortBy::IO_READ:
+            by(table.io_read_rate);
+            break;
+        case SortBy::IO_WRITE:
+            by(table.io_write_rate);
+            break;
+        case SortBy::IO_TOTAL:
+            std::sort(order.begin(), order.end(),
+                      [&](uint32_t a, uint32_t b) {
+                          const double io_a = table.io_read_rate[a] + table.io_write_rate[a];
+                          const double io_b = table.io_read_rate[b] + table.io_write_rate[b];
+                          return descending ? io_a > io_b : io_a < io_b;
+                      });
+            break;
+        case SortBy::IO_SYSCR:
+            by(table.io_syscr_rate);
+            break;
+        case SortBy::IO_SYSCW:
+            by(table.io_syscw_rate);
+            break;
+    }
+}
+
+const char* ProcessManager::sortName(SortBy criteria) {
+    switch (criteria) {
+        case SortBy::CPU: return "CPU";
+        case SortBy::MEMORY: return "Memory";
+        case SortBy::PID: return "PID";
+        case SortBy::NAME: return "Name";
+        case SortBy::IO_READ: return "Read/s";
+        case SortBy::IO_WRITE: return "Write/s";
+        case SortBy::IO_TOTAL: return "I/O";
+        case SortBy::IO_SYSCR: return "Rd calls/s";
+        case SortBy::IO_SYSCW: return "Wr calls/s";
+    }
+    return "";
+}
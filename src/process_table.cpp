@@ -0,0 +1,183 @@
+#include "process_table.hpp"
+#include "fuzzy_search.hpp"
+#include <algorithm>
+
+namespace {
+
+bool sameFootprint(const MemoryFootprint& a, const MemoryFootprint& b) {
+    return a.rss == b.rss && a.pss == b.pss && a.uss == b.uss && a.swap == b.swap && a.swap_pss == b.swap_pss;
+}
+
+} // namespace
+
+StringPool::StringPool() : generation_(0) {
+    intern(std::string_view());
+}
+
+StringPool::Id StringPool::intern(std::string_view value) {
+    auto it = index_.find(value);
+    if (it != index_.end()) {
+        return it->second;
+    }
+    const Id id = static_cast<Id>(strings_.size());
+    strings_.emplace_back(value);
+    index_.emplace(std::string_view(strings_.back()), id);
+    lower_.emplace_back(value);
+    std::transform(lower_.back().begin(), lower_.back().end(), lower_.back().begin(), FuzzySearch::toLowerAscii);
+    return id;
+}
+
+void StringPool::syncFrom(const StringPool& source) {
+    if (generation_ != source.generation_) {
+        strings_.clear();
+        lower_.clear();
+        index_.clear();
+        generation_ = source.generation_;
+    }
+    for (size_t id = strings_.size(); id < source.strings_.size(); ++id) {
+        strings_.push_back(source.strings_[id]);
+        index_.emplace(std::string_view(strings_.back()), static_cast<Id>(id));
+        lower_.push_back(source.lower_[id]);
+    }
+}
+
+void StringPool::compact(const std::vector<uint8_t>& live, std::vector<Id>& remap) {
+    std::deque<std::string> strings;
+    std::deque<std::string> lower;
+    remap.assign(strings_.size(), 0);
+    for (size_t id = 0; id < strings_.size(); ++id) {
+        if (id == 0 || (id < live.size() && live[id])) {
+            remap[id] = static_cast<Id>(strings.size());
+            strings.push_back(std::move(strings_[id]));
+            lower.push_back(std::move(lower_[id]));
+        }
+    }
+    strings_.swap(strings);
+    lower_.swap(lower);
+    // Keys point into the strings, which have moved
+    index_.clear();
+    for (size_t id = 0; id < strings_.size(); ++id) {
+        index_.emplace(std::string_view(strings_[id]), static_cast<Id>(id));
+    }
+    ++generation_;
+}
+
+void ProcessTable::clear() {
+    pid.clear();
+    ppid.clear();
+    start_time.clear();
+    name.clear();
+    user.clear();
+    state.clear();
+    num_threads.clear();
+    cpu_percent.clear();
+    memory_percent.clear();
+    memory_bytes.clear();
+    io_read_rate.clear();
+    io_write_rate.clear();
+    io_syscr_rate.clear();
+    io_syscw_rate.clear();
+    io_available.clear();
+    sample_age.clear();
+    footprint.clear();
+    footprint_age.clear();
+}
+
+void ProcessTable::remapStrings(const std::vector<StringPool::Id>& remap) {
+    for (auto& id : name) {
+        id = remap[id];
+    }
+    for (auto& id : user) {
+        id = remap[id];
+    }
+}
+
+void ProcessTable::append(const ProcessInfo& proc, StringPool& strings) {
+    pid.push_back(proc.pid);
+    ppid.push_back(proc.ppid);
+    start_time.push_back(proc.start_time);
+    name.push_back(strings.intern(proc.name));
+    user.push_back(strings.intern(proc.user));
+    state.push_back(proc.state);
+    num_threads.push_back(proc.num_threads);
+    cpu_percent.push_back(proc.cpu_percent);
+    memory_percent.push_back(proc.memory_percent);
+    memory_bytes.push_back(proc.memory_bytes);
+    io_read_rate.push_back(proc.io_read_rate);
+    io_write_rate.push_back(proc.io_write_rate);
+    io_syscr_rate.push_back(proc.io_syscr_rate);
+    io_syscw_rate.push_back(proc.io_syscw_rate);
+    io_available.push_back(proc.io_available ? 1 : 0);
+    sample_age.push_back(proc.sample_age);
+    footprint.push_back(proc.footprint);
+    footprint_age.push_back(proc.footprint_available ? proc.footprint_age : -1.0);
+}
+
+void ProcessDelta::compute(const ProcessTable& before, const ProcessTable& after) {
+    added.clear();
+    removed.clear();
+    changed.clear();
+    changed_fields.clear();
+    unchanged = 0;
+    
+    size_t i = 0;
+    size_t j = 0;
+    while (i < before.size() || j < after.size()) {
+        if (j == after.size() || (i < before.size() && before.pid[i] < after.pid[j])) {
+            removed.push_back(before.pid[i++]);
+            continue;
+        }
+        if (i == before.size() || after.pid[j] < before.pid[i]) {
+            added.push_back(static_cast<uint32_t>(j++));
+            continue;
+        }
+        if (before.start_time[i] != after.start_time[j]) {
+            removed.push_back(before.pid[i]);
+            added.push_back(static_cast<uint32_t>(j));
+            ++i;
+            ++j;
+            continue;
+        }
+        
+        uint32_t fields = 0;
+        if (before.ppid[i] != after.ppid[j]) {
+            fields |= kFieldParent;
+        }
+        if (before.name[i] != after.name[j] || before.user[i] != after.user[j]) {
+            fields |= kFieldName;
+        }
+        if (before.state[i] != after.state[j]) {
+            fields |= kFieldState;
+        }
+        if (before.num_threads[i] != after.num_threads[j]) {
+            fields |= kFieldThreads;
+        }
+        if (before.cpu_percent[i] != after.cpu_percent[j]) {
+            fields |= kFieldCPU;
+        }
+        if (before.memory_bytes[i] != after.memory_bytes[j] || before.memory_percent[i] != after.memory_percent[j]) {
+            fields |= kFieldMemory;
+        }
+        if (before.io_read_rate[i] != after.io_read_rate[j] || before.io_write_rate[i] != after.io_write_rate[j] ||
+            before.io_syscr_rate[i] != after.io_syscr_rate[j] || before.io_syscw_rate[i] != after.io_syscw_rate[j] ||
+            before.io_available[i] != after.io_available[j]) {
+            fields |= kFieldIO;
+        }
+        if ((before.sample_age[i] > 0) != (after.sample_age[j] > 0)) {
+            fields |= kFieldStale;
+        }
+        if ((before.footprint_age[i] < 0) != (after.footprint_age[j] < 0) ||
+            !sameFootprint(before.footprint[i], after.footprint[j])) {
+            fields |= kFieldFootprint;
+        }
+        
+        if (fields != 0) {
+            changed.push_back(static_cast<uint32_t>(j));
+            changed_fields.push_back(fields);
+        } else {
+            ++unchanged;
+        }
+        ++i;
+        ++j;
+    }
+}
@@ -0,0 +1,226 @@
+#include "process_tree.hpp"
+#include <algorithm>
+
+namespace {
+
+bool busierSubtree(const ProcessTree::Node* a, const ProcessTree::Node* b) {
+    if (a->subtree_cpu != b->subtree_cpu) {
+        return a->subtree_cpu > b->subtree_cpu;
+    }
+    return a->pid < b->pid;
+}
+
+} // namespace
+
+ProcessTree::ProcessTree() : tick_(0) {}
+
+void ProcessTree::update(const std::vector<ProcessInfo>& processes) {
+    ++tick_;
+    last_update_ = UpdateStats();
+    std::vector<const ProcessInfo*> added;
+    std::vector<int> reparented;
+    
+    for (const auto& proc : processes) {
+        auto it = nodes_.find(proc.pid);
+        if (it != nodes_.end() && it->second.start_time != proc.start_time) {
+            // PID reused by a different process
+            remove(proc.pid);
+            it = nodes_.end();
+        }
+        if (it == nodes_.end()) {
+            added.push_back(&proc);
+            continue;
+        }
+        
+        Node& node = it->second;
+        node.seen = tick_;
+        if (node.cpu_percent != proc.cpu_percent || node.memory_bytes != proc.memory_bytes) {
+            node.cpu_percent = proc.cpu_percent;
+            node.memory_bytes = proc.memory_bytes;
+            markDirty(node);
+        }
+        if (node.ppid != proc.ppid) {
+            node.ppid = proc.ppid;
+            reparented.push_back(proc.pid);
+        }
+    }
+    
+    std::vector<int> vanished;
+    for (const auto& [pid, node] : nodes_) {
+        if (node.seen != tick_) {
+            vanished.push_back(pid);
+        }
+    }
+    for (int pid : vanished) {
+        remove(pid);
+    }
+    
+    // Create every new node before linking any, so a parent and child that
+    // appeared in the same tick find each other regardless of order
+    for (const ProcessInfo* proc : added) {
+        Node& node = nodes_[proc->pid];
+        node.pid = proc->pid;
+        node.ppid = proc->ppid;
+        node.start_time = proc->start_time;
+        node.cpu_percent = proc->cpu_percent;
+        node.memory_bytes = proc->memory_bytes;
+        node.seen = tick_;
+    }
+    for (const ProcessInfo* proc : added) {
+        link(nodes_.at(proc->pid));
+    }
+    for (int pid : reparented) {
+        Node& node = nodes_.at(pid);
+        unlink(node);
+        link(node);
+    }
+    
+    // Roots whose parent showed up later, e.g. after a PID wrap
+    std::vector<int> orphans;
+    for (int pid : roots_) {
+        const int ppid = nodes_.at(pid).ppid;
+        if (ppid != 0 && nodes_.count(ppid)) {
+            orphans.push_back(pid);
+        }
+    }
+    for (int pid : orphans) {
+        Node& node = nodes_.at(pid);
+        unlink(node);
+        link(node);
+    }
+    
+    for (int pid : roots_) {
+        recompute(nodes_.at(pid));
+    }
+    last_update_.added = added.size();
+    last_update_.removed = vanished.size();
+    last_update_.reparented = reparented.size();
+}
+
+void ProcessTree::link(Node& node) {
+    auto parent = node.ppid != 0 ? nodes_.find(node.ppid) : nodes_.end();
+    if (parent == nodes_.end() || isAncestor(node.pid, node.ppid)) {
+        node.parent = 0;
+        roots_.insert(node.pid);
+        return;
+    }
+    node.parent = node.ppid;
+    parent->second.children.push_back(node.pid);
+    // The node's own totals are either valid or already marked; only the
+    // new parent's path has to be summed again
+    markDirty(parent->second);
+}
+
+void ProcessTree::unlink(Node& node) {
+    if (node.parent == 0) {
+        roots_.erase(node.pid);
+        return;
+    }
+    Node& parent = nodes_.at(node.parent);
+    auto child = std::find(parent.children.begin(), parent.children.end(), node.pid);
+    if (child != parent.children.end()) {
+        *child = parent.children.back();
+        parent.children.pop_back();
+    }
+    markDirty(parent);
+    node.parent = 0;
+}
+
+void ProcessTree::remove(int pid) {
+    auto it = nodes_.find(pid);
+    if (it == nodes_.end()) {
+        return;
+    }
+    Node& node = it->second;
+    unlink(node);
+    // The kernel reparents the children too; until their new ppid is read
+    // they stand as roots with their totals intact
+    for (int child : node.children) {
+        Node& orphan = nodes_.at(child);
+        orphan.parent = 0;
+        roots_.insert(child);
+    }
+    nodes_.erase(it);
+}
+
+bool ProcessTree::isAncestor(int ancestor, int pid) const {
+    while (pid != 0) {
+        if (pid == ancestor) {
+            return true;
+        }
+        auto it = nodes_.find(pid);
+        pid = it != nodes_.end() ? it->second.parent : 0;
+    }
+    return false;
+}
+
+void ProcessTree::markDirty(Node& node) {
+    Node* current = &node;
+    while (current && !current->dirty) {
+        current->dirty = true;
+        current = current->parent != 0 ? &nodes_.at(current->parent) : nullptr;
+    }
+}
+
+void ProcessTree::recompute(Node& node) {
+    if (!node.dirty) {
+        return;
+    }
+    node.subtree_cpu = node.cpu_percent;
+    node.subtree_memory = node.memory_bytes;
+    node.subtree_count = 1;
+    for (int pid : node.children) {
+        Node& child = nodes_.at(pid);
+        recompute(child);
+        node.subtree_cpu += child.subtree_cpu;
+        node.subtree_memory += child.subtree_memory;
+        node.subtree_count += child.subtree_count;
+    }
+    node.dirty = false;
+    ++last_update_.recomputed;
+}
+
+const ProcessTree::Node* ProcessTree::find(int pid) const {
+    auto it = nodes_.find(pid);
+    return it != nodes_.end() ? &it->second : nullptr;
+}
+
+void ProcessTree::flatten(const std::unordered_set<int>& collapsed, std::vector<ProcessTreeRow>& out) const {
+    out.clear();
+    out.reserve(nodes_.size());
+    std::vector<const Node*> roots;
+    roots.reserve(roots_.size());
+    for (int pid : roots_) {
+        roots.push_back(&nodes_.at(pid));
+    }
+    std::sort(roots.begin(), roots.end(), busierSubtree);
+    for (const Node* root : roots) {
+        appendRows(*root, 0, collapsed, out);
+    }
+}
+
+void ProcessTree::appendRows(const Node& node, int depth, const std::unordered_set<int>& collapsed,
+                             std::vector<ProcessTreeRow>& out) const {
+    ProcessTreeRow row;
+    row.pid = node.pid;
+    row.depth = depth;
+    row.has_children = !node.children.empty();
+    row.collapsed = row.has_children && collapsed.count(node.pid) > 0;
+    row.subtree_cpu = node.subtree_cpu;
+    row.subtree_memory = node.subtree_memory;
+    row.subtree_count = node.subtree_count;
+    out.push_back(row);
+    if (!row.has_children || row.collapsed) {
+        return;
+    }
+    
+    std::vector<const Node*> children;
+    children.reserve(node.children.size());
+    for (int pid : node.children) {
+        children.push_back(&nodes_.at(pid));
+    }
+    std::sort(children.begin(), children.end(), busierSubtree);
+    for (const Node* child : children) {
+        appendRows(*child, depth + 1, collapsed, out);
+    }
+}
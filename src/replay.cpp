@@ -0,0 +1,117 @@
+#include "replay.hpp"
+#include <algorithm>
+#include <cerrno>
+
+namespace {
+
+constexpr double kMinSpeed = 0.125;
+constexpr double kMaxSpeed = 64.0;
+
+} // namespace
+
+Replay::Replay() : position_ns_(0), tick_(0), paused_(false), speed_(1.0), history_(0) {}
+
+bool Replay::open(const std::string& path) {
+    if (!reader_.open(path)) {
+        return false;
+    }
+    if (reader_.tickCount() == 0) {
+        errno = ENODATA;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    position_ns_ = reader_.wallTime(0);
+    // Nothing is published until a tick decodes, and the UI needs one
+    if (!show(0)) {
+        errno = EINVAL;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::advance(Clock::duration elapsed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (paused_) {
+        return false;
+    }
+    const int64_t last = reader_.wallTime(reader_.tickCount() - 1);
+    position_ns_ += static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() * speed_);
+    if (position_ns_ >= last) {
+        position_ns_ = last;
+        paused_ = true;
+    }
+    const size_t tick = reader_.findTick(position_ns_);
+    if (tick == tick_) {
+        return false;
+    }
+    return show(tick);
+}
+
+void Replay::togglePause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = !paused_;
+}
+
+void Replay::seek(double seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t first = reader_.wallTime(0);
+    const int64_t last = reader_.wallTime(reader_.tickCount() - 1);
+    position_ns_ += static_cast<int64_t>(seconds * 1e9);
+    if (position_ns_ <= first || position_ns_ >= last) {
+        position_ns_ = std::clamp(position_ns_, first, last);
+        paused_ = true;
+    }
+    const size_t tick = reader_.findTick(position_ns_);
+    if (tick != tick_) {
+        show(tick);
+    }
+}
+
+void Replay::slower() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    speed_ = std::max(kMinSpeed, speed_ / 2);
+}
+
+void Replay::faster() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    speed_ = std::min(kMaxSpeed, speed_ * 2);
+}
+
+Replay::Status Replay::status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status status;
+    status.tick = tick_;
+    status.tick_count = reader_.tickCount();
+    status.wall_ns = reader_.wallTime(tick_);
+    status.paused = paused_;
+    status.speed = speed_;
+    return status;
+}
+
+std::shared_ptr<const Snapshot> Replay::snapshot() const {
+    return std::atomic_load(&published_);
+}
+
+bool Replay::show(size_t tick) {
+    // Replay publishes a few snapshots a second at most, so each gets a
+    // fresh buffer rather than the monitor's recycling
+    auto snap = std::make_shared<Snapshot>();
+    if (!reader_.read(tick, *snap)) {
+        return false;
+    }
+    // Going back starts the history over; it is not stored in the capture
+    if (tick < tick_) {
+        history_ = History(0);
+    }
+    tick_ = tick;
+    
+    const MemoryStats& memory = snap->memory;
+    const double swap_percent = memory.swap_total > 0 ? 100.0 * memory.swapUsed() / memory.swap_total : 0.0;
+    const Clock::time_point when(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(reader_.wallTime(tick))));
+    history_.recordSystem(snap->cpu_usage, snap->core_usage, memory.percent_used, swap_percent, when);
+    snap->history = history_;
+    snap->taken_at = when;
+    std::atomic_store(&published_, std::shared_ptr<const Snapshot>(std::move(snap)));
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "smaps_sampler.hpp"
+#include "linux_monitor.hpp"
+#include <algorithm>
+
+namespace {
+
+// Cached footprints of PIDs that scrolled off screen are kept this long,
+// so scrolling back shows them again without another read
+constexpr std::chrono::seconds kEvictAfter(60);
+
+} // namespace
+
+SmapsSampler::SmapsSampler(double reads_per_second, Clock::duration refresh_interval)
+    : read_gap_(std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / std::max(reads_per_second, 0.01)))),
+      refresh_interval_(refresh_interval), reads_(0), stopping_(false) {
+    worker_ = std::thread(&SmapsSampler::workerLoop, this);
+}
+
+SmapsSampler::~SmapsSampler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_one();
+    worker_.join();
+}
+
+void SmapsSampler::request(const std::vector<std::pair<int, uint64_t>>& wanted) {
+    const auto now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wanted_ = wanted;
+        for (auto it = cache_.begin(); it != cache_.end();) {
+            const bool is_wanted = std::any_of(wanted_.begin(), wanted_.end(),
+                                               [&](const std::pair<int, uint64_t>& w) { return w.first == it->first; });
+            if (!is_wanted && now - it->second.sampled_at > kEvictAfter) {
+                it = cache_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    wake_cv_.notify_one();
+}
+
+void SmapsSampler::collect(std::vector<Result>& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [pid, start_time] : wanted_) {
+        auto it = cache_.find(pid);
+        if (it == cache_.end() || !it->second.valid || it->second.start_time != start_time) {
+            continue;
+        }
+        out.push_back({pid, start_time, it->second.footprint, it->second.sampled_at});
+    }
+}
+
+bool SmapsSampler::nextDue(int& pid, uint64_t& start_time, Clock::time_point& due) const {
+    bool found = false;
+    for (const auto& [wanted_pid, wanted_start] : wanted_) {
+        auto it = cache_.find(wanted_pid);
+        if (it == cache_.end() || it->second.start_time != wanted_start) {
+            // Never read (or the PID was reused): due right away, in list order
+            pid = wanted_pid;
+            start_time = wanted_start;
+            due = Clock::time_point::min();
+            return true;
+        }
+        if (!it->second.valid) {
+            continue;
+        }
+        const Clock::time_point refresh_at = it->second.sampled_at + refresh_interval_;
+        if (!found || refresh_at < due) {
+            pid = wanted_pid;
+            start_time = wanted_start;
+            due = refresh_at;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void SmapsSampler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Clock::time_point next_read = Clock::now();
+    while (!stopping_) {
+        int pid = 0;
+        uint64_t start_time = 0;
+        Clock::time_point due;
+        if (!nextDue(pid, start_time, due)) {
+            wake_cv_.wait(lock);
+            continue;
+        }
+        // The wanted list may change while we wait, so pick again afterwards
+        due = std::max(due, next_read);
+        if (due > Clock::now()) {
+            wake_cv_.wait_until(lock, due);
+            continue;
+        }
+        
+        lock.unlock();
+        MemoryFootprint footprint;
+        const bool valid = LinuxMonitor::readSmapsRollup(pid, footprint);
+        const Clock::time_point now = Clock::now();
+        lock.lock();
+        
+        reads_.fetch_add(1, std::memory_order_relaxed);
+        next_read = now + read_gap_;
+        Entry& entry = cache_[pid];
+        entry.start_time = start_time;
+        entry.footprint = footprint;
+        entry.sampled_at = now;
+        entry.valid = valid;
+    }
+}
@@ -1,14 +1,84 @@
 #include "system_monitor.hpp"
+#include "proc_connector.hpp"
+#include "process_table.hpp"
+#include "history.hpp"
+#include "process_tree.hpp"
+#include "snapshot.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <mutex>
+#include <thread>
 
 #ifdef __APPLE__
 #include "macos_monitor.hpp"
 #else
 #include "linux_monitor.hpp"
+#include "smaps_sampler.hpp"
 #endif
 
-SystemMonitor::SystemMonitor() {
+namespace {
+
+// How many recent short-lived processes to remember
+constexpr size_t kShortLivedHistory = 64;
+
+// PSI averages are already smoothed over 10 s, so per-cgroup files are
+// re-read every few ticks rather than every tick
+constexpr uint64_t kCgroupPressureInterval = 4;
+
+// Samples without any CPU time before a process drops to the cold tier
+constexpr unsigned kDemoteAfter = 3;
+
+// A visible process's smaps_rollup is re-read at most this often
+constexpr std::chrono::seconds kFootprintRefresh(5);
+
+// Released snapshots kept for reuse; one is normally enough, since the
+// renderer drops the previous frame's snapshot before taking the next
+constexpr size_t kSpareSnapshots = 2;
+
+// Busiest processes whose CPU and memory are kept in the history
+constexpr size_t kHistoryProcesses = 16;
+
+// Below this many interned names the pool is never compacted
+constexpr size_t kMinCompactStrings = 4096;
+
+} // namespace
+
+// Buffers handed back by the last reader of a published snapshot. The
+// monitor and every outstanding snapshot share ownership, so a snapshot
+// may outlive the monitor.
+struct SystemMonitor::SnapshotPool {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Snapshot>> spare;
+    
+    SnapshotPool() { spare.reserve(kSpareSnapshots); }
+};
+
+SystemMonitor::SystemMonitor(const MonitorOptions& options)
+    : options_(options), live_pids_valid_(false), exits_from_events_(false), readdir_passes_(0), readdir_passes_avoided_(0),
+      short_lived_count_(0), pressure_ticks_(0), cgroup_view_enabled_(false), cgroup_lookups_(0),
+      tree_view_enabled_(false), strings_(std::make_unique<StringPool>()),
+      process_table_(std::make_unique<ProcessTable>()), previous_table_(std::make_unique<ProcessTable>()),
+      process_delta_(std::make_unique<ProcessDelta>()), live_strings_(0), history_(std::make_unique<History>(kHistoryProcesses)),
+      snapshot_pool_(std::make_shared<SnapshotPool>()),
+      snapshot_version_(0), sample_interval_(0), generation_(0) {
+    if (options_.worker_threads > 1) {
+        scan_pool_ = std::make_unique<ThreadPool>(options_.worker_threads);
+    }
+#ifndef __APPLE__
+    if (options_.use_proc_connector) {
+        // Subscribe before the first readdir so no PID falls between the two
+        proc_connector_ = std::make_unique<ProcConnector>();
+        if (!proc_connector_->open()) {
+            proc_connector_.reset();
+        }
+    }
+    if (options_.footprint_rate > 0) {
+        smaps_sampler_ = std::make_unique<SmapsSampler>(options_.footprint_rate, kFootprintRefresh);
+    }
+#endif
+    cpu_count_ = std::max(1u, std::thread::hardware_concurrency());
     last_update_ = std::chrono::steady_clock::now();
     update();
 }
@@ -16,23 +86,142 @@ SystemMonitor::SystemMonitor() {
 SystemMonitor::~SystemMonitor() = default;
 
 void SystemMonitor::update() {
+    const auto now = std::chrono::steady_clock::now();
+    sample_interval_ = std::chrono::duration<double>(now - last_update_).count();
+    last_update_ = now;
+    
     updateCPUStats();
     updateMemoryStats();
+    updateDiskStats();
+    updateNetworkStats();
+    updatePressure();
     updateProcesses();
-    last_update_ = std::chrono::steady_clock::now();
+    updateThreads();
+    updateCgroups();
+    updateTree();
+    updateHistory();
+    publishSnapshot();
+}
+
+void SystemMonitor::updateHistory() {
+    const double swap_percent = memory_stats_.swap_total > 0
+        ? 100.0 * memory_stats_.swapUsed() / memory_stats_.swap_total : 0.0;
+    history_->recordSystem(getCPUUsage(), core_usage_, memory_stats_.percent_used, swap_percent, last_update_);
+    
+    // processes_ is sorted by CPU; find the table rows of its busy head
+    const size_t top = std::min(kHistoryProcesses, processes_.size());
+    history_top_.clear();
+    for (uint32_t row = 0; row < pid_order_.size(); ++row) {
+        const uint32_t index = pid_order_[row];
+        if (index < top && processes_[index].cpu_percent > 0.0) {
+            history_top_.push_back(row);
+        }
+    }
+    history_->recordProcesses(*process_table_, history_top_, last_update_);
+}
+
+std::shared_ptr<const Snapshot> SystemMonitor::snapshot() const {
+    return std::atomic_load(&published_);
+}
+
+void SystemMonitor::publishSnapshot() {
+    std::unique_ptr<Snapshot> buffer;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_pool_->mutex);
+        if (!snapshot_pool_->spare.empty()) {
+            buffer = std::move(snapshot_pool_->spare.back());
+            snapshot_pool_->spare.pop_back();
+        }
+    }
+    if (!buffer) {
+        buffer = std::make_unique<Snapshot>();
+    }
+    
+    // Copy-assignment into a recycled buffer reuses its capacity, so once
+    // sizes settle this allocates only for new names and expanded threads
+    Snapshot& snap = *buffer;
+    snap.version = ++snapshot_version_;
+    snap.taken_at = last_update_;
+    snap.cpu_usage = getCPUUsage();
+    snap.cpu_delta = getCPUDelta();
+    snap.core_usage = core_usage_;
+    snap.memory = memory_stats_;
+    snap.disks = disk_stats_;
+    snap.interfaces.clear();
+    for (const auto& iface : net_table_.slots) {
+        if (iface.active) {
+            snap.interfaces.push_back(iface);
+        }
+    }
+    snap.pressure = pressure_;
+    snap.cgroup_pressure = cgroup_pressure_;
+    snap.cgroups = cgroup_stats_;
+    snap.process_count = processes_.size();
+    snap.event_driven = isEventDriven();
+    snap.short_lived_count = short_lived_count_;
+    snap.sampling = sampling_stats_;
+    snap.processes = *process_table_;
+    snap.delta = *process_delta_;
+    snap.strings.syncFrom(*strings_);
+    snap.threads = threads_;
+    snap.tree_rows = tree_rows_;
+    snap.history = *history_;
+    
+    // The deleter runs on whichever thread drops the last reference; the
+    // pool mutex orders that thread's reads before the next refill here
+    std::shared_ptr<SnapshotPool> pool = snapshot_pool_;
+    std::shared_ptr<const Snapshot> published(buffer.release(), [pool](const Snapshot* released) {
+        std::unique_ptr<Snapshot> owned(const_cast<Snapshot*>(released));
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        if (pool->spare.size() < kSpareSnapshots) {
+            pool->spare.push_back(std::move(owned));
+        }
+    });
+    std::atomic_store(&published_, std::move(published));
+}
+
+void SystemMonitor::setCollapsedPids(const std::vector<int>& pids) {
+    collapsed_pids_.clear();
+    collapsed_pids_.insert(pids.begin(), pids.end());
+}
+
+void SystemMonitor::updateTree() {
+    if (!tree_view_enabled_) {
+        // Dropped rather than kept stale; re-enabling rebuilds it once
+        process_tree_.reset();
+        tree_rows_.clear();
+        return;
+    }
+    if (!process_tree_) {
+        process_tree_ = std::make_unique<ProcessTree>();
+    }
+    process_tree_->update(processes_);
+    process_tree_->flatten(collapsed_pids_, tree_rows_);
 }
 
 void SystemMonitor::updateCPUStats() {
     prev_cpu_stats_ = cpu_stats_;
-    
+
 #ifdef __APPLE__
     cpu_stats_ = MacOSMonitor::parseCPUStats();
 #else
-    std::string stat_line = LinuxMonitor::readFile("/proc/stat");
-    if (!stat_line.empty()) {
-        cpu_stats_ = LinuxMonitor::parseCPUStats(stat_line);
+    // Swap rather than copy so both per-core arrays keep their capacity
+    prev_core_stats_.swap(core_stats_);
+    size_t online = 0;
+    // Process CPU% is scaled by the CPUs that accrued time, not the highest
+    // CPU number, which overcounts with nosmt or unplugged CPUs
+    if (LinuxMonitor::readCPUStats(cpu_stats_, core_stats_, online) && online > 0) {
+        cpu_count_ = static_cast<unsigned>(online);
     }
 #endif
+    
+    core_usage_.resize(core_stats_.size());
+    for (size_t i = 0; i < core_stats_.size(); ++i) {
+        // A zeroed slot is an offline CPU, or one just back with no baseline
+        core_usage_[i] = i < prev_core_stats_.size() && prev_core_stats_[i].total > 0.0
+            ? calculateCPUPercent(core_stats_[i], prev_core_stats_[i])
+            : 0.0;
+    }
 }
 
 void SystemMonitor::updateMemoryStats() {
@@ -43,13 +232,116 @@ void SystemMonitor::updateMemoryStats() {
 #endif
 }
 
+void SystemMonitor::updateDiskStats() {
+#ifndef __APPLE__
+    // Swap so both arrays keep their slots and name buffers across ticks
+    prev_disk_stats_.swap(disk_stats_);
+    LinuxMonitor::DiskFilter filter;
+    filter.partitions = options_.show_partitions;
+    filter.virtual_devices = options_.show_virtual_disks;
+    LinuxMonitor::readDiskStats(disk_stats_, filter);
+#endif
+    
+    if (sample_interval_ <= 0.0) {
+        return;
+    }
+    for (size_t i = 0; i < disk_stats_.size(); ++i) {
+        DiskStats& disk = disk_stats_[i];
+        // Devices keep their position unless one was added or removed
+        const DiskStats* prev = nullptr;
+        if (i < prev_disk_stats_.size() && prev_disk_stats_[i].name == disk.name) {
+            prev = &prev_disk_stats_[i];
+        } else {
+            for (const auto& candidate : prev_disk_stats_) {
+                if (candidate.name == disk.name) {
+                    prev = &candidate;
+                    break;
+                }
+            }
+        }
+        if (!prev || disk.reads < prev->reads || disk.writes < prev->writes) {
+            // New device, or counters reset by a re-attach
+            disk.read_iops = disk.write_iops = 0.0;
+            disk.read_bytes_per_sec = disk.write_bytes_per_sec = 0.0;
+            disk.utilization = disk.avg_latency_ms = 0.0;
+            continue;
+        }
+        
+        const uint64_t reads = disk.reads - prev->reads;
+        const uint64_t writes = disk.writes - prev->writes;
+        disk.read_iops = reads / sample_interval_;
+        disk.write_iops = writes / sample_interval_;
+        disk.read_bytes_per_sec = (disk.sectors_read - prev->sectors_read) * 512.0 / sample_interval_;
+        disk.write_bytes_per_sec = (disk.sectors_written - prev->sectors_written) * 512.0 / sample_interval_;
+        disk.utilization = std::min(100.0, (disk.io_time_ms - prev->io_time_ms) / (sample_interval_ * 10.0));
+        const uint64_t wait_ms = (disk.read_time_ms - prev->read_time_ms) + (disk.write_time_ms - prev->write_time_ms);
+        disk.avg_latency_ms = reads + writes > 0 ? static_cast<double>(wait_ms) / (reads + writes) : 0.0;
+    }
+}
+
+void SystemMonitor::updateNetworkStats() {
+#ifndef __APPLE__
+    LinuxMonitor::readNetDevStats(net_table_);
+#endif
+    
+    prev_net_counters_.resize(net_table_.slots.size());
+    for (size_t i = 0; i < net_table_.slots.size(); ++i) {
+        NetStats& iface = net_table_.slots[i];
+        if (!iface.active) {
+            continue;
+        }
+        const NetCounters& now = iface.counters;
+        const NetCounters& before = prev_net_counters_[i];
+        // A slot taken this tick has no baseline; counters only go
+        // backwards when a driver resets them
+        const bool has_baseline = iface.first_seen < net_table_.tick && sample_interval_ > 0.0 &&
+                                  now.rx_bytes >= before.rx_bytes && now.tx_bytes >= before.tx_bytes;
+        if (has_baseline) {
+            auto delta = [](uint64_t current, uint64_t previous) {
+                return current > previous ? current - previous : 0;
+            };
+            iface.rx_bytes_per_sec = delta(now.rx_bytes, before.rx_bytes) / sample_interval_;
+            iface.tx_bytes_per_sec = delta(now.tx_bytes, before.tx_bytes) / sample_interval_;
+            iface.rx_packets_per_sec = delta(now.rx_packets, before.rx_packets) / sample_interval_;
+            iface.tx_packets_per_sec = delta(now.tx_packets, before.tx_packets) / sample_interval_;
+            iface.drops = delta(now.rx_dropped, before.rx_dropped) + delta(now.tx_dropped, before.tx_dropped);
+            iface.errors = delta(now.rx_errors, before.rx_errors) + delta(now.tx_errors, before.tx_errors);
+        } else {
+            iface.rx_bytes_per_sec = iface.tx_bytes_per_sec = 0.0;
+            iface.rx_packets_per_sec = iface.tx_packets_per_sec = 0.0;
+            iface.drops = iface.errors = 0;
+        }
+        prev_net_counters_[i] = now;
+    }
+}
+
+void SystemMonitor::updatePressure() {
+#ifndef __APPLE__
+    LinuxMonitor::readSystemPressure(pressure_);
+    if (pressure_ticks_++ % kCgroupPressureInterval == 0) {
+        LinuxMonitor::readCgroupPressure(cgroup_pressure_);
+    }
+#endif
+}
+
 void SystemMonitor::updateProcesses() {
 #ifdef __APPLE__
     processes_ = MacOSMonitor::parseProcesses();
+    const size_t sampled = processes_.size();
 #else
-    processes_ = LinuxMonitor::parseProcesses();
+    const size_t sampled = scanTiered(refreshLivePids());
 #endif
     
+    updateProcessCPU(sampled);
+    updateFootprints();
+    pruneLivePids();
+    
+    if (memory_stats_.total > 0) {
+        for (auto& proc : processes_) {
+            proc.memory_percent = (static_cast<double>(proc.memory_bytes) / memory_stats_.total) * 100.0;
+        }
+    }
+    
     std::sort(processes_.begin(), processes_.end(),
               [](const ProcessInfo& a, const ProcessInfo& b) {
                   if (std::abs(a.cpu_percent - b.cpu_percent) > 0.01) {
@@ -57,12 +349,527 @@ void SystemMonitor::updateProcesses() {
                   }
                   return a.memory_percent > b.memory_percent;
               });
+    
+    // The table goes in PID order so consecutive tables diff in one pass;
+    // last tick's table is kept for that and refilled the tick after
+    pid_order_.resize(processes_.size());
+    for (size_t i = 0; i < processes_.size(); ++i) {
+        pid_order_[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(pid_order_.begin(), pid_order_.end(),
+              [this](uint32_t a, uint32_t b) { return processes_[a].pid < processes_[b].pid; });
+    std::swap(*process_table_, *previous_table_);
+    process_table_->clear();
+    for (uint32_t index : pid_order_) {
+        process_table_->append(processes_[index], *strings_);
+    }
+    process_delta_->compute(*previous_table_, *process_table_);
+    compactStrings();
+}
+
+// Names of exited processes stay interned, so a host with steady churn
+// would grow the pool, every snapshot replica and the per-ID search and
+// capture caches without bound. Once dead strings outnumber live ones the
+// pool is rebuilt from what the current table uses. Runs after the diff,
+// so only the current table is renumbered: the previous one is refilled
+// before anything reads it again. The new pool generation makes snapshot
+// replicas resync in full and the capture writer start a keyframe.
+void SystemMonitor::compactStrings() {
+    const size_t pooled = strings_->size();
+    if (pooled < kMinCompactStrings || pooled <= 2 * live_strings_) {
+        return;
+    }
+    live_flags_.assign(pooled, 0);
+    live_flags_[0] = 1;
+    for (size_t row = 0; row < process_table_->size(); ++row) {
+        live_flags_[process_table_->name[row]] = 1;
+        live_flags_[process_table_->user[row]] = 1;
+    }
+    live_strings_ = static_cast<size_t>(std::count(live_flags_.begin(), live_flags_.end(), 1));
+    if (pooled - live_strings_ <= live_strings_) {
+        return;
+    }
+    strings_->compact(live_flags_, string_remap_);
+    process_table_->remapStrings(string_remap_);
+}
+
+const ProcessTable& SystemMonitor::getProcessTable() const {
+    return *process_table_;
+}
+
+const ProcessDelta& SystemMonitor::getProcessDelta() const {
+    return *process_delta_;
+}
+
+const History& SystemMonitor::getHistory() const {
+    return *history_;
+}
+
+const StringPool& SystemMonitor::getStrings() const {
+    return *strings_;
+}
+
+#ifndef __APPLE__
+// Hot processes (new, busy, on screen, or among the busiest) are parsed in
+// full every tick. Cold ones get a stat-only check every cold_interval
+// ticks, staggered by PID, and are carried forward untouched in between.
+// A check that finds new CPU time promotes the process and re-reads it in
+// full. Leaves processes_ as [sampled this tick..., carried forward...] and
+// returns the size of the first part.
+size_t SystemMonitor::scanTiered(const std::vector<int>& pids) {
+    using LinuxMonitor::ScanDepth;
+    const unsigned interval = std::max(1u, options_.cold_interval);
+    sampling_stats_ = SamplingStats();
+    LinuxMonitor::beginScanTick();
+    
+    if (interval == 1) {
+        processes_ = LinuxMonitor::scanProcesses(pids, scan_pool_.get(), ScanDepth::Full);
+        LinuxMonitor::endScanTick(0);
+        sampling_stats_.hot = processes_.size();
+        return processes_.size();
+    }
+    
+    // processes_ still holds last tick's list, sorted by CPU
+    std::unordered_set<int> pinned(hot_pids_.begin(), hot_pids_.end());
+    pinned.insert(expanded_pids_.begin(), expanded_pids_.end());
+    for (size_t i = 0; i < processes_.size() && i < options_.hot_top_n; ++i) {
+        pinned.insert(processes_[i].pid);
+    }
+    std::unordered_map<int, size_t> previous;
+    previous.reserve(processes_.size());
+    for (size_t i = 0; i < processes_.size(); ++i) {
+        previous.emplace(processes_[i].pid, i);
+    }
+    
+    // generation_ advances in updateProcessCPU, after this scan
+    const uint64_t tick = generation_ + 1;
+    std::vector<int> full_pids;
+    std::vector<int> check_pids;
+    std::vector<size_t> carried;
+    for (int pid : pids) {
+        auto state = process_state_.find(pid);
+        auto prev = previous.find(pid);
+        if (state == process_state_.end() || !state->second.cold || prev == previous.end() || pinned.count(pid)) {
+            full_pids.push_back(pid);
+        } else if ((tick + static_cast<unsigned>(pid)) % interval == 0) {
+            check_pids.push_back(pid);
+        } else {
+            carried.push_back(prev->second);
+        }
+    }
+    
+    std::vector<ProcessInfo> sampled = LinuxMonitor::scanProcesses(full_pids, scan_pool_.get(), ScanDepth::Full);
+    sampling_stats_.hot = sampled.size();
+    std::vector<ProcessInfo> checked = LinuxMonitor::scanProcesses(check_pids, scan_pool_.get(), ScanDepth::StatOnly);
+    sampling_stats_.cold_checked = checked.size();
+    
+    std::vector<int> promoted;
+    for (auto& proc : checked) {
+        const ProcessSample& state = process_state_.at(proc.pid);
+        if (proc.utime + proc.stime != state.cpu_time || proc.start_time != state.start_time) {
+            promoted.push_back(proc.pid);
+            continue;
+        }
+        // Still idle: refresh what stat gave us and keep memory and I/O
+        ProcessInfo& prev = processes_[previous.at(proc.pid)];
+        prev.state = proc.state;
+        prev.ppid = proc.ppid;
+        prev.num_threads = proc.num_threads;
+        prev.virtual_memory = proc.virtual_memory;
+        prev.resident_memory = proc.resident_memory;
+        ++prev.sample_age;
+        sampled.push_back(std::move(prev));
+    }
+    if (!promoted.empty()) {
+        std::vector<ProcessInfo> fresh = LinuxMonitor::scanProcesses(promoted, scan_pool_.get(), ScanDepth::Full);
+        sampling_stats_.promoted = fresh.size();
+        std::move(fresh.begin(), fresh.end(), std::back_inserter(sampled));
+    }
+    
+    const size_t sampled_count = sampled.size();
+    sampled.reserve(sampled_count + carried.size());
+    for (size_t index : carried) {
+        ProcessInfo& prev = processes_[index];
+        ++prev.sample_age;
+        sampled.push_back(std::move(prev));
+    }
+    sampling_stats_.cold_skipped = carried.size();
+    
+    // Keep cached fds of cold processes open between their checks
+    LinuxMonitor::endScanTick(interval);
+    processes_ = std::move(sampled);
+    return sampled_count;
+}
+#endif
+
+// Hands this tick's hot PIDs to the background sampler and attaches
+// whatever it has cached for them; other rows carry no footprint
+void SystemMonitor::updateFootprints() {
+#ifndef __APPLE__
+    if (!smaps_sampler_) {
+        return;
+    }
+    constexpr size_t kNoRow = static_cast<size_t>(-1);
+    std::unordered_map<int, size_t> rows;
+    rows.reserve(hot_pids_.size());
+    for (int pid : hot_pids_) {
+        rows.emplace(pid, kNoRow);
+    }
+    for (size_t i = 0; i < processes_.size(); ++i) {
+        processes_[i].footprint_available = false;
+        auto row = rows.find(processes_[i].pid);
+        if (row != rows.end()) {
+            row->second = i;
+        }
+    }
+    
+    std::vector<std::pair<int, uint64_t>> wanted;
+    wanted.reserve(hot_pids_.size());
+    for (int pid : hot_pids_) {
+        const size_t row = rows[pid];
+        if (row != kNoRow) {
+            wanted.emplace_back(pid, processes_[row].start_time);
+        }
+    }
+    smaps_sampler_->request(wanted);
+    
+    std::vector<SmapsSampler::Result> results;
+    smaps_sampler_->collect(results);
+    const auto now = SmapsSampler::Clock::now();
+    for (const auto& result : results) {
+        ProcessInfo& proc = processes_[rows[result.pid]];
+        proc.footprint = result.footprint;
+        proc.footprint_available = true;
+        proc.footprint_age = std::chrono::duration<double>(now - result.sampled_at).count();
+    }
+#endif
+}
+
+void SystemMonitor::updateProcessCPU(size_t sampled) {
+    ++generation_;
+    size_t touched = 0;
+    
+    for (size_t i = 0; i < sampled; ++i) {
+        ProcessInfo& proc = processes_[i];
+        auto [it, inserted] = process_state_.try_emplace(proc.pid);
+        ProcessSample& state = it->second;
+        const bool has_baseline = !inserted && state.generation != generation_ &&
+                                  state.start_time == proc.start_time;
+        if (state.generation != generation_) {
+            ++touched;
+            if (has_baseline) {
+                updateProcessIO(proc, state, sample_interval_);
+            }
+        }
+        state.io_read_bytes = proc.io_read_bytes;
+        state.io_write_bytes = proc.io_write_bytes;
+        state.io_syscr = proc.io_syscr;
+        state.io_syscw = proc.io_syscw;
+        state.io_available = proc.io_available;
+        
+        const uint64_t cpu_time = proc.utime + proc.stime;
+        const bool idle = has_baseline && cpu_time == state.cpu_time;
+        proc.cpu_percent = sampleTaskCPU(state, inserted, cpu_time, proc.start_time);
+        if (idle) {
+            state.cold = ++state.idle_samples >= kDemoteAfter;
+        } else {
+            state.idle_samples = 0;
+            state.cold = false;
+        }
+    }
+    
+    // Carried-forward processes keep their baseline until their next check
+    for (size_t i = sampled; i < processes_.size(); ++i) {
+        auto it = process_state_.find(processes_[i].pid);
+        if (it != process_state_.end() && it->second.generation != generation_) {
+            it->second.generation = generation_;
+            ++touched;
+        }
+    }
+    
+    // Exit events already evicted what left since the last tick; after a
+    // readdir pass every surviving entry was touched above, so the sweep
+    // only runs when something exited
+    if (!exits_from_events_ && touched != process_state_.size()) {
+        for (auto it = process_state_.begin(); it != process_state_.end();) {
+            if (it->second.generation != generation_) {
+                it = process_state_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// Counters can only go backwards if the PID was reused between ticks,
+// which the start time check above already rules out; clamp anyway
+void SystemMonitor::updateProcessIO(ProcessInfo& proc, const ProcessSample& previous, double elapsed) const {
+    if (!proc.io_available || !previous.io_available || elapsed <= 0.0) {
+        return;
+    }
+    auto rate = [elapsed](uint64_t current, uint64_t before) {
+        return current > before ? static_cast<double>(current - before) / elapsed : 0.0;
+    };
+    proc.io_read_rate = rate(proc.io_read_bytes, previous.io_read_bytes);
+    proc.io_write_rate = rate(proc.io_write_bytes, previous.io_write_bytes);
+    proc.io_syscr_rate = rate(proc.io_syscr, previous.io_syscr);
+    proc.io_syscw_rate = rate(proc.io_syscw, previous.io_syscw);
+}
+
+void SystemMonitor::updateThreads() {
+    threads_.clear();
+
+#ifndef __APPLE__
+    // processes_ is sorted by CPU, so its head is the top-N
+    std::vector<int> targets(expanded_pids_);
+    const size_t top_n = std::min(options_.thread_top_n, processes_.size());
+    for (size_t i = 0; i < top_n; ++i) {
+        targets.push_back(processes_[i].pid);
+    }
+    
+    size_t touched = 0;
+    for (int pid : targets) {
+        if (threads_.count(pid)) {
+            continue;
+        }
+        auto& threads = threads_[pid] = LinuxMonitor::parseThreads(pid);
+        for (auto& thread : threads) {
+            auto [it, inserted] = thread_state_.try_emplace(thread.tid);
+            ProcessSample& state = it->second;
+            if (state.generation != generation_) {
+                ++touched;
+            }
+            thread.cpu_percent = sampleTaskCPU(state, inserted, thread.utime + thread.stime, thread.start_time);
+        }
+        std::sort(threads.begin(), threads.end(),
+                  [](const ThreadInfo& a, const ThreadInfo& b) {
+                      return a.cpu_percent > b.cpu_percent;
+                  });
+    }
+#endif
+    
+    // Collapsed processes and exited threads lose their baseline
+    if (touched != thread_state_.size()) {
+        for (auto it = thread_state_.begin(); it != thread_state_.end();) {
+            if (it->second.generation != generation_) {
+                it = thread_state_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void SystemMonitor::updateCgroups() {
+    if (!cgroup_view_enabled_) {
+        // Drop the caches so a later toggle starts from a clean baseline
+        pid_cgroups_.clear();
+        cgroup_usage_.clear();
+        cgroup_stats_.clear();
+        exec_pids_.clear();
+        return;
+    }
+
+#ifndef __APPLE__
+    std::unordered_map<std::string, size_t> members;
+    for (const auto& proc : processes_) {
+        auto [it, inserted] = pid_cgroups_.try_emplace(proc.pid);
+        ProcessCgroup& entry = it->second;
+        // Without the proc connector exec goes unseen, but new PIDs and
+        // reused ones (different start time) are still caught here
+        if (inserted || entry.start_time != proc.start_time || exec_pids_.count(proc.pid)) {
+            entry.path = LinuxMonitor::readProcessCgroup(proc.pid);
+            entry.start_time = proc.start_time;
+            ++cgroup_lookups_;
+        }
+        entry.generation = generation_;
+        if (!entry.path.empty()) {
+            ++members[entry.path];
+        }
+    }
+    exec_pids_.clear();
+    
+    for (auto it = pid_cgroups_.begin(); it != pid_cgroups_.end();) {
+        if (it->second.generation != generation_) {
+            it = pid_cgroups_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    cgroup_stats_.clear();
+    cgroup_stats_.reserve(members.size());
+    for (const auto& [path, count] : members) {
+        CgroupStats group;
+        group.path = path;
+        group.process_count = count;
+        if (!LinuxMonitor::readCgroupStats(group)) {
+            continue;
+        }
+        
+        auto [usage, inserted] = cgroup_usage_.try_emplace(path);
+        if (!inserted && sample_interval_ > 0.0 && group.usage_usec >= usage->second.usage_usec) {
+            group.cpu_percent = (group.usage_usec - usage->second.usage_usec) / (sample_interval_ * 1e4);
+        }
+        usage->second.usage_usec = group.usage_usec;
+        usage->second.generation = generation_;
+        cgroup_stats_.push_back(std::move(group));
+    }
+    
+    for (auto it = cgroup_usage_.begin(); it != cgroup_usage_.end();) {
+        if (it->second.generation != generation_) {
+            it = cgroup_usage_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    std::sort(cgroup_stats_.begin(), cgroup_stats_.end(),
+              [](const CgroupStats& a, const CgroupStats& b) {
+                  if (std::abs(a.cpu_percent - b.cpu_percent) > 0.01) {
+                      return a.cpu_percent > b.cpu_percent;
+                  }
+                  return a.memory_current > b.memory_current;
+              });
+#endif
+}
+
+const std::vector<ThreadInfo>* SystemMonitor::getThreads(int pid) const {
+    auto it = threads_.find(pid);
+    return it != threads_.end() ? &it->second : nullptr;
+}
+
+const std::vector<int>& SystemMonitor::refreshLivePids() {
+#ifndef __APPLE__
+    exits_from_events_ = false;
+    if (proc_connector_ && live_pids_valid_) {
+        std::vector<ProcEvent> events;
+        if (proc_connector_->drain(events)) {
+            applyProcEvents(events);
+            scan_pids_.assign(live_pids_.begin(), live_pids_.end());
+            exits_from_events_ = true;
+            ++readdir_passes_avoided_;
+            return scan_pids_;
+        }
+        // The kernel dropped events; fall through to a full rescan
+    } else if (proc_connector_) {
+        std::vector<ProcEvent> discarded;
+        proc_connector_->drain(discarded);
+    }
+    
+    scan_pids_ = LinuxMonitor::listPids();
+    ++readdir_passes_;
+    if (proc_connector_) {
+        live_pids_.clear();
+        live_pids_.insert(scan_pids_.begin(), scan_pids_.end());
+        live_pids_valid_ = true;
+    }
+#endif
+    return scan_pids_;
+}
+
+#ifndef __APPLE__
+void SystemMonitor::applyProcEvents(const std::vector<ProcEvent>& events) {
+    std::unordered_map<int, const char*> exec_names;
+    
+    for (const auto& event : events) {
+        switch (event.type) {
+            case ProcEvent::Fork:
+                live_pids_.insert(event.pid);
+                break;
+            case ProcEvent::Exec:
+                live_pids_.insert(event.pid);
+                exec_names[event.pid] = event.comm;
+                exec_pids_.insert(event.pid);
+                break;
+            case ProcEvent::Exit: {
+                live_pids_.erase(event.pid);
+                // Evicted here so the next tick needs no sweep for exits
+                auto state = process_state_.find(event.pid);
+                if (state != process_state_.end()) {
+                    process_state_.erase(state);
+                    break;
+                }
+                // Never sampled by a scan: it lived and died between two ticks
+                ShortLivedProcess proc;
+                proc.pid = event.pid;
+                auto name = exec_names.find(event.pid);
+                if (name != exec_names.end()) {
+                    proc.name = name->second;
+                }
+                short_lived_.push_back(std::move(proc));
+                if (short_lived_.size() > kShortLivedHistory) {
+                    short_lived_.pop_front();
+                }
+                ++short_lived_count_;
+                break;
+            }
+        }
+    }
+}
+#endif
+
+void SystemMonitor::pruneLivePids() {
+    // Drop PIDs whose /proc entry could not be read, e.g. an exit event
+    // that arrived before the matching fork was applied. Their state goes
+    // too, since no sweep follows a tick driven by events.
+    if (!proc_connector_ || processes_.size() == live_pids_.size()) {
+        return;
+    }
+    for (auto it = live_pids_.begin(); it != live_pids_.end();) {
+        auto state = process_state_.find(*it);
+        if (state == process_state_.end() || state->second.generation != generation_) {
+            if (state != process_state_.end()) {
+                process_state_.erase(state);
+            }
+            it = live_pids_.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 double SystemMonitor::getCPUUsage() const {
     return calculateCPUPercent(cpu_stats_, prev_cpu_stats_);
 }
 
+CPUStats SystemMonitor::getCPUDelta() const {
+    CPUStats delta;
+    delta.user = cpu_stats_.user - prev_cpu_stats_.user;
+    delta.nice = cpu_stats_.nice - prev_cpu_stats_.nice;
+    delta.system = cpu_stats_.system - prev_cpu_stats_.system;
+    delta.idle = cpu_stats_.idle - prev_cpu_stats_.idle;
+    delta.iowait = cpu_stats_.iowait - prev_cpu_stats_.iowait;
+    delta.irq = cpu_stats_.irq - prev_cpu_stats_.irq;
+    delta.softirq = cpu_stats_.softirq - prev_cpu_stats_.softirq;
+    delta.steal = cpu_stats_.steal - prev_cpu_stats_.steal;
+    delta.guest = cpu_stats_.guest - prev_cpu_stats_.guest;
+    delta.guest_nice = cpu_stats_.guest_nice - prev_cpu_stats_.guest_nice;
+    delta.total = cpu_stats_.total - prev_cpu_stats_.total;
+    return delta;
+}
+
+// Advances one task's CPU baseline and returns its usage since the last
+// sample, or 0 on the first sample and after the ID was reused
+double SystemMonitor::sampleTaskCPU(ProcessSample& state, bool inserted,
+                                    uint64_t cpu_time, uint64_t start_time) const {
+    double cpu_percent = 0.0;
+    if (!inserted && state.generation != generation_ && state.start_time == start_time) {
+        const double total_diff = cpu_stats_.total - state.sample_total;
+        if (total_diff > 0.0 && cpu_time >= state.cpu_time) {
+            // Scale to a single core so that one busy thread reads as 100%
+            cpu_percent = 100.0 * cpu_count_ * (cpu_time - state.cpu_time) / total_diff;
+            cpu_percent = std::min(cpu_percent, 100.0 * cpu_count_);
+        }
+    }
+    
+    state.cpu_time = cpu_time;
+    state.start_time = start_time;
+    state.sample_total = cpu_stats_.total;
+    state.generation = generation_;
+    return cpu_percent;
+}
+
 double SystemMonitor::calculateCPUPercent(const CPUStats& current, const CPUStats& previous) const {
     double total_diff = current.total - previous.total;
     double idle_diff = current.idle - previous.idle;
@@ -0,0 +1,84 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : job_(nullptr), job_count_(0), job_chunk_(1), next_index_(0),
+      active_workers_(0), epoch_(0), stopping_(false) {
+    const size_t extra = thread_count > 1 ? thread_count - 1 : 0;
+    workers_.reserve(extra);
+    for (size_t i = 0; i < extra; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t chunk_size, const ChunkFn& fn) {
+    if (count == 0) {
+        return;
+    }
+    chunk_size = std::max<size_t>(1, chunk_size);
+    
+    if (workers_.empty() || count <= chunk_size) {
+        fn(0, 0, count);
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        job_count_ = count;
+        job_chunk_ = chunk_size;
+        next_index_.store(0, std::memory_order_relaxed);
+        active_workers_ = workers_.size();
+        ++epoch_;
+    }
+    start_cv_.notify_all();
+    
+    runChunks(0);
+    
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    uint64_t seen_epoch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stopping_ || epoch_ != seen_epoch; });
+            if (stopping_) {
+                return;
+            }
+            seen_epoch = epoch_;
+        }
+        
+        runChunks(worker);
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_workers_;
+        }
+        done_cv_.notify_one();
+    }
+}
+
+void ThreadPool::runChunks(size_t worker) {
+    while (true) {
+        size_t begin = next_index_.fetch_add(job_chunk_, std::memory_order_relaxed);
+        if (begin >= job_count_) {
+            return;
+        }
+        (*job_)(worker, begin, std::min(begin + job_chunk_, job_count_));
+    }
+}
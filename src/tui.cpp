@@ -1,4 +1,7 @@
 #include "tui.hpp"
+#include "capture.hpp"
+#include "replay.hpp"
+#include "snapshot.hpp"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/event.hpp>
 #include <ftxui/dom/elements.hpp>
@@ -8,21 +11,61 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <algorithm>
+#include <ctime>
 
 using namespace ftxui;
 
-TUI::TUI() 
-    : monitor_(std::make_unique<SystemMonitor>()),
+namespace {
+
+// PSI "some" avg10 thresholds, in percent of wall time stalled
+constexpr double kPressureWarn = 10.0;
+constexpr double kPressureCritical = 40.0;
+// Cgroups below this are not worth a place in the header
+constexpr double kCgroupPressureShown = 1.0;
+
+double worstPressure(const CgroupPressure& group) {
+    return std::max(group.cpu.some.avg10, group.memory.some.avg10);
+}
+
+int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string formatWallTime(int64_t wall_ns) {
+    const std::time_t seconds = static_cast<std::time_t>(wall_ns / 1000000000);
+    std::tm local{};
+    localtime_r(&seconds, &local);
+    std::ostringstream oss;
+    oss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
+    return oss.str();
+}
+
+} // namespace
+
+TUI::TUI(const MonitorOptions& options, std::unique_ptr<CaptureWriter> recorder, std::unique_ptr<Replay> replay)
+    : monitor_(replay ? nullptr : std::make_unique<SystemMonitor>(options)),
+      recorder_(std::move(recorder)),
+      replay_(std::move(replay)),
+      recorded_ticks_(0),
+      recording_(recorder_ != nullptr),
       process_manager_(std::make_unique<ProcessManager>()),
       screen_(ScreenInteractive::Fullscreen()),
       running_(true),
+      sort_by_(ProcessManager::SortBy::CPU),
       selected_process_index_(0),
-      show_help_(false) {
+      show_help_(false),
+      show_cgroups_(false),
+      show_tree_(false),
+      history_tier_(HistoryTier::Raw) {
     
     search_input_ = Input(&search_query_, "Search processes...");
     update_thread_ = std::thread(&TUI::updateLoop, this);
     
     auto main_renderer = Renderer([this] {
+        // One snapshot per frame, so every panel shows the same tick
+        frame_ = replay_ ? replay_->snapshot() : monitor_->snapshot();
         if (show_help_) {
             return renderHelp();
         }
@@ -33,12 +76,17 @@ TUI::TUI()
             hbox({
                 renderCPUStats() | flex,
                 separator(),
-                renderMemoryStats() | flex
+                renderMemoryStats() | flex,
+                separator(),
+                vbox({
+                    renderDiskStats(),
+                    renderNetworkStats()
+                }) | flex
             }),
             separator(),
             hbox({ text("Search: "), search_input_->Render() }),
             separator(),
-            renderProcessList(),
+            show_cgroups_ ? renderCgroupList() : renderProcessList(),
             separator(),
             renderFooter()
         });
@@ -68,54 +116,128 @@ void TUI::run() {
 }
 
 void TUI::updateLoop() {
+    if (replay_) {
+        replayLoop();
+        return;
+    }
     while (running_) {
+        {
+            std::lock_guard<std::mutex> lock(settings_mutex_);
+            monitor_->setExpandedPids(std::vector<int>(expanded_pids_.begin(), expanded_pids_.end()));
+            monitor_->setHotPids(visible_pids_);
+            monitor_->setCgroupViewEnabled(show_cgroups_);
+            monitor_->setTreeViewEnabled(show_tree_);
+            monitor_->setCollapsedPids(std::vector<int>(collapsed_pids_.begin(), collapsed_pids_.end()));
+        }
+        // Publishes a new snapshot; the renderer picks it up on the next frame
         monitor_->update();
-        
-        auto processes = monitor_->getProcesses();
-        auto memory_stats = monitor_->getMemoryStats();
-        
-        if (memory_stats.total > 0) {
-            for (auto& proc : processes) {
-                proc.memory_percent = (static_cast<double>(proc.memory_bytes) / memory_stats.total) * 100.0;
+        if (recording_) {
+            if (recorder_->append(*monitor_->snapshot(), wallClockNs())) {
+                ++recorded_ticks_;
+            } else {
+                recording_ = false;
             }
         }
-        
-        {
-            std::lock_guard<std::mutex> lock(data_mutex_);
-            process_manager_->setProcesses(processes);
-        }
-        
         screen_.PostEvent(Event::Custom);
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
     }
 }
 
-Element TUI::renderHeader() const {
-    double cpu_usage;
-    size_t process_count;
-    {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        cpu_usage = monitor_->getCPUUsage();
-        process_count = monitor_->getProcessCount();
+// Plays the capture in small steps so speed changes take effect at once
+void TUI::replayLoop() {
+    auto last = std::chrono::steady_clock::now();
+    while (running_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const auto now = std::chrono::steady_clock::now();
+        if (replay_->advance(now - last)) {
+            screen_.PostEvent(Event::Custom);
+        }
+        last = now;
     }
+}
+
+Element TUI::renderHeader() const {
+    const Snapshot& snap = *frame_;
+    const SystemPressure& pressure = snap.pressure;
+    std::vector<CgroupPressure> cgroups = snap.cgroup_pressure;
     
-    return hbox({
+    Elements items = {
         text("TBM - Terminal-Based Monitor") | bold,
         filler(),
-        text("CPU: " + formatPercent(cpu_usage)) | color(Color::Green),
+        text("CPU: " + formatPercent(snap.cpu_usage)) | color(Color::Green),
         text(" | "),
-        text("Processes: " + std::to_string(process_count)) | color(Color::Cyan)
+        text("Processes: " + std::to_string(snap.process_count)) | color(Color::Cyan)
+    };
+    if (replay_) {
+        const Replay::Status status = replay_->status();
+        std::ostringstream speed;
+        speed << "x" << status.speed;
+        items.push_back(text(" | "));
+        items.push_back(text("REPLAY " + formatWallTime(status.wall_ns) + " " + std::to_string(status.tick + 1) +
+                             "/" + std::to_string(status.tick_count) + " " +
+                             (status.paused ? std::string("paused") : speed.str())) | color(Color::Magenta));
+    } else if (recorder_) {
+        items.push_back(text(" | "));
+        items.push_back(recording_ ? text("REC " + std::to_string(recorded_ticks_.load())) | color(Color::Red)
+                                   : text("REC failed") | color(Color::Red) | bold);
+    }
+    if (snap.event_driven) {
+        items.push_back(text(" | "));
+        items.push_back(text("Short-lived: " + std::to_string(snap.short_lived_count)) | dim);
+    }
+    if (pressure.cpu.available || pressure.memory.available || pressure.io.available) {
+        items.push_back(text(" | PSI"));
+        items.push_back(renderPressure("cpu", pressure.cpu));
+        items.push_back(renderPressure("mem", pressure.memory));
+        items.push_back(renderPressure("io", pressure.io));
+    }
+    
+    // Name the cgroups that are stalling so the culprit is one glance away
+    cgroups.erase(std::remove_if(cgroups.begin(), cgroups.end(),
+                                 [](const CgroupPressure& group) {
+                                     return worstPressure(group) < kCgroupPressureShown;
+                                 }),
+                  cgroups.end());
+    if (cgroups.empty()) {
+        return hbox(std::move(items)) | border;
+    }
+    std::sort(cgroups.begin(), cgroups.end(),
+              [](const CgroupPressure& a, const CgroupPressure& b) {
+                  return worstPressure(a) > worstPressure(b);
+              });
+    
+    Elements stalled = {text("Stalling: ") | dim};
+    for (size_t i = 0; i < cgroups.size() && i < 3; ++i) {
+        const CgroupPressure& group = cgroups[i];
+        const double worst = worstPressure(group);
+        Color stall_color = worst >= kPressureCritical ? Color::Red :
+                            worst >= kPressureWarn ? Color::Yellow : Color::Default;
+        std::string path = group.path.size() > 40 ? "..." + group.path.substr(group.path.size() - 37) : group.path;
+        stalled.push_back(text(path + " cpu " + formatPercent(group.cpu.some.avg10) +
+                               " mem " + formatPercent(group.memory.some.avg10) + "  ") | color(stall_color));
+    }
+    
+    return vbox({
+        hbox(std::move(items)),
+        hbox(std::move(stalled))
     }) | border;
 }
 
-Element TUI::renderCPUStats() const {
-    CPUStats cpu_stats;
-    double cpu_usage;
-    {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        cpu_stats = monitor_->getCPUStats();
-        cpu_usage = monitor_->getCPUUsage();
+// Shows "some" avg10, the share of the last 10 s in which a task waited
+Element TUI::renderPressure(const char* label, const PressureStats& stats) const {
+    if (!stats.available) {
+        return text(std::string(" ") + label + " -") | dim;
     }
+    const double stall = stats.some.avg10;
+    Color stall_color = stall >= kPressureCritical ? Color::Red :
+                        stall >= kPressureWarn ? Color::Yellow : Color::Green;
+    return text(std::string(" ") + label + " " + formatPercent(stall)) | color(stall_color);
+}
+
+Element TUI::renderCPUStats() const {
+    const CPUStats& cpu_delta = frame_->cpu_delta;
+    const double cpu_usage = frame_->cpu_usage;
+    const std::vector<double>& core_usage = frame_->core_usage;
     
     const int bar_width = 30;
     const int filled = static_cast<int>((cpu_usage / 100.0) * bar_width);
@@ -125,27 +247,62 @@ Element TUI::renderCPUStats() const {
     
     double user_percent = 0.0;
     double system_percent = 0.0;
-    if (cpu_stats.total > 0.0) {
-        user_percent = (cpu_stats.user / cpu_stats.total) * 100.0;
-        system_percent = (cpu_stats.system / cpu_stats.total) * 100.0;
+    double iowait_percent = 0.0;
+    double steal_percent = 0.0;
+    if (cpu_delta.total > 0.0) {
+        user_percent = ((cpu_delta.user + cpu_delta.nice) / cpu_delta.total) * 100.0;
+        system_percent = ((cpu_delta.system + cpu_delta.irq + cpu_delta.softirq) / cpu_delta.total) * 100.0;
+        iowait_percent = (cpu_delta.iowait / cpu_delta.total) * 100.0;
+        steal_percent = (cpu_delta.steal / cpu_delta.total) * 100.0;
     }
     
-    return vbox({
+    Elements rows = {
         text("CPU Usage") | bold | center,
         text(formatPercent(cpu_usage)) | center | color(Color::Green),
         text(bar) | center,
-        text("User: " + formatPercent(user_percent)) | dim,
-        text("System: " + formatPercent(system_percent)) | dim
-    }) | border;
+        text("User: " + formatPercent(user_percent) + "  System: " + formatPercent(system_percent)) | dim,
+        text("IOWait: " + formatPercent(iowait_percent) + "  Steal: " + formatPercent(steal_percent))
+            | (steal_percent >= 5.0 ? color(Color::Red) : dim)
+    };
+    rows.push_back(renderSparkline("CPU", frame_->history.cpu()));
+    if (!core_usage.empty()) {
+        rows.push_back(renderCoreHeatmap(core_usage));
+    }
+    
+    return vbox(std::move(rows)) | border;
 }
 
-Element TUI::renderMemoryStats() const {
-    MemoryStats mem_stats;
-    {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        mem_stats = monitor_->getMemoryStats();
+// One shaded cell per logical CPU, wrapped so 256 cores fit in 8 rows
+Element TUI::renderCoreHeatmap(const std::vector<double>& core_usage) const {
+    static const char* const shades[] = {" ", "\u2591", "\u2592", "\u2593", "\u2588"};
+    constexpr size_t cells_per_row = 32;
+    
+    Elements lines;
+    for (size_t row_start = 0; row_start < core_usage.size(); row_start += cells_per_row) {
+        const size_t row_end = std::min(core_usage.size(), row_start + cells_per_row);
+        
+        std::ostringstream label;
+        label << std::setw(3) << row_start << " ";
+        Elements cells = {text(label.str()) | dim};
+        for (size_t i = row_start; i < row_end; ++i) {
+            const double usage = core_usage[i];
+            const int shade = std::min(4, static_cast<int>(usage / 20.0 + 0.5));
+            Color cell_color = usage > 80 ? Color::Red :
+                               usage > 50 ? Color::Yellow : Color::Green;
+            cells.push_back(text(shades[shade]) | color(cell_color));
+        }
+        lines.push_back(hbox(std::move(cells)));
     }
     
+    return vbox({
+        text("Cores (" + std::to_string(core_usage.size()) + ")") | dim,
+        vbox(std::move(lines))
+    });
+}
+
+Element TUI::renderMemoryStats() const {
+    const MemoryStats& mem_stats = frame_->memory;
+    
     const int bar_width = 30;
     const int filled = static_cast<int>((mem_stats.percent_used / 100.0) * bar_width);
     const std::string filled_str(filled, '=');
@@ -155,55 +312,289 @@ Element TUI::renderMemoryStats() const {
     Color bar_color = mem_stats.percent_used > 80 ? Color::Red : 
                       mem_stats.percent_used > 60 ? Color::Yellow : Color::Green;
     
-    return vbox({
+    Elements rows = {
         text("Memory") | bold | center,
         text(formatPercent(mem_stats.percent_used)) | center | color(bar_color),
         text(bar) | center | color(bar_color),
-        text("Used: " + formatBytes(mem_stats.used)) | dim,
-        text("Free: " + formatBytes(mem_stats.free)) | dim,
-        text("Total: " + formatBytes(mem_stats.total)) | dim
-    }) | border;
+        text("Used: " + formatBytes(mem_stats.used) + " / " + formatBytes(mem_stats.total)) | dim,
+        text("Available: " + formatBytes(mem_stats.available) + "  Free: " + formatBytes(mem_stats.free)) | dim,
+        text("Cached: " + formatBytes(mem_stats.cached) + "  Buffers: " + formatBytes(mem_stats.buffers)) | dim,
+        text("Slab: " + formatBytes(mem_stats.slab) + " (" + formatBytes(mem_stats.slab_reclaimable) + " reclaimable)") | dim,
+        text("Shmem: " + formatBytes(mem_stats.shmem)) | dim,
+        text("Dirty: " + formatBytes(mem_stats.dirty) + "  Writeback: " + formatBytes(mem_stats.writeback)) | dim,
+        renderSparkline("Mem", frame_->history.memory())
+    };
+    
+    if (mem_stats.swap_total > 0) {
+        const double swap_percent = (static_cast<double>(mem_stats.swapUsed()) / mem_stats.swap_total) * 100.0;
+        rows.push_back(text("Swap: " + formatBytes(mem_stats.swapUsed()) + " / " + formatBytes(mem_stats.swap_total) +
+                            " (" + formatPercent(swap_percent) + ")")
+                       | color(swap_percent > 50 ? Color::Yellow : Color::Default));
+        rows.push_back(renderSparkline("Swap", frame_->history.swap()));
+    } else {
+        rows.push_back(text("Swap: none") | dim);
+    }
+    
+    if (mem_stats.hugepages_total > 0) {
+        const uint64_t huge_used = mem_stats.hugepages_total - mem_stats.hugepages_free;
+        rows.push_back(text("HugePages: " + std::to_string(huge_used) + " / " +
+                            std::to_string(mem_stats.hugepages_total) + " x " +
+                            formatBytes(mem_stats.hugepage_size)) | dim);
+    }
+    
+    return vbox(std::move(rows)) | border;
 }
 
-Element TUI::renderProcessList() const {
-    std::vector<ProcessInfo> processes;
-    {
-        std::lock_guard<std::mutex> lock(data_mutex_);
-        processes = process_manager_->getProcesses();
+// The most recent points of the selected tier, one cell each, scaled to
+// 0-100%; downsampled tiers draw the bucket average and report the peak
+Element TUI::renderSparkline(const char* label, const MetricHistory& metric) const {
+    static const char* const levels[] = {" ", "\u2581", "\u2582", "\u2583", "\u2584",
+                                         "\u2585", "\u2586", "\u2587", "\u2588"};
+    static const char* const tier_names[] = {"raw", "10s", "1m"};
+    constexpr size_t width = 30;
+    
+    const HistoryRing& ring = metric.tier(history_tier_);
+    const size_t shown = std::min(width, ring.size());
+    std::string line(width - shown, ' ');
+    float peak = 0;
+    for (size_t i = ring.size() - shown; i < ring.size(); ++i) {
+        const HistoryPoint& point = ring.at(i);
+        peak = std::max(peak, point.max);
+        const int level = std::clamp(static_cast<int>(point.avg / 100.0f * 8.0f + 0.5f), 0, 8);
+        line += levels[level];
     }
     
-    if (!search_query_.empty()) {
-        processes = process_manager_->filterProcesses(processes, search_query_);
+    Color line_color = peak > 80 ? Color::Red : peak > 60 ? Color::Yellow : Color::Green;
+    return hbox({
+        text(std::string(label) + " " + tier_names[static_cast<size_t>(history_tier_)] + " ") | dim,
+        text(line) | color(line_color),
+        text(" peak " + formatPercent(peak)) | dim
+    });
+}
+
+Element TUI::renderDiskStats() const {
+    // Copied because the panel re-sorts; only a handful of devices
+    std::vector<DiskStats> disks = frame_->disks;
+    
+    Elements rows = {text("Disks") | bold | center};
+    if (disks.empty()) {
+        rows.push_back(text("No block devices") | dim | center);
+        return vbox(std::move(rows)) | border;
     }
     
-    constexpr size_t max_processes = 20;
-    if (processes.size() > max_processes) {
-        processes.resize(max_processes);
+    // Busiest first so a saturated device is never cut off
+    std::stable_sort(disks.begin(), disks.end(),
+                     [](const DiskStats& a, const DiskStats& b) {
+                         return a.utilization > b.utilization;
+                     });
+    constexpr size_t max_disks = 8;
+    
+    std::ostringstream header;
+    header << std::left << std::setw(10) << "Device" << std::right
+           << std::setw(7) << "r/s" << std::setw(7) << "w/s"
+           << std::setw(11) << "Read" << std::setw(11) << "Write"
+           << std::setw(7) << "Util" << std::setw(8) << "Await";
+    rows.push_back(text(header.str()) | dim);
+    
+    for (size_t i = 0; i < disks.size() && i < max_disks; ++i) {
+        const DiskStats& disk = disks[i];
+        std::ostringstream line;
+        line << std::left << std::setw(10) << disk.name.substr(0, 9) << std::right << std::fixed
+             << std::setprecision(0) << std::setw(7) << disk.read_iops << std::setw(7) << disk.write_iops
+             << std::setw(11) << formatBytes(static_cast<uint64_t>(disk.read_bytes_per_sec))
+             << std::setw(11) << formatBytes(static_cast<uint64_t>(disk.write_bytes_per_sec))
+             << std::setw(7) << formatPercent(disk.utilization)
+             << std::setw(6) << std::setprecision(1) << disk.avg_latency_ms << "ms";
+        
+        Color util_color = disk.utilization > 80 ? Color::Red :
+                           disk.utilization > 50 ? Color::Yellow : Color::Default;
+        rows.push_back(text(line.str()) | color(util_color));
+    }
+    if (disks.size() > max_disks) {
+        rows.push_back(text("+" + std::to_string(disks.size() - max_disks) + " more") | dim);
     }
     
+    return vbox(std::move(rows)) | border;
+}
+
+Element TUI::renderNetworkStats() const {
+    std::vector<NetStats> interfaces = frame_->interfaces;
+    
+    Elements rows = {text("Network") | bold | center};
+    if (interfaces.empty()) {
+        rows.push_back(text("No interfaces") | dim | center);
+        return vbox(std::move(rows)) | border;
+    }
+    
+    std::stable_sort(interfaces.begin(), interfaces.end(),
+                     [](const NetStats& a, const NetStats& b) {
+                         return a.rx_bytes_per_sec + a.tx_bytes_per_sec > b.rx_bytes_per_sec + b.tx_bytes_per_sec;
+                     });
+    constexpr size_t max_interfaces = 6;
+    
+    std::ostringstream header;
+    header << std::left << std::setw(12) << "Interface" << std::right
+           << std::setw(11) << "RX" << std::setw(11) << "TX"
+           << std::setw(9) << "Pkts/s" << std::setw(7) << "Drop" << std::setw(6) << "Err";
+    rows.push_back(text(header.str()) | dim);
+    
+    for (size_t i = 0; i < interfaces.size() && i < max_interfaces; ++i) {
+        const NetStats& iface = interfaces[i];
+        std::ostringstream line;
+        line << std::left << std::setw(12) << iface.name.substr(0, 11) << std::right << std::fixed
+             << std::setw(11) << formatBytes(static_cast<uint64_t>(iface.rx_bytes_per_sec))
+             << std::setw(11) << formatBytes(static_cast<uint64_t>(iface.tx_bytes_per_sec))
+             << std::setprecision(0) << std::setw(9) << iface.rx_packets_per_sec + iface.tx_packets_per_sec
+             << std::setw(7) << iface.drops << std::setw(6) << iface.errors;
+        rows.push_back(text(line.str()) | color(iface.drops + iface.errors > 0 ? Color::Red : Color::Default));
+    }
+    if (interfaces.size() > max_interfaces) {
+        rows.push_back(text("+" + std::to_string(interfaces.size() - max_interfaces) + " more") | dim);
+    }
+    
+    return vbox(std::move(rows)) | border;
+}
+
+Element TUI::renderProcessList() const {
+    constexpr size_t max_processes = 20;
+    constexpr size_t max_threads_per_process = 16;
+    
     std::vector<std::vector<std::string>> table_data;
-    table_data.push_back({"PID", "Name", "CPU%", "Memory%", "Memory", "User", "State"});
+    table_data.push_back({"PID", "Name", "Thr", "CPU%", "Memory%", "Memory", "PSS", "USS", "Swap", "Age",
+                          "Read/s", "Write/s", "Rd calls/s", "Wr calls/s", "User", "State"});
+    std::vector<int> thread_rows;
+    std::vector<int> stale_rows;
+    int selected_row = -1;
+    
+    // Sorting and filtering permute row indices of the frame's table
+    // instead of copying it
+    const ProcessTable& processes = frame_->processes;
+    const StringPool& strings = frame_->strings;
+    const std::vector<ProcessTreeRow>& tree_rows = frame_->tree_rows;
+    std::vector<uint32_t>& order = row_order_;
+    std::vector<const ProcessTreeRow*> tree_info;
+    
+    const bool tree_mode = show_tree_ && search_query_.empty() && !tree_rows.empty();
+    if (!search_query_.empty()) {
+        process_manager_->filterRows(processes, strings, search_query_, order);
+    } else if (tree_mode) {
+        // The monitor hands rows over in tree order; map them onto the table
+        row_by_pid_.clear();
+        for (uint32_t row = 0; row < processes.size(); ++row) {
+            row_by_pid_.emplace(processes.pid[row], row);
+        }
+        order.clear();
+        for (const auto& tree_row : tree_rows) {
+            auto it = row_by_pid_.find(tree_row.pid);
+            if (it != row_by_pid_.end()) {
+                order.push_back(it->second);
+                tree_info.push_back(&tree_row);
+            }
+            if (order.size() == max_processes) {
+                break;
+            }
+        }
+    } else {
+        // Names and PIDs read naturally in ascending order, rates descending
+        const bool descending = sort_by_ != ProcessManager::SortBy::PID &&
+                                sort_by_ != ProcessManager::SortBy::NAME;
+        process_manager_->sortRows(processes, strings, sort_by_, descending, order);
+    }
+    if (order.size() > max_processes) {
+        order.resize(max_processes);
+    }
     
-    for (const auto& proc : processes) {
-        std::string name = proc.name;
-        if (name.length() > 30) {
-            name = name.substr(0, 27) + "...";
+    const int selected = std::min(selected_process_index_, static_cast<int>(order.size()) - 1);
+    {
+        // The update thread samples these rows every tick
+        std::lock_guard<std::mutex> lock(settings_mutex_);
+        visible_pids_.clear();
+        for (uint32_t row : order) {
+            visible_pids_.push_back(processes.pid[row]);
+        }
+    }
+    
+    for (size_t index = 0; index < order.size(); ++index) {
+        const uint32_t row = order[index];
+        const int pid = processes.pid[row];
+        if (static_cast<int>(index) == selected) {
+            selected_row = static_cast<int>(table_data.size());
+        }
+        if (processes.sample_age[row] > 0) {
+            stale_rows.push_back(static_cast<int>(table_data.size()));
+        }
+        const bool expanded = expanded_pids_.count(pid) > 0;
+        std::string name = strings.get(processes.name[row]);
+        if (name.length() > 28) {
+            name = name.substr(0, 25) + "...";
+        }
+        double cpu_percent = processes.cpu_percent[row];
+        double memory_percent = processes.memory_percent[row];
+        uint64_t memory_bytes = processes.memory_bytes[row];
+        if (tree_mode) {
+            // A folded row stands for its whole subtree
+            const ProcessTreeRow& tree_row = *tree_info[index];
+            name = std::string(2 * tree_row.depth, ' ') +
+                   (tree_row.collapsed ? "+ " : tree_row.has_children ? "- " : "  ") + name;
+            if (tree_row.collapsed) {
+                name += " (" + std::to_string(tree_row.subtree_count) + ")";
+                cpu_percent = tree_row.subtree_cpu;
+                memory_bytes = tree_row.subtree_memory;
+                memory_percent = frame_->memory.total > 0 ? 100.0 * memory_bytes / frame_->memory.total : 0;
+            }
+        } else {
+            name = (expanded ? "- " : processes.num_threads[row] > 1 ? "+ " : "  ") + name;
         }
         
-        std::string user = proc.user;
+        std::string user = strings.get(processes.user[row]);
         if (user.length() > 10) {
             user = user.substr(0, 7) + "...";
         }
         
+        const bool has_footprint = processes.footprint_age[row] >= 0;
+        const MemoryFootprint& footprint = processes.footprint[row];
+        const bool has_io = processes.io_available[row] != 0;
         table_data.push_back({
-            std::to_string(proc.pid),
+            std::to_string(pid),
             name,
-            formatPercent(proc.cpu_percent),
-            formatPercent(proc.memory_percent),
-            formatBytes(proc.memory_bytes),
+            processes.num_threads[row] > 0 ? std::to_string(processes.num_threads[row]) : "",
+            formatPercent(cpu_percent),
+            formatPercent(memory_percent),
+            formatBytes(memory_bytes),
+            has_footprint ? formatBytes(footprint.pss) : "-",
+            has_footprint ? formatBytes(footprint.uss) : "-",
+            has_footprint ? formatBytes(footprint.swap) : "-",
+            has_footprint ? std::to_string(static_cast<int>(processes.footprint_age[row])) + "s" : "",
+            has_io ? formatBytes(static_cast<uint64_t>(processes.io_read_rate[row])) : "-",
+            has_io ? formatBytes(static_cast<uint64_t>(processes.io_write_rate[row])) : "-",
+            has_io ? std::to_string(static_cast<uint64_t>(processes.io_syscr_rate[row])) : "-",
+            has_io ? std::to_string(static_cast<uint64_t>(processes.io_syscw_rate[row])) : "-",
             user,
-            proc.state
+            std::string(1, processes.state[row])
         });
+        
+        auto task_list = frame_->threads.find(pid);
+        if (!expanded || task_list == frame_->threads.end()) {
+            continue;
+        }
+        const size_t shown = std::min(task_list->second.size(), max_threads_per_process);
+        for (size_t i = 0; i < shown; ++i) {
+            const ThreadInfo& thread = task_list->second[i];
+            thread_rows.push_back(static_cast<int>(table_data.size()));
+            table_data.push_back({
+                std::to_string(thread.tid),
+                "    " + thread.name,
+                "",
+                formatPercent(thread.cpu_percent),
+                "", "", "", "", "", "", "", "", "", "", "",
+                std::string(1, thread.state)
+            });
+        }
+        if (task_list->second.size() > shown) {
+            thread_rows.push_back(static_cast<int>(table_data.size()));
+            table_data.push_back({"", "    ... " + std::to_string(task_list->second.size() - shown) + " more",
+                                  "", "", "", "", "", "", "", "", "", "", "", "", "", ""});
+        }
     }
     
     auto table = Table(table_data);
@@ -213,17 +604,86 @@ Element TUI::renderProcessList() const {
     table.SelectColumn(2).Decorate(center);
     table.SelectColumn(3).Decorate(center);
     table.SelectColumn(4).Decorate(center);
+    table.SelectColumn(5).Decorate(center);
     table.SelectColumn(6).Decorate(center);
+    table.SelectColumn(7).Decorate(center);
+    table.SelectColumn(8).Decorate(center);
+    table.SelectColumn(9).Decorate(center);
+    table.SelectColumn(10).Decorate(center);
+    table.SelectColumn(11).Decorate(center);
+    table.SelectColumn(12).Decorate(center);
+    table.SelectColumn(13).Decorate(center);
+    table.SelectColumn(15).Decorate(center);
+    for (int row : thread_rows) {
+        table.SelectRow(row).Decorate(dim);
+    }
+    // Idle rows carried forward by the tiered sampler
+    for (int row : stale_rows) {
+        table.SelectRow(row).Decorate(dim);
+    }
+    if (selected_row > 0) {
+        table.SelectRow(selected_row).Decorate(inverted);
+    }
     
     return vbox({
-        text("Processes" + (search_query_.empty() ? "" : " (filtered: " + search_query_ + ")")) | bold,
+        text("Processes" + (!search_query_.empty() ? " (filtered: " + search_query_ + ")" :
+                            tree_mode ? std::string(" (tree)") :
+                            " (sort: " + std::string(ProcessManager::sortName(sort_by_)) + ")")) | bold,
         table.Render()
     }) | border | flex;
 }
 
+Element TUI::renderCgroupList() const {
+    const std::vector<CgroupStats>& groups = frame_->cgroups;
+    
+    constexpr size_t max_groups = 20;
+    std::vector<std::vector<std::string>> table_data;
+    table_data.push_back({"Cgroup", "Procs", "CPU%", "Memory", "Limit", "Mem/Limit"});
+    
+    for (size_t i = 0; i < groups.size() && i < max_groups; ++i) {
+        const CgroupStats& group = groups[i];
+        std::string path = group.path;
+        if (path.length() > 50) {
+            path = "..." + path.substr(path.length() - 47);
+        }
+        
+        std::string limit = "-";
+        std::string limit_percent = "-";
+        if (group.memory_max > 0) {
+            limit = formatBytes(group.memory_max);
+            limit_percent = formatPercent(100.0 * group.memory_current / group.memory_max);
+        }
+        
+        table_data.push_back({
+            path,
+            std::to_string(group.process_count),
+            formatPercent(group.cpu_percent),
+            formatBytes(group.memory_current),
+            limit,
+            limit_percent
+        });
+    }
+    
+    auto table = Table(table_data);
+    table.SelectAll().Border(LIGHT);
+    table.SelectRow(0).Decorate(bold);
+    for (int column = 1; column <= 5; ++column) {
+        table.SelectColumn(column).Decorate(center);
+    }
+    
+    Element body = groups.empty()
+        ? text("No cgroup v2 hierarchy, or nothing collected yet") | dim | center
+        : table.Render();
+    return vbox({
+        text("Cgroups (" + std::to_string(groups.size()) + ")") | bold,
+        body
+    }) | border | flex;
+}
+
 Element TUI::renderFooter() const {
     return hbox({
-        text("F1: Help | /: Search | q: Quit") | dim | center
+        text(replay_ ? "F1: Help | Space: Pause | \u2190/\u2192: Seek 10s | [/]: Speed | F2: Sort | /: Search | q: Quit"
+                     : "F1: Help | F2: Sort | F3: Threads | F6: Cgroups | F7: History | /: Search | q: Quit") | dim | center
     }) | border;
 }
 
@@ -236,11 +696,27 @@ Element TUI::renderHelp() const {
         text("  q          - Quit application"),
         text("  F1         - Toggle this help"),
         text("  ↑/↓        - Navigate process list"),
+        text("  F2         - Cycle sort: CPU, memory, I/O, read, write, PID, name"),
+        text("  F3         - Expand/collapse threads of the selected process"),
+        text("  F4         - Fold/unfold the subtree of the selected process (tree mode)"),
+        text("  F5         - Toggle the process tree"),
+        text("  F6         - Toggle the per-cgroup view"),
+        text("  F7         - Cycle sparkline resolution: raw, 10 s, 1 min"),
+        text("  Space      - Pause/resume (replay)"),
+        text("  ←/→        - Seek 10 seconds back/forward (replay)"),
+        text("  [ / ]      - Halve/double playback speed (replay)"),
         text(""),
         text("Features:"),
         text("  • Real-time CPU and memory monitoring"),
         text("  • Process list with CPU and memory usage"),
+        text("  • Per-thread CPU for expanded processes"),
+        text("  • Per-process disk read/write rates"),
+        text("  • Block device IOPS, throughput, utilization and latency"),
+        text("  • Network interface throughput, drops and errors"),
+        text("  • Pressure stall information, system-wide and per cgroup"),
+        text("  • cgroup v2 view with per-container CPU and memory"),
         text("  • Fuzzy search for process filtering"),
+        text("  • CPU, memory and swap history at three resolutions"),
         text("  • Automatic updates every 500ms"),
         text(""),
         text("Press F1 to close help") | dim | center
@@ -253,6 +729,53 @@ bool TUI::onEvent(Event event) {
         return true;
     }
     
+    if (replay_ && onReplayEvent(event)) {
+        return true;
+    }
+    
+    if (event == Event::ArrowUp) {
+        selected_process_index_ = std::max(0, selected_process_index_ - 1);
+        return true;
+    }
+    
+    if (event == Event::ArrowDown) {
+        const int last = static_cast<int>(visible_pids_.size()) - 1;
+        selected_process_index_ = std::max(0, std::min(selected_process_index_ + 1, last));
+        return true;
+    }
+    
+    if (event == Event::F2) {
+        cycleSortMode();
+        return true;
+    }
+    
+    if (event == Event::F7) {
+        cycleHistoryTier();
+        return true;
+    }
+    
+    if (event == Event::F6) {
+        std::lock_guard<std::mutex> lock(settings_mutex_);
+        show_cgroups_ = !show_cgroups_;
+        return true;
+    }
+    
+    if (event == Event::F3) {
+        toggleExpanded();
+        return true;
+    }
+    
+    if (event == Event::F4) {
+        toggleCollapsed();
+        return true;
+    }
+    
+    if (event == Event::F5) {
+        std::lock_guard<std::mutex> lock(settings_mutex_);
+        show_tree_ = !show_tree_;
+        return true;
+    }
+    
     if (event == Event::Character('q') || event == Event::Escape) {
         running_ = false;
         screen_.Exit();
@@ -262,6 +785,68 @@ bool TUI::onEvent(Event event) {
     return false;
 }
 
+bool TUI::onReplayEvent(const Event& event) {
+    constexpr double seek_seconds = 10.0;
+    if (event == Event::Character(' ')) {
+        replay_->togglePause();
+    } else if (event == Event::ArrowLeft) {
+        replay_->seek(-seek_seconds);
+    } else if (event == Event::ArrowRight) {
+        replay_->seek(seek_seconds);
+    } else if (event == Event::Character('[')) {
+        replay_->slower();
+    } else if (event == Event::Character(']')) {
+        replay_->faster();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void TUI::toggleExpanded() {
+    if (selected_process_index_ < 0 || selected_process_index_ >= static_cast<int>(visible_pids_.size())) {
+        return;
+    }
+    const int pid = visible_pids_[selected_process_index_];
+    
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    if (!expanded_pids_.erase(pid)) {
+        expanded_pids_.insert(pid);
+    }
+}
+
+void TUI::toggleCollapsed() {
+    if (!show_tree_ || selected_process_index_ < 0 ||
+        selected_process_index_ >= static_cast<int>(visible_pids_.size())) {
+        return;
+    }
+    const int pid = visible_pids_[selected_process_index_];
+    
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    if (!collapsed_pids_.erase(pid)) {
+        collapsed_pids_.insert(pid);
+    }
+}
+
+void TUI::cycleSortMode() {
+    using SortBy = ProcessManager::SortBy;
+    static const SortBy order[] = {
+        SortBy::CPU, SortBy::MEMORY, SortBy::IO_TOTAL, SortBy::IO_READ,
+        SortBy::IO_WRITE, SortBy::IO_SYSCR, SortBy::IO_SYSCW, SortBy::PID, SortBy::NAME
+    };
+    constexpr size_t count = sizeof(order) / sizeof(order[0]);
+    
+    size_t current = 0;
+    while (current < count && order[current] != sort_by_) {
+        ++current;
+    }
+    sort_by_ = order[(current + 1) % count];
+}
+
+void TUI::cycleHistoryTier() {
+    history_tier_ = static_cast<HistoryTier>((static_cast<size_t>(history_tier_) + 1) % kHistoryTiers);
+}
+
 std::string TUI::formatBytes(uint64_t bytes) const {
     const char* units[] = {"B", "KB", "MB", "GB", "TB"};
     int unit_index = 0;
@@ -294,4 +879,3 @@ std::string TUI::formatTime(uint64_t seconds) const {
         << std::setfill('0') << std::setw(2) << secs;
     return oss.str();
 }
-
@@ -0,0 +1,121 @@
+#include "user_cache.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// How often the resolver checks /etc/passwd for edits when idle
+constexpr auto kPasswdPollInterval = std::chrono::seconds(2);
+
+} // namespace
+
+UserCache& UserCache::instance() {
+    // Never destroyed: the resolver may be stuck in getpwuid_r on a dead
+    // LDAP/SSSD server, and joining it at exit would hang quitting. It is
+    // left running and goes away with the process.
+    static UserCache* cache = new UserCache();
+    return *cache;
+}
+
+UserCache::UserCache() : passwd_mtime_{} {
+    passwdChanged(); // record the initial mtime
+    std::thread(&UserCache::resolverLoop, this).detach();
+}
+
+const std::string& UserCache::lookup(unsigned uid) {
+    {
+        std::shared_lock<std::shared_mutex> lock(names_mutex_);
+        auto it = names_.find(uid);
+        if (it != names_.end()) {
+            return *it->second;
+        }
+    }
+    
+    const std::string* placeholder;
+    {
+        std::unique_lock<std::shared_mutex> lock(names_mutex_);
+        auto [it, inserted] = names_.try_emplace(uid, nullptr);
+        if (!inserted) {
+            return *it->second;
+        }
+        placeholder = intern(std::to_string(uid));
+        it->second = placeholder;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        pending_.push_back(uid);
+    }
+    queue_cv_.notify_one();
+    return *placeholder;
+}
+
+const std::string* UserCache::intern(const std::string& name) {
+    return &*pool_.insert(name).first;
+}
+
+void UserCache::resolverLoop() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    for (;;) {
+        if (pending_.empty()) {
+            queue_cv_.wait_for(lock, kPasswdPollInterval);
+            if (pending_.empty()) {
+                lock.unlock();
+                if (passwdChanged()) {
+                    // Re-resolve everything we know; old names stay visible meanwhile
+                    std::shared_lock<std::shared_mutex> names_lock(names_mutex_);
+                    std::vector<unsigned> known;
+                    known.reserve(names_.size());
+                    for (const auto& [uid, name] : names_) {
+                        known.push_back(uid);
+                    }
+                    names_lock.unlock();
+                    lock.lock();
+                    pending_.insert(pending_.end(), known.begin(), known.end());
+                } else {
+                    lock.lock();
+                }
+            }
+            continue;
+        }
+        
+        unsigned uid = pending_.front();
+        pending_.pop_front();
+        lock.unlock();
+        resolve(uid);
+        lock.lock();
+    }
+}
+
+bool UserCache::passwdChanged() {
+    struct stat st;
+    if (stat("/etc/passwd", &st) != 0) {
+        return false;
+    }
+#ifdef __APPLE__
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    bool changed = mtime.tv_sec != passwd_mtime_.tv_sec || mtime.tv_nsec != passwd_mtime_.tv_nsec;
+    passwd_mtime_ = mtime;
+    return changed;
+}
+
+void UserCache::resolve(unsigned uid) {
+    // getpwuid_r may block on NSS; only this thread ever calls it
+    long size_hint = sysconf(_SC_GETPW_R_SIZE_MAX);
+    std::vector<char> buffer(size_hint > 0 ? static_cast<size_t>(size_hint) : 16384);
+    struct passwd pw;
+    struct passwd* result = nullptr;
+    if (getpwuid_r(static_cast<uid_t>(uid), &pw, buffer.data(), buffer.size(), &result) != 0 || !result) {
+        return; // Keep showing the numeric UID
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(names_mutex_);
+    names_[uid] = intern(result->pw_name);
+}
@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+#include "capture.hpp"
+#include "replay.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <csignal>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class CaptureTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = ::testing::TempDir() + "tbm_capture_" + std::to_string(getpid()) + "_" +
+                ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+    
+    void TearDown() override {
+        std::remove(path_.c_str());
+    }
+    
+    // A small snapshot whose contents follow from its version
+    static void fillSnapshot(Snapshot& snap, uint64_t version) {
+        snap.version = version;
+        snap.cpu_usage = static_cast<double>(version % 100);
+        snap.core_usage = {10.0, 20.0};
+        snap.memory.total = 1 << 30;
+        snap.memory.percent_used = 50.0;
+        snap.processes.clear();
+        for (int pid = 1; pid <= 3; ++pid) {
+            ProcessInfo proc;
+            proc.pid = pid;
+            proc.ppid = pid - 1;
+            proc.name = pid == 2 ? "bash" : "init";
+            proc.user = "root";
+            proc.cpu_percent = static_cast<double>(version);
+            snap.processes.append(proc, snap.strings);
+        }
+        snap.process_count = snap.processes.size();
+    }
+    
+    static constexpr int64_t kSecond = 1000000000;
+    
+    void writeTicks(size_t count, int64_t step_ns, CaptureEncoding encoding = CaptureEncoding::Compact) {
+        CaptureWriter writer;
+        ASSERT_TRUE(writer.open(path_, encoding));
+        Snapshot snap;
+        for (size_t i = 0; i < count; ++i) {
+            fillSnapshot(snap, i);
+            ASSERT_TRUE(writer.append(snap, static_cast<int64_t>(i) * step_ns));
+        }
+        EXPECT_EQ(count, writer.tickCount());
+        EXPECT_TRUE(writer.close());
+    }
+    
+    uint64_t fileSize() const {
+        struct stat info;
+        return stat(path_.c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+    }
+    
+    std::string path_;
+};
+
+TEST_F(CaptureTest, RoundTripsLiveSnapshot) {
+    SystemMonitor monitor;
+    monitor.update();
+    auto live = monitor.snapshot();
+    std::vector<uint8_t> payload;
+    encodeSnapshot(*live, payload);
+    
+    Snapshot decoded;
+    ASSERT_TRUE(decodeSnapshot(payload.data(), payload.size(), decoded));
+    EXPECT_EQ(live->version, decoded.version);
+    EXPECT_DOUBLE_EQ(live->cpu_usage, decoded.cpu_usage);
+    EXPECT_EQ(live->core_usage, decoded.core_usage);
+    EXPECT_EQ(live->memory.total, decoded.memory.total);
+    EXPECT_EQ(live->process_count, decoded.process_count);
+    ASSERT_EQ(live->disks.size(), decoded.disks.size());
+    for (size_t i = 0; i < live->disks.size(); ++i) {
+        EXPECT_EQ(live->disks[i].name, decoded.disks[i].name);
+        EXPECT_EQ(live->disks[i].sectors_read, decoded.disks[i].sectors_read);
+    }
+    ASSERT_EQ(live->interfaces.size(), decoded.interfaces.size());
+    ASSERT_EQ(live->processes.size(), decoded.processes.size());
+    for (size_t row = 0; row < live->processes.size(); ++row) {
+        EXPECT_EQ(live->processes.pid[row], decoded.processes.pid[row]);
+        EXPECT_EQ(live->processes.memory_bytes[row], decoded.processes.memory_bytes[row]);
+        EXPECT_EQ(live->strings.get(live->processes.name[row]), decoded.strings.get(decoded.processes.name[row]));
+        EXPECT_EQ(live->strings.get(live->processes.user[row]), decoded.strings.get(decoded.processes.user[row]));
+    }
+}
+
+TEST_F(CaptureTest, DecodeRejectsTruncatedPayload) {
+    Snapshot snap;
+    fillSnapshot(snap, 7);
+    std::vector<uint8_t> payload;
+    encodeSnapshot(snap, payload);
+    
+    for (size_t size = 0; size < payload.size(); size += 7) {
+        Snapshot decoded;
+        EXPECT_FALSE(decodeSnapshot(payload.data(), size, decoded)) << size;
+    }
+}
+
+TEST_F(CaptureTest, IndexSpansSeveralBlocks) {
+    const size_t count = kCaptureIndexEntries + 100;
+    writeTicks(count, kSecond / 2, CaptureEncoding::Raw);
+    
+    CaptureReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    ASSERT_EQ(count, reader.tickCount());
+    Snapshot snap;
+    ASSERT_TRUE(reader.read(count - 1, snap));
+    EXPECT_EQ(count - 1, snap.version);
+    EXPECT_EQ("bash", snap.strings.get(snap.processes.name[1]));
+    
+    EXPECT_EQ(kCaptureIndexEntries + 10, reader.findTick(static_cast<int64_t>(kCaptureIndexEntries + 10) * kSecond / 2));
+    EXPECT_EQ(20u, reader.findTick(10 * kSecond + 1));
+    EXPECT_EQ(0u, reader.findTick(-1));
+    EXPECT_FALSE(reader.read(count, snap));
+}
+
+TEST_F(CaptureTest, CompactTicksReadInAnyOrder) {
+    const size_t count = 2 * kCaptureKeyframeInterval + 10;
+    writeTicks(count, kSecond);
+    
+    CaptureReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    ASSERT_EQ(count, reader.tickCount());
+    // Forward, then jumps into the middle of keyframe intervals and back
+    for (size_t tick : {size_t(0), size_t(1), size_t(2), count - 1, size_t(kCaptureKeyframeInterval + 5),
+                        size_t(kCaptureKeyframeInterval + 5), size_t(3), size_t(kCaptureKeyframeInterval)}) {
+        Snapshot snap;
+        ASSERT_TRUE(reader.read(tick, snap)) << tick;
+        EXPECT_EQ(tick, snap.version);
+        ASSERT_EQ(3u, snap.processes.size());
+        EXPECT_DOUBLE_EQ(static_cast<double>(tick), snap.processes.cpu_percent[2]);
+        EXPECT_EQ("bash", snap.strings.get(snap.processes.name[1]));
+        EXPECT_EQ("root", snap.strings.get(snap.processes.user[0]));
+    }
+}
+
+TEST_F(CaptureTest, CompactCaptureIsSmallerThanRaw) {
+    writeTicks(100, kSecond, CaptureEncoding::Raw);
+    const uint64_t raw_bytes = fileSize();
+    writeTicks(100, kSecond);
+    EXPECT_LT(fileSize(), raw_bytes);
+}
+
+TEST_F(CaptureTest, FullDiskFailsAppendInsteadOfFaulting) {
+    // A file size limit stands in for a full disk: growing past the first
+    // megabyte fails, which must surface as append() == false
+    struct rlimit saved;
+    ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &saved));
+    struct rlimit limited = saved;
+    limited.rlim_cur = 3 << 19;
+    auto previous = std::signal(SIGXFSZ, SIG_IGN);
+    ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &limited));
+    
+    CaptureWriter writer;
+    bool opened = writer.open(path_, CaptureEncoding::Raw);
+    Snapshot snap;
+    uint64_t appended = 0;
+    bool failed = false;
+    while (opened && !failed && appended < 100000) {
+        fillSnapshot(snap, appended);
+        if (writer.append(snap, static_cast<int64_t>(appended) * kSecond)) {
+            ++appended;
+        } else {
+            failed = true;
+        }
+    }
+    const int append_errno = errno;
+    EXPECT_TRUE(writer.close());
+    setrlimit(RLIMIT_FSIZE, &saved);
+    std::signal(SIGXFSZ, previous);
+    
+    ASSERT_TRUE(opened);
+    EXPECT_TRUE(failed);
+    EXPECT_EQ(EFBIG, append_errno);
+    CaptureReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_EQ(appended, reader.tickCount());
+    ASSERT_TRUE(reader.read(appended - 1, snap));
+    EXPECT_EQ(appended - 1, snap.version);
+}
+
+TEST_F(CaptureTest, ReaderSeesTicksWhileRecording) {
+    CaptureWriter writer;
+    ASSERT_TRUE(writer.open(path_));
+    Snapshot snap;
+    for (uint64_t i = 0; i < 5; ++i) {
+        fillSnapshot(snap, i);
+        ASSERT_TRUE(writer.append(snap, static_cast<int64_t>(i) * kSecond));
+    }
+    
+    // As after a crash: the file still has its preallocated tail
+    CaptureReader reader;
+    ASSERT_TRUE(reader.open(path_));
+    EXPECT_EQ(5u, reader.tickCount());
+    Snapshot decoded;
+    ASSERT_TRUE(reader.read(4, decoded));
+    EXPECT_EQ(4u, decoded.version);
+}
+
+TEST_F(CaptureTest, ReaderRejectsOtherFiles) {
+    {
+        std::ofstream out(path_);
+        out << std::string(128, 'x');
+    }
+    CaptureReader reader;
+    errno = 0;
+    EXPECT_FALSE(reader.open(path_));
+    EXPECT_EQ(EINVAL, errno);
+    
+    CaptureReader missing;
+    EXPECT_FALSE(missing.open(path_ + ".missing"));
+}
+
+TEST_F(CaptureTest, ReplayAdvancesSeeksAndPauses) {
+    writeTicks(20, kSecond);
+    Replay replay;
+    ASSERT_TRUE(replay.open(path_));
+    EXPECT_EQ(0u, replay.snapshot()->version);
+    
+    EXPECT_TRUE(replay.advance(std::chrono::milliseconds(2500)));
+    EXPECT_EQ(2u, replay.snapshot()->version);
+    // Only ticks actually shown go into the history
+    EXPECT_EQ(2u, replay.snapshot()->history.cpu().tier(HistoryTier::Raw).size());
+    
+    replay.faster();
+    EXPECT_TRUE(replay.advance(std::chrono::seconds(1)));
+    EXPECT_EQ(4u, replay.status().tick);
+    
+    // Seeking past the start pauses there and restarts the history
+    replay.seek(-10);
+    Replay::Status status = replay.status();
+    EXPECT_EQ(0u, status.tick);
+    EXPECT_TRUE(status.paused);
+    EXPECT_EQ(1u, replay.snapshot()->history.cpu().tier(HistoryTier::Raw).size());
+    EXPECT_FALSE(replay.advance(std::chrono::seconds(5)));
+    
+    replay.togglePause();
+    replay.seek(100);
+    status = replay.status();
+    EXPECT_EQ(19u, status.tick);
+    EXPECT_EQ(20u, status.tick_count);
+    EXPECT_TRUE(status.paused);
+    EXPECT_EQ(19 * kSecond, status.wall_ns);
+}
+
+TEST_F(CaptureTest, ReplayRefusesUnreadableFirstTick) {
+    writeTicks(3, kSecond, CaptureEncoding::Raw);
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path_, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    CaptureHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    CaptureIndexEntry first;
+    std::memcpy(&first, bytes.data() + header.first_index + sizeof(CaptureIndexBlock), sizeof(first));
+    std::fill(bytes.begin() + static_cast<long>(first.offset),
+              bytes.begin() + static_cast<long>(first.offset + first.length), '\xff');
+    {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    
+    Replay replay;
+    errno = 0;
+    EXPECT_FALSE(replay.open(path_));
+    EXPECT_EQ(EINVAL, errno);
+    EXPECT_EQ(nullptr, replay.snapshot());
+}
+
+TEST_F(CaptureTest, ReplayRefusesEmptyCapture) {
+    writeTicks(0, kSecond);
+    Replay replay;
+    EXPECT_FALSE(replay.open(path_));
+}
@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include "capture_codec.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+class CaptureCodecTest : public ::testing::Test {
+protected:
+    static ProcessInfo makeProcess(int pid, uint64_t start_time, const std::string& name) {
+        ProcessInfo proc;
+        proc.pid = pid;
+        proc.ppid = pid > 1 ? 1 : 0;
+        proc.start_time = start_time;
+        proc.name = name;
+        proc.user = pid % 3 == 0 ? "postgres" : "root";
+        proc.state = 'S';
+        proc.num_threads = 1 + pid % 4;
+        proc.cpu_percent = 0.0;
+        proc.memory_percent = 0.25 * pid;
+        proc.memory_bytes = 4096ull * (1000 + pid);
+        proc.io_read_rate = 0.0;
+        proc.io_write_rate = 512.0;
+        proc.io_available = pid % 2 == 0;
+        proc.sample_age = 0;
+        proc.footprint.pss = 1000000ull + pid;
+        proc.footprint_age = -1.0;
+        return proc;
+    }
+    
+    static void fillTable(ProcessTable& table, StringPool& strings, const std::vector<ProcessInfo>& processes) {
+        table.clear();
+        for (const auto& proc : processes) {
+            table.append(proc, strings);
+        }
+    }
+    
+    static void expectSameTable(const ProcessTable& expected, const StringPool& expected_strings,
+                                const ProcessTable& actual, const StringPool& actual_strings) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t row = 0; row < expected.size(); ++row) {
+            SCOPED_TRACE("row " + std::to_string(row));
+            EXPECT_EQ(expected.pid[row], actual.pid[row]);
+            EXPECT_EQ(expected.ppid[row], actual.ppid[row]);
+            EXPECT_EQ(expected.start_time[row], actual.start_time[row]);
+            EXPECT_EQ(expected_strings.get(expected.name[row]), actual_strings.get(actual.name[row]));
+            EXPECT_EQ(expected_strings.get(expected.user[row]), actual_strings.get(actual.user[row]));
+            EXPECT_EQ(expected.state[row], actual.state[row]);
+            EXPECT_EQ(expected.num_threads[row], actual.num_threads[row]);
+            EXPECT_EQ(expected.cpu_percent[row], actual.cpu_percent[row]);
+            EXPECT_EQ(expected.memory_percent[row], actual.memory_percent[row]);
+            EXPECT_EQ(expected.memory_bytes[row], actual.memory_bytes[row]);
+            EXPECT_EQ(expected.io_read_rate[row], actual.io_read_rate[row]);
+            EXPECT_EQ(expected.io_write_rate[row], actual.io_write_rate[row]);
+            EXPECT_EQ(expected.io_syscr_rate[row], actual.io_syscr_rate[row]);
+            EXPECT_EQ(expected.io_syscw_rate[row], actual.io_syscw_rate[row]);
+            EXPECT_EQ(expected.io_available[row], actual.io_available[row]);
+            EXPECT_EQ(expected.sample_age[row], actual.sample_age[row]);
+            EXPECT_EQ(expected.footprint[row].pss, actual.footprint[row].pss);
+            EXPECT_EQ(expected.footprint[row].swap, actual.footprint[row].swap);
+            EXPECT_EQ(expected.footprint_age[row], actual.footprint_age[row]);
+        }
+    }
+    
+    // Encodes and decodes one tick, checking the decoded table
+    void roundTrip(const std::vector<ProcessInfo>& processes, bool keyframe) {
+        fillTable(table_, strings_, processes);
+        payload_.clear();
+        encoder_.encode(table_, strings_, keyframe, payload_);
+        ASSERT_TRUE(decoder_.decode(payload_.data(), payload_.size(), keyframe));
+        ProcessTable decoded;
+        StringPool decoded_strings;
+        decoder_.output(decoded, decoded_strings);
+        expectSameTable(table_, strings_, decoded, decoded_strings);
+    }
+    
+    ProcessTableEncoder encoder_;
+    ProcessTableDecoder decoder_;
+    ProcessTable table_;
+    StringPool strings_;
+    std::vector<uint8_t> payload_;
+};
+
+TEST_F(CaptureCodecTest, KeyframeRoundTripsEveryColumn) {
+    std::vector<ProcessInfo> processes;
+    for (int pid = 1; pid <= 50; ++pid) {
+        processes.push_back(makeProcess(pid * 7, 1000 + pid * 3, "worker-" + std::to_string(pid % 5)));
+    }
+    processes[3].cpu_percent = 12.345;
+    processes[4].ppid = -1;
+    processes[5].footprint_age = 2.5;
+    processes[6].footprint.swap = ~0ull;
+    processes[7].cpu_percent = std::nan("");
+    processes[8].io_read_rate = -0.0;
+    processes[9].state = 'Z';
+    
+    fillTable(table_, strings_, processes);
+    encoder_.encode(table_, strings_, true, payload_);
+    ASSERT_TRUE(decoder_.decode(payload_.data(), payload_.size(), true));
+    ProcessTable decoded;
+    StringPool decoded_strings;
+    decoder_.output(decoded, decoded_strings);
+    
+    // NaN never compares equal, so it is checked on its own
+    ASSERT_EQ(table_.size(), decoded.size());
+    EXPECT_TRUE(std::isnan(decoded.cpu_percent[7]));
+    table_.cpu_percent[7] = decoded.cpu_percent[7] = 0.0;
+    EXPECT_TRUE(std::signbit(decoded.io_read_rate[8]));
+    expectSameTable(table_, strings_, decoded, decoded_strings);
+}
+
+TEST_F(CaptureCodecTest, DeltaTracksSpawnExitAndReusedPid) {
+    std::vector<ProcessInfo> processes = {
+        makeProcess(1, 10, "init"), makeProcess(200, 500, "bash"),
+        makeProcess(300, 600, "make"), makeProcess(400, 700, "cc1plus"),
+    };
+    roundTrip(processes, true);
+    
+    // 200 exits, 300 is reused by a new process, 350 and 500 spawn
+    std::vector<ProcessInfo> next = {
+        makeProcess(1, 10, "init"), makeProcess(300, 900, "ld"), makeProcess(350, 905, "cc1plus"),
+        makeProcess(400, 700, "cc1plus"), makeProcess(500, 910, "as"),
+    };
+    next[0].cpu_percent = 1.5;
+    next[3].memory_bytes += 1 << 20;
+    next[3].num_threads = 9;
+    roundTrip(next, false);
+    
+    next.erase(next.begin() + 1);
+    next[2].sample_age = 3;
+    roundTrip(next, false);
+}
+
+TEST_F(CaptureCodecTest, UnchangedProcessesCostBits) {
+    std::vector<ProcessInfo> processes;
+    for (int pid = 1; pid <= 1000; ++pid) {
+        processes.push_back(makeProcess(pid, static_cast<uint64_t>(pid), "httpd"));
+    }
+    roundTrip(processes, true);
+    const size_t keyframe_bytes = payload_.size();
+    
+    roundTrip(processes, false);
+    // One bit per double column per row, a few bytes for the rest
+    EXPECT_LT(payload_.size(), 7 * processes.size() / 8 + 64);
+    EXPECT_LT(payload_.size() * 10, keyframe_bytes);
+    
+    processes[500].cpu_percent = 42.0;
+    roundTrip(processes, false);
+}
+
+TEST_F(CaptureCodecTest, RandomTicksRoundTrip) {
+    std::mt19937 rng(42);
+    std::vector<ProcessInfo> processes;
+    for (int pid = 1; pid <= 300; ++pid) {
+        processes.push_back(makeProcess(pid * 3, static_cast<uint64_t>(pid) * 11, "p" + std::to_string(pid % 40)));
+    }
+    int next_pid = 1000;
+    for (int tick = 0; tick < 40; ++tick) {
+        for (auto& proc : processes) {
+            if (rng() % 4 == 0) {
+                proc.cpu_percent = static_cast<double>(rng() % 10000) / 100.0;
+                proc.memory_bytes += rng() % 8192;
+                proc.io_read_rate = static_cast<double>(rng() % 1000);
+                proc.io_syscr_rate = static_cast<double>(rng() % 200);
+            }
+        }
+        processes.erase(processes.begin() + static_cast<long>(rng() % processes.size()));
+        processes.push_back(makeProcess(next_pid++, 5000 + tick, "new-" + std::to_string(tick)));
+        roundTrip(processes, tick % 16 == 0);
+    }
+    
+    // A keyframe drops the names of processes that are gone
+    processes.resize(10);
+    roundTrip(processes, true);
+    std::set<std::string> in_use = {""};
+    for (const auto& proc : processes) {
+        in_use.insert(proc.name);
+        in_use.insert(proc.user);
+    }
+    EXPECT_EQ(in_use.size(), encoder_.dictionarySize());
+}
+
+TEST_F(CaptureCodecTest, DeltaNeedsItsKeyframe) {
+    std::vector<ProcessInfo> processes = {makeProcess(1, 10, "init"), makeProcess(2, 20, "kthreadd")};
+    fillTable(table_, strings_, processes);
+    encoder_.encode(table_, strings_, true, payload_);
+    payload_.clear();
+    encoder_.encode(table_, strings_, false, payload_);
+    
+    EXPECT_FALSE(decoder_.decode(payload_.data(), payload_.size(), false));
+    EXPECT_FALSE(decoder_.primed());
+}
+
+TEST_F(CaptureCodecTest, CompactedPoolNeedsKeyframe) {
+    std::vector<ProcessInfo> processes = {
+        makeProcess(1, 10, "init"), makeProcess(2, 20, "make"), makeProcess(3, 30, "cc1plus"),
+    };
+    roundTrip(processes, true);
+    EXPECT_FALSE(encoder_.needsKeyframe(strings_));
+    
+    // make exits and the pool drops its name, so cc1plus takes a lower ID
+    processes.erase(processes.begin() + 1);
+    fillTable(table_, strings_, processes);
+    std::vector<uint8_t> flags(strings_.size(), 0);
+    for (size_t row = 0; row < table_.size(); ++row) {
+        flags[table_.name[row]] = flags[table_.user[row]] = 1;
+    }
+    std::vector<StringPool::Id> remap;
+    strings_.compact(flags, remap);
+    EXPECT_TRUE(encoder_.needsKeyframe(strings_));
+    
+    roundTrip(processes, true);
+    EXPECT_FALSE(encoder_.needsKeyframe(strings_));
+    processes.push_back(makeProcess(4, 40, "ld"));
+    roundTrip(processes, false);
+}
+
+TEST_F(CaptureCodecTest, RejectsMalformedDoubleColumns) {
+    // With every double zero each value is a single '0' bit, so the last
+    // 7 bytes hold the 7 double columns of these 8 rows
+    std::vector<ProcessInfo> processes;
+    for (int pid = 1; pid <= 8; ++pid) {
+        ProcessInfo proc = makeProcess(pid, 10 * pid, "sh");
+        proc.memory_percent = 0.0;
+        proc.io_write_rate = 0.0;
+        proc.footprint_available = true;
+        proc.footprint_age = 0.0;
+        processes.push_back(proc);
+    }
+    fillTable(table_, strings_, processes);
+    encoder_.encode(table_, strings_, true, payload_);
+    ASSERT_GE(payload_.size(), 7u);
+    const size_t doubles = payload_.size() - 7;
+    ASSERT_TRUE(std::all_of(payload_.begin() + doubles, payload_.end(), [](uint8_t b) { return b == 0; }));
+    ASSERT_TRUE(decoder_.decode(payload_.data(), payload_.size(), true));
+    
+    // '10': reuses the XOR window before any was stored
+    std::vector<uint8_t> corrupt = payload_;
+    corrupt[doubles] = 0x80;
+    EXPECT_FALSE(decoder_.decode(corrupt.data(), corrupt.size(), true));
+    EXPECT_FALSE(decoder_.primed());
+    
+    // '11', 63 leading zeros and 64 meaningful bits: wider than a double
+    corrupt = payload_;
+    corrupt[doubles] = 0xff;
+    corrupt[doubles + 1] = 0xfc;
+    EXPECT_FALSE(decoder_.decode(corrupt.data(), corrupt.size(), true));
+    EXPECT_FALSE(decoder_.primed());
+}
+
+TEST_F(CaptureCodecTest, RejectsTruncatedTicks) {
+    std::vector<ProcessInfo> processes;
+    for (int pid = 1; pid <= 20; ++pid) {
+        processes.push_back(makeProcess(pid, static_cast<uint64_t>(pid), "svc" + std::to_string(pid)));
+        processes.back().cpu_percent = pid * 1.25;
+    }
+    fillTable(table_, strings_, processes);
+    encoder_.encode(table_, strings_, true, payload_);
+    
+    for (size_t size = 0; size < payload_.size(); ++size) {
+        ProcessTableDecoder decoder;
+        EXPECT_FALSE(decoder.decode(payload_.data(), size, true)) << size;
+        EXPECT_FALSE(decoder.primed());
+    }
+}
@@ -1,10 +1,50 @@
 #include <gtest/gtest.h>
 #include "fuzzy_search.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
 
 class FuzzySearchTest : public ::testing::Test {
 protected:
     void SetUp() override {}
     void TearDown() override {}
+    
+    // Textbook full-matrix DP, to check the faster paths against
+    static int referenceDistance(const std::string& s1, const std::string& s2) {
+        std::vector<int> row(s2.size() + 1);
+        for (size_t j = 0; j <= s2.size(); ++j) row[j] = static_cast<int>(j);
+        for (size_t i = 1; i <= s1.size(); ++i) {
+            int diag = row[0];
+            row[0] = static_cast<int>(i);
+            for (size_t j = 1; j <= s2.size(); ++j) {
+                const int up = row[j];
+                row[j] = std::min({up + 1, row[j - 1] + 1, diag + (s1[i - 1] == s2[j - 1] ? 0 : 1)});
+                diag = up;
+            }
+        }
+        return row[s2.size()];
+    }
+    
+    // Small alphabet, so random strings share plenty of characters
+    static std::string randomString(std::mt19937& rng, size_t length) {
+        std::string result(length, 'a');
+        for (char& c : result) c = static_cast<char>('a' + rng() % 4);
+        return result;
+    }
+    
+    // A copy of s with count random substitutions, insertions and deletions
+    static std::string mutate(std::mt19937& rng, std::string s, int count) {
+        for (int i = 0; i < count; ++i) {
+            const size_t pos = s.empty() ? 0 : rng() % s.size();
+            switch (rng() % 3) {
+                case 0: if (!s.empty()) s[pos] = static_cast<char>('a' + rng() % 4); break;
+                case 1: s.insert(s.begin() + static_cast<long>(pos), 'z'); break;
+                default: if (!s.empty()) s.erase(pos, 1); break;
+            }
+        }
+        return s;
+    }
 };
 
 TEST_F(FuzzySearchTest, LevenshteinDistance_ExactMatch) {
@@ -19,6 +59,43 @@ TEST_F(FuzzySearchTest, LevenshteinDistance_SimpleCases) {
     EXPECT_EQ(3, FuzzySearch::levenshteinDistance("kitten", "sitting"));
 }
 
+TEST_F(FuzzySearchTest, LevenshteinDistance_MatchesReference) {
+    std::mt19937 rng(7);
+    // Both sides of the one-word pattern limit, and far past it
+    for (size_t length : {1, 5, 15, 63, 64, 65, 100, 200}) {
+        for (int round = 0; round < 20; ++round) {
+            const std::string a = randomString(rng, length);
+            const std::string b = round % 2 == 0 ? mutate(rng, a, 1 + round) : randomString(rng, 1 + rng() % 150);
+            EXPECT_EQ(referenceDistance(a, b), FuzzySearch::levenshteinDistance(a, b)) << a << " / " << b;
+            EXPECT_EQ(referenceDistance(a, b), FuzzySearch::levenshteinDistance(b, a)) << a << " / " << b;
+        }
+    }
+    // Bytes above 0x7f index the same tables as any other character
+    EXPECT_EQ(1, FuzzySearch::levenshteinDistance("caf\xc3\xa9", "caf\xc3\xa8"));
+}
+
+TEST_F(FuzzySearchTest, LevenshteinDistance_BoundedStopsPastLimit) {
+    EXPECT_EQ(3, FuzzySearch::levenshteinDistance("kitten", "sitting", 3));
+    EXPECT_EQ(3, FuzzySearch::levenshteinDistance("kitten", "sitting", 10));
+    EXPECT_EQ(3, FuzzySearch::levenshteinDistance("kitten", "sitting", 2));
+    EXPECT_EQ(1, FuzzySearch::levenshteinDistance("postgres", "x", 0));
+    EXPECT_EQ(0, FuzzySearch::levenshteinDistance("", "", 0));
+    
+    std::mt19937 rng(11);
+    for (size_t length : {10, 64, 90, 300}) {
+        for (int edits = 0; edits < 12; ++edits) {
+            const std::string a = randomString(rng, length);
+            const std::string b = mutate(rng, a, edits);
+            const int exact = referenceDistance(a, b);
+            for (int limit : {0, exact - 1, exact, exact + 5}) {
+                if (limit < 0) continue;
+                const int expected = exact <= limit ? exact : limit + 1;
+                EXPECT_EQ(expected, FuzzySearch::levenshteinDistance(a, b, limit)) << length << " " << limit;
+            }
+        }
+    }
+}
+
 TEST_F(FuzzySearchTest, Similarity_ExactMatch) {
     EXPECT_DOUBLE_EQ(1.0, FuzzySearch::similarity("hello", "hello"));
     EXPECT_DOUBLE_EQ(1.0, FuzzySearch::similarity("", ""));
@@ -47,6 +124,22 @@ TEST_F(FuzzySearchTest, Matches_FuzzyMatch) {
     EXPECT_TRUE(FuzzySearch::matches("chromium", "chromiumm", 0.8));
 }
 
+TEST_F(FuzzySearchTest, Matches_AgreesWithSimilarityAtThreshold) {
+    // 7 edits over 10 characters scores 0.3 exactly, 8 falls short
+    EXPECT_TRUE(FuzzySearch::matches("abcdefghij", "abcxxxxxxx", 0.3));
+    EXPECT_FALSE(FuzzySearch::matches("abcdefghij", "abxxxxxxxx", 0.3));
+    
+    std::mt19937 rng(3);
+    for (int round = 0; round < 500; ++round) {
+        const std::string text = randomString(rng, 1 + rng() % 80);
+        const std::string query = mutate(rng, randomString(rng, 1 + rng() % 12), static_cast<int>(rng() % 4));
+        const double threshold = static_cast<double>(rng() % 11) / 10.0;
+        const bool expected = text.find(query) != std::string::npos || query.empty() ||
+                              FuzzySearch::similarity(text, query) >= threshold;
+        EXPECT_EQ(expected, FuzzySearch::matches(text, query, threshold)) << text << " / " << query;
+    }
+}
+
 TEST_F(FuzzySearchTest, Matches_CaseInsensitive) {
     EXPECT_TRUE(FuzzySearch::matches("ChRoMiUm", "chrome"));
     EXPECT_TRUE(FuzzySearch::matches("FIREFOX", "fire"));
@@ -57,6 +150,51 @@ TEST_F(FuzzySearchTest, Matches_NoMatch) {
     EXPECT_FALSE(FuzzySearch::matches("process", "completely_different"));
 }
 
+TEST_F(FuzzySearchTest, FindIgnoreCase_EveryIsaAgrees) {
+    std::vector<FuzzySearch::Isa> isas = {FuzzySearch::Isa::Scalar};
+    if (FuzzySearch::supportedIsa() >= FuzzySearch::Isa::SSE2) isas.push_back(FuzzySearch::Isa::SSE2);
+    if (FuzzySearch::supportedIsa() >= FuzzySearch::Isa::AVX2) isas.push_back(FuzzySearch::Isa::AVX2);
+    
+    // Letters of both cases next to the bytes that border them, and UTF-8
+    const std::string alphabet = "aAbBzZ@[`{-\xc3\x89";
+    std::mt19937 rng(5);
+    for (size_t length : {0, 1, 2, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 96, 97, 200}) {
+        for (int round = 0; round < 60; ++round) {
+            std::string text(length, 'a');
+            for (char& c : text) c = alphabet[rng() % alphabet.size()];
+            std::string query = FuzzySearch::toLower(length > 0 && round % 2 == 0
+                ? text.substr(rng() % length, 1 + rng() % 70)
+                : std::string(1 + rng() % 3, alphabet[rng() % alphabet.size()]));
+            if (round % 5 == 0 && !query.empty()) query.back() = 'q';
+            const size_t expected = FuzzySearch::toLower(text).find(query);
+            for (FuzzySearch::Isa isa : isas) {
+                EXPECT_EQ(expected, FuzzySearch::findIgnoreCase(text, query, isa))
+                    << static_cast<int>(isa) << " " << text << " / " << query;
+            }
+        }
+    }
+    EXPECT_EQ(0u, FuzzySearch::findIgnoreCase("bash", ""));
+    EXPECT_EQ(std::string::npos, FuzzySearch::findIgnoreCase("sh", "bash"));
+    EXPECT_EQ(11u, FuzzySearch::findIgnoreCase("containerd-SHIM-runc-v2", "shim-"));
+}
+
+TEST_F(FuzzySearchTest, ScoreLowered_AgreesWithMatchAndScore) {
+    const char* names[] = {"chromium", "Chrome_ChildIOT", "kworker/3:1-events", "postgres", "", "x",
+                           "systemd-journald", "a-process-name-well-past-sixty-four-characters-long-for-the-band"};
+    const char* queries[] = {"chr", "CHROME", "kwork", "pyhton", "journal", "x", "zzzzzzzz", "band"};
+    for (const char* name : names) {
+        for (const char* query : queries) {
+            for (double threshold : {0.0, 0.3, 0.8}) {
+                const double expected = FuzzySearch::matches(name, query, threshold)
+                    ? FuzzySearch::getMatchScore(name, query) : -1.0;
+                EXPECT_DOUBLE_EQ(expected, FuzzySearch::scoreLowered(FuzzySearch::toLower(name),
+                                                                     FuzzySearch::toLower(query), threshold))
+                    << name << " / " << query << " " << threshold;
+            }
+        }
+    }
+}
+
 TEST_F(FuzzySearchTest, GetMatchScore_SubstringAtStart) {
     double score1 = FuzzySearch::getMatchScore("chromium", "chr");
     double score2 = FuzzySearch::getMatchScore("chromium", "ium");
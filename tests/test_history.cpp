@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "history.hpp"
+#include <chrono>
+
+class HistoryTest : public ::testing::Test {
+protected:
+    using Clock = History::Clock;
+    
+    void SetUp() override {
+        start_ = Clock::time_point(std::chrono::hours(1));
+    }
+    void TearDown() override {}
+    
+    Clock::time_point at(double seconds) const {
+        return start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+    
+    static void appendProcess(ProcessTable& table, StringPool& strings, int pid, double cpu, uint64_t start_time = 1) {
+        ProcessInfo proc;
+        proc.pid = pid;
+        proc.cpu_percent = cpu;
+        proc.memory_bytes = 1024;
+        proc.start_time = start_time;
+        table.append(proc, strings);
+    }
+    
+    Clock::time_point start_;
+};
+
+TEST_F(HistoryTest, Ring_OverwritesOldest) {
+    HistoryRing ring(3);
+    for (int i = 1; i <= 5; ++i) {
+        ring.push(HistoryPoint(static_cast<float>(i)));
+    }
+    ASSERT_EQ(3u, ring.size());
+    EXPECT_FLOAT_EQ(3.0f, ring.at(0).avg);
+    EXPECT_FLOAT_EQ(4.0f, ring.at(1).avg);
+    EXPECT_FLOAT_EQ(5.0f, ring.latest().avg);
+}
+
+TEST_F(HistoryTest, Metric_DownsamplesIntoBuckets) {
+    MetricHistory metric;
+    // Two samples a second for 25 s: values 0..49
+    for (int i = 0; i < 50; ++i) {
+        metric.add(i, at(i * 0.5));
+    }
+    EXPECT_EQ(50u, metric.tier(HistoryTier::Raw).size());
+    
+    // Buckets [0,10) and [10,20) are closed, [20,25) is still open
+    const HistoryRing& ten = metric.tier(HistoryTier::TenSeconds);
+    ASSERT_EQ(2u, ten.size());
+    EXPECT_FLOAT_EQ(0.0f, ten.at(0).min);
+    EXPECT_FLOAT_EQ(19.0f, ten.at(0).max);
+    EXPECT_FLOAT_EQ(9.5f, ten.at(0).avg);
+    EXPECT_FLOAT_EQ(20.0f, ten.at(1).min);
+    EXPECT_FLOAT_EQ(39.0f, ten.at(1).max);
+    EXPECT_EQ(0u, metric.tier(HistoryTier::Minute).size());
+    
+    metric.add(100, at(61));
+    const HistoryRing& minute = metric.tier(HistoryTier::Minute);
+    ASSERT_EQ(1u, minute.size());
+    EXPECT_FLOAT_EQ(0.0f, minute.at(0).min);
+    EXPECT_FLOAT_EQ(49.0f, minute.at(0).max);
+    EXPECT_FLOAT_EQ(24.5f, minute.at(0).avg);
+}
+
+TEST_F(HistoryTest, Metric_MemoryIsFixedAfterConstruction) {
+    HistoryLayout layout;
+    layout.raw_points = 8;
+    layout.ten_second_points = 4;
+    layout.minute_points = 2;
+    MetricHistory metric(layout);
+    const size_t bytes = metric.memoryBytes();
+    const HistoryPoint* raw = &metric.tier(HistoryTier::Raw).at(0);
+    
+    // An hour of samples
+    for (int i = 0; i < 7200; ++i) {
+        metric.add(i % 100, at(i * 0.5));
+    }
+    EXPECT_EQ(bytes, metric.memoryBytes());
+    EXPECT_EQ(8u, metric.tier(HistoryTier::Raw).size());
+    EXPECT_EQ(4u, metric.tier(HistoryTier::TenSeconds).size());
+    EXPECT_EQ(2u, metric.tier(HistoryTier::Minute).size());
+    // Same storage: the ring wrapped instead of growing
+    const HistoryRing& ring = metric.tier(HistoryTier::Raw);
+    bool same_storage = false;
+    for (size_t i = 0; i < ring.size(); ++i) {
+        same_storage = same_storage || &ring.at(i) == raw;
+    }
+    EXPECT_TRUE(same_storage);
+}
+
+TEST_F(HistoryTest, Processes_BusiestClaimSlotsAndExitsFreeThem) {
+    History history(2);
+    StringPool strings;
+    ProcessTable table;
+    appendProcess(table, strings, 10, 50.0);
+    appendProcess(table, strings, 20, 30.0);
+    appendProcess(table, strings, 30, 0.0);
+    history.recordProcesses(table, {0, 1}, at(0));
+    history.recordProcesses(table, {0, 1}, at(0.5));
+    
+    ASSERT_NE(nullptr, history.findProcess(10));
+    EXPECT_EQ(2u, history.findProcess(10)->cpu_percent.tier(HistoryTier::Raw).size());
+    EXPECT_FLOAT_EQ(50.0f, history.findProcess(10)->cpu_percent.tier(HistoryTier::Raw).latest().avg);
+    EXPECT_EQ(nullptr, history.findProcess(30));
+    
+    // 30 gets busy; 20 left the top first, so its slot goes
+    history.recordProcesses(table, {0}, at(1.0));
+    history.recordProcesses(table, {0, 2}, at(1.5));
+    EXPECT_NE(nullptr, history.findProcess(10));
+    EXPECT_EQ(nullptr, history.findProcess(20));
+    ASSERT_NE(nullptr, history.findProcess(30));
+    EXPECT_EQ(1u, history.findProcess(30)->cpu_percent.tier(HistoryTier::Raw).size());
+    
+    // 10 exits; its PID comes back as a different process
+    ProcessTable next;
+    appendProcess(next, strings, 10, 5.0, 99);
+    appendProcess(next, strings, 30, 1.0);
+    history.recordProcesses(next, {}, at(2.0));
+    EXPECT_EQ(nullptr, history.findProcess(10));
+    EXPECT_NE(nullptr, history.findProcess(30));
+}
+
+TEST_F(HistoryTest, System_RecordsEveryCore) {
+    History history(0);
+    history.recordSystem(25.0, {10.0, 40.0}, 60.0, 0.0, at(0));
+    const size_t bytes = history.memoryBytes();
+    history.recordSystem(35.0, {20.0, 50.0}, 61.0, 0.0, at(0.5));
+    
+    ASSERT_EQ(2u, history.cores().size());
+    EXPECT_EQ(bytes, history.memoryBytes());
+    EXPECT_FLOAT_EQ(50.0f, history.cores()[1].tier(HistoryTier::Raw).latest().avg);
+    EXPECT_FLOAT_EQ(35.0f, history.cpu().tier(HistoryTier::Raw).latest().avg);
+    EXPECT_EQ(2u, history.memory().tier(HistoryTier::Raw).size());
+}
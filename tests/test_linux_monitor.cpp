@@ -0,0 +1,604 @@
+#include <gtest/gtest.h>
+#include "linux_monitor.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// tbm raises the fd limit at startup, before the /proc fd cache sizes
+// itself; the tests do the same before any of them first reads /proc
+class FileLimitEnvironment : public ::testing::Environment {
+public:
+    void SetUp() override { LinuxMonitor::raiseFileLimit(); }
+};
+
+const ::testing::Environment* const kFileLimitEnvironment =
+    ::testing::AddGlobalTestEnvironment(new FileLimitEnvironment);
+
+class LinuxMonitorTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+    
+    static std::string statLine(const std::string& comm) {
+        return "1234 (" + comm + ") S 1 1234 1234 0 -1 4194560 1000 0 0 0 "
+               "250 75 0 0 20 0 3 0 98765 123456789 2048 18446744073709551615 "
+               "1 1 0 0 0 0 0 0 0 0 0 0 17 2 0 0 0 0 0\n";
+    }
+};
+
+TEST_F(LinuxMonitorTest, ParseStat_SimpleName) {
+    std::string line = statLine("bash");
+    ProcessInfo proc;
+    ASSERT_TRUE(LinuxMonitor::parseStatBuffer(line.data(), line.size(), proc));
+    
+    EXPECT_EQ("bash", proc.name);
+    EXPECT_EQ('S', proc.state);
+    EXPECT_EQ(1, proc.ppid);
+    EXPECT_EQ(250u, proc.utime);
+    EXPECT_EQ(75u, proc.stime);
+    EXPECT_EQ(98765u, proc.start_time);
+    EXPECT_EQ(3, proc.num_threads);
+    EXPECT_EQ(123456789u, proc.virtual_memory);
+    EXPECT_EQ(2048u * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)), proc.resident_memory);
+}
+
+TEST_F(LinuxMonitorTest, ParseStat_NameWithSpacesAndParens) {
+    for (const std::string comm : {"Web Content", "a) b (c", "))", "x) S 9 9"}) {
+        std::string line = statLine(comm);
+        ProcessInfo proc;
+        ASSERT_TRUE(LinuxMonitor::parseStatBuffer(line.data(), line.size(), proc)) << comm;
+        EXPECT_EQ(comm, proc.name);
+        EXPECT_EQ('S', proc.state);
+        EXPECT_EQ(250u, proc.utime);
+        EXPECT_EQ(98765u, proc.start_time);
+    }
+}
+
+TEST_F(LinuxMonitorTest, ParseStat_RejectsMalformed) {
+    ProcessInfo proc;
+    const char* garbage = "1234 no parens here";
+    EXPECT_FALSE(LinuxMonitor::parseStatBuffer(garbage, std::strlen(garbage), proc));
+    const char* truncated = "1234 (bash)";
+    EXPECT_FALSE(LinuxMonitor::parseStatBuffer(truncated, std::strlen(truncated), proc));
+}
+
+TEST_F(LinuxMonitorTest, ParseStatus_RssAndUid) {
+    const std::string status =
+        "Name:\tbash\n"
+        "State:\tS (sleeping)\n"
+        "Uid:\t1000\t1000\t1000\t1000\n"
+        "Gid:\t1000\t1000\t1000\t1000\n"
+        "VmPeak:\t   12000 kB\n"
+        "VmRSS:\t    5120 kB\n";
+    uint64_t rss = 0;
+    unsigned uid = 0;
+    ASSERT_TRUE(LinuxMonitor::parseStatusBuffer(status.data(), status.size(), rss, uid));
+    EXPECT_EQ(1000u, uid);
+    EXPECT_EQ(5120u * 1024, rss);
+}
+
+TEST_F(LinuxMonitorTest, ParseMemInfo_Keys) {
+    const std::string meminfo =
+        "MemTotal:       16000000 kB\n"
+        "MemFree:         4000000 kB\n"
+        "MemAvailable:    9000000 kB\n"
+        "Buffers:          500000 kB\n"
+        "Cached:          3000000 kB\n"
+        "SwapCached:            0 kB\n";
+    MemoryStats stats = LinuxMonitor::parseMemInfoBuffer(meminfo.data(), meminfo.size());
+    EXPECT_EQ(16000000ull * 1024, stats.total);
+    EXPECT_EQ(4000000ull * 1024, stats.free);
+    EXPECT_EQ(500000ull * 1024, stats.buffers);
+    EXPECT_EQ(3000000ull * 1024, stats.cached);
+    // used is derived from MemAvailable when the kernel provides it
+    EXPECT_EQ(7000000ull * 1024, stats.used);
+}
+
+TEST_F(LinuxMonitorTest, ParseMemInfo_FullModel) {
+    const std::string meminfo =
+        "MemTotal:        8000000 kB\n"
+        "MemFree:         1000000 kB\n"
+        "MemAvailable:    5000000 kB\n"
+        "Buffers:          100000 kB\n"
+        "Cached:          2000000 kB\n"
+        "SwapCached:         1000 kB\n"
+        "Active:          3000000 kB\n"
+        "SwapTotal:       2000000 kB\n"
+        "SwapFree:        1500000 kB\n"
+        "Dirty:              4000 kB\n"
+        "Writeback:           100 kB\n"
+        "Shmem:            300000 kB\n"
+        "Slab:             400000 kB\n"
+        "SReclaimable:     250000 kB\n"
+        "SUnreclaim:       150000 kB\n"
+        "HugePages_Total:      64\n"
+        "HugePages_Free:       60\n"
+        "HugePages_Rsvd:        2\n"
+        "HugePages_Surp:        0\n"
+        "Hugepagesize:       2048 kB\n";
+    MemoryStats stats = LinuxMonitor::parseMemInfoBuffer(meminfo.data(), meminfo.size());
+    EXPECT_EQ(5000000ull * 1024, stats.available);
+    EXPECT_EQ(500000ull * 1024, stats.swapUsed());
+    EXPECT_EQ(1000ull * 1024, stats.swap_cached);
+    EXPECT_EQ(4000ull * 1024, stats.dirty);
+    EXPECT_EQ(100ull * 1024, stats.writeback);
+    EXPECT_EQ(300000ull * 1024, stats.shmem);
+    EXPECT_EQ(400000ull * 1024, stats.slab);
+    EXPECT_EQ(250000ull * 1024, stats.slab_reclaimable);
+    EXPECT_EQ(64u, stats.hugepages_total);
+    EXPECT_EQ(60u, stats.hugepages_free);
+    EXPECT_EQ(2u, stats.hugepages_reserved);
+    EXPECT_EQ(2048ull * 1024, stats.hugepage_size);
+}
+
+TEST_F(LinuxMonitorTest, ParseMemInfo_WithoutMemAvailable) {
+    const std::string meminfo =
+        "MemTotal:       1000 kB\n"
+        "MemFree:         100 kB\n"
+        "Buffers:          50 kB\n"
+        "Cached:          200 kB\n"
+        "SReclaimable:     50 kB\n";
+    MemoryStats stats = LinuxMonitor::parseMemInfoBuffer(meminfo.data(), meminfo.size());
+    EXPECT_EQ(600ull * 1024, stats.used);
+    EXPECT_EQ(400ull * 1024, stats.available);
+}
+
+TEST_F(LinuxMonitorTest, ParseMemInfo_EmptyInputIsZeroed) {
+    MemoryStats stats = LinuxMonitor::parseMemInfoBuffer("", 0);
+    EXPECT_EQ(0u, stats.total);
+    EXPECT_EQ(0u, stats.used);
+    EXPECT_EQ(0u, stats.swap_total);
+    EXPECT_DOUBLE_EQ(0.0, stats.percent_used);
+}
+
+TEST_F(LinuxMonitorTest, ParseDiskStats_CountersAndFilter) {
+    // Device numbers chosen so that no sysfs entry marks them as partitions
+    const std::string diskstats =
+        "   7       0 loop0 10 0 80 5 0 0 0 0 0 4 5 0 0 0 0 0 0\n"
+        " 4095   4000 vda 63160 27202 1966626 9761 7783 16903 476096 4516 2 4304 14731 0 0 0 0 0 0\n"
+        " 4095   4016 vdb 1253 858 16906 38 0 0 0 0 0 28 38\n"
+        "   1       0 ram0 0 0 0 0 0 0 0 0 0 0 0\n";
+    std::vector<DiskStats> disks;
+    LinuxMonitor::DiskFilter filter;
+    LinuxMonitor::parseDiskStatsBuffer(diskstats.data(), diskstats.size(), disks, filter);
+    
+    ASSERT_EQ(2u, disks.size());
+    EXPECT_EQ("vda", disks[0].name);
+    EXPECT_EQ(4095u, disks[0].major);
+    EXPECT_EQ(4000u, disks[0].minor);
+    EXPECT_EQ(63160u, disks[0].reads);
+    EXPECT_EQ(1966626u, disks[0].sectors_read);
+    EXPECT_EQ(9761u, disks[0].read_time_ms);
+    EXPECT_EQ(7783u, disks[0].writes);
+    EXPECT_EQ(476096u, disks[0].sectors_written);
+    EXPECT_EQ(4516u, disks[0].write_time_ms);
+    EXPECT_EQ(2u, disks[0].in_flight);
+    EXPECT_EQ(4304u, disks[0].io_time_ms);
+    // Older kernels print only 11 counters
+    EXPECT_EQ("vdb", disks[1].name);
+    EXPECT_EQ(28u, disks[1].io_time_ms);
+    
+    filter.virtual_devices = true;
+    LinuxMonitor::parseDiskStatsBuffer(diskstats.data(), diskstats.size(), disks, filter);
+    ASSERT_EQ(4u, disks.size());
+    EXPECT_EQ("loop0", disks[0].name);
+    EXPECT_EQ("ram0", disks[3].name);
+}
+
+TEST_F(LinuxMonitorTest, ParseDiskStats_StableDevicesKeepTheirSlots) {
+    const std::string diskstats =
+        " 4095   4000 nvme0n1 100 0 800 10 50 0 400 5 0 20 15\n"
+        " 4095   4016 nvme1n1 200 0 1600 20 60 0 480 6 0 25 26\n";
+    std::vector<DiskStats> disks;
+    LinuxMonitor::DiskFilter filter;
+    LinuxMonitor::parseDiskStatsBuffer(diskstats.data(), diskstats.size(), disks, filter);
+    ASSERT_EQ(2u, disks.size());
+    const DiskStats* slots = disks.data();
+    const char* name = disks[1].name.data();
+    
+    LinuxMonitor::parseDiskStatsBuffer(diskstats.data(), diskstats.size(), disks, filter);
+    EXPECT_EQ(slots, disks.data());
+    EXPECT_EQ(name, disks[1].name.data());
+    
+    // A removed device shrinks the list
+    const std::string one_left = " 4095   4016 nvme1n1 210 0 1680 21 60 0 480 6 0 26 27\n";
+    LinuxMonitor::parseDiskStatsBuffer(one_left.data(), one_left.size(), disks, filter);
+    ASSERT_EQ(1u, disks.size());
+    EXPECT_EQ("nvme1n1", disks[0].name);
+    EXPECT_EQ(210u, disks[0].reads);
+}
+
+TEST_F(LinuxMonitorTest, ParseNetDev_Counters) {
+    const std::string netdev =
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+        "    lo: 30680414    4156    0    0    0     0          0         0 30680414    4156    0    0    0     0       0          0\n"
+        "  eth0:1116      16    2    3    0     0          0         0     1188      17    4    5    0     0       0          0\n";
+    NetInterfaceTable table;
+    LinuxMonitor::parseNetDevBuffer(netdev.data(), netdev.size(), table);
+    
+    ASSERT_EQ(2u, table.slots.size());
+    EXPECT_EQ(1u, table.tick);
+    const NetStats& eth0 = table.slots[table.index.at("eth0")];
+    EXPECT_TRUE(eth0.active);
+    EXPECT_EQ(1u, eth0.first_seen);
+    // No space after the colon once the rx byte count is wide enough
+    EXPECT_EQ(1116u, eth0.counters.rx_bytes);
+    EXPECT_EQ(16u, eth0.counters.rx_packets);
+    EXPECT_EQ(2u, eth0.counters.rx_errors);
+    EXPECT_EQ(3u, eth0.counters.rx_dropped);
+    EXPECT_EQ(1188u, eth0.counters.tx_bytes);
+    EXPECT_EQ(17u, eth0.counters.tx_packets);
+    EXPECT_EQ(4u, eth0.counters.tx_errors);
+    EXPECT_EQ(5u, eth0.counters.tx_dropped);
+    EXPECT_EQ(30680414u, table.slots[table.index.at("lo")].counters.tx_bytes);
+}
+
+TEST_F(LinuxMonitorTest, ParseNetDev_ChurnReusesSlots) {
+    auto netdev = [](const std::vector<std::string>& names) {
+        std::string out = "Inter-|\n face |\n";
+        for (const auto& name : names) {
+            out += "  " + name + ": 1 2 0 0 0 0 0 0 3 4 0 0 0 0 0 0\n";
+        }
+        return out;
+    };
+    NetInterfaceTable table;
+    std::string first = netdev({"eth0", "veth1a2b3c", "veth4d5e6f"});
+    LinuxMonitor::parseNetDevBuffer(first.data(), first.size(), table);
+    ASSERT_EQ(3u, table.slots.size());
+    const size_t eth0_slot = table.index.at("eth0");
+    const size_t freed_slot = table.index.at("veth1a2b3c");
+    
+    // One veth goes away and another appears in the same tick window
+    std::string second = netdev({"eth0", "veth4d5e6f"});
+    LinuxMonitor::parseNetDevBuffer(second.data(), second.size(), table);
+    EXPECT_FALSE(table.slots[freed_slot].active);
+    EXPECT_EQ(0u, table.index.count("veth1a2b3c"));
+    
+    std::string third = netdev({"eth0", "veth4d5e6f", "veth7a8b9c"});
+    LinuxMonitor::parseNetDevBuffer(third.data(), third.size(), table);
+    EXPECT_EQ(3u, table.slots.size());
+    EXPECT_EQ(freed_slot, table.index.at("veth7a8b9c"));
+    EXPECT_EQ(3u, table.slots[freed_slot].first_seen);
+    EXPECT_EQ(eth0_slot, table.index.at("eth0"));
+    EXPECT_EQ(1u, table.slots[eth0_slot].first_seen);
+}
+
+TEST_F(LinuxMonitorTest, ParseIo_Counters) {
+    const std::string io =
+        "rchar: 5000\n"
+        "wchar: 3000\n"
+        "syscr: 42\n"
+        "syscw: 17\n"
+        "read_bytes: 4096\n"
+        "write_bytes: 8192\n"
+        "cancelled_write_bytes: 1024\n";
+    ProcessInfo proc;
+    ASSERT_TRUE(LinuxMonitor::parseIoBuffer(io.data(), io.size(), proc));
+    EXPECT_TRUE(proc.io_available);
+    EXPECT_EQ(42u, proc.io_syscr);
+    EXPECT_EQ(17u, proc.io_syscw);
+    EXPECT_EQ(4096u, proc.io_read_bytes);
+    EXPECT_EQ(8192u, proc.io_write_bytes);
+}
+
+TEST_F(LinuxMonitorTest, ParseIo_IncompleteIsUnavailable) {
+    const std::string io = "rchar: 5000\nsyscr: 42\n";
+    ProcessInfo proc;
+    EXPECT_FALSE(LinuxMonitor::parseIoBuffer(io.data(), io.size(), proc));
+    EXPECT_FALSE(proc.io_available);
+}
+
+TEST_F(LinuxMonitorTest, ProcIo_DeniedReadsAreNotRetried) {
+    // PID 1 belongs to root; drop privileges if we have them so its io
+    // file is off limits
+    const bool was_root = geteuid() == 0;
+    if (was_root && seteuid(65534) != 0) {
+        GTEST_SKIP() << "cannot drop privileges";
+    }
+    
+    ProcessInfo first = LinuxMonitor::parseProcessInfo(1);
+    auto before = LinuxMonitor::getProcReadStats();
+    ProcessInfo second = LinuxMonitor::parseProcessInfo(1);
+    auto after = LinuxMonitor::getProcReadStats();
+    
+    if (was_root) {
+        ASSERT_EQ(0, seteuid(0));
+    }
+    if (first.pid != 1 || first.io_available) {
+        GTEST_SKIP() << "PID 1 io is readable in this environment";
+    }
+    EXPECT_EQ(1, second.pid);
+    EXPECT_FALSE(second.io_available);
+    EXPECT_GT(after.permission_skips, before.permission_skips);
+}
+
+TEST_F(LinuxMonitorTest, ParseProcessInfo_Self) {
+    ProcessInfo proc = LinuxMonitor::parseProcessInfo(static_cast<int>(getpid()));
+    EXPECT_EQ(static_cast<int>(getpid()), proc.pid);
+    EXPECT_FALSE(proc.name.empty());
+    EXPECT_GT(proc.memory_bytes, 0u);
+    // Our own io file is always readable
+    EXPECT_TRUE(proc.io_available);
+    EXPECT_GT(proc.io_syscr, 0u);
+}
+
+TEST_F(LinuxMonitorTest, ParseThreads_ListsEveryTask) {
+    std::atomic<bool> done(false);
+    std::atomic<int> worker_tid(0);
+    std::thread worker([&] {
+        worker_tid = static_cast<int>(syscall(SYS_gettid));
+        while (!done) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    while (worker_tid == 0) {
+        std::this_thread::yield();
+    }
+    
+    const int self = static_cast<int>(getpid());
+    std::vector<ThreadInfo> threads = LinuxMonitor::parseThreads(self);
+    const int reported = LinuxMonitor::parseProcessInfo(self).num_threads;
+    done = true;
+    worker.join();
+    
+    ASSERT_GE(threads.size(), 2u);
+    auto has_tid = [&](int tid) {
+        return std::any_of(threads.begin(), threads.end(),
+                           [tid](const ThreadInfo& t) { return t.tid == tid; });
+    };
+    EXPECT_TRUE(has_tid(self));
+    EXPECT_TRUE(has_tid(worker_tid));
+    for (const auto& thread : threads) {
+        EXPECT_FALSE(thread.name.empty());
+        EXPECT_NE('?', thread.state);
+    }
+    EXPECT_EQ(static_cast<int>(threads.size()), reported);
+}
+
+TEST_F(LinuxMonitorTest, ParseThreads_MissingProcessIsEmpty) {
+    EXPECT_TRUE(LinuxMonitor::parseThreads(-1).empty());
+}
+
+TEST_F(LinuxMonitorTest, FdCache_ReusesDescriptorsAcrossScans) {
+    LinuxMonitor::parseProcesses();
+    auto before = LinuxMonitor::getProcReadStats();
+    auto processes = LinuxMonitor::parseProcesses();
+    auto after = LinuxMonitor::getProcReadStats();
+    
+    ASSERT_FALSE(processes.empty());
+    EXPECT_GT(after.cache_hits, before.cache_hits);
+    EXPECT_GT(after.cached_processes, 0u);
+    
+    // Uncached this would be open+read+close for each of stat, status and io
+    double per_process = static_cast<double>(after.syscalls() - before.syscalls()) / processes.size();
+    EXPECT_LT(per_process, 4.0);
+}
+
+TEST_F(LinuxMonitorTest, FdCache_RespectsCapacity) {
+    // Capacity is split across 16 PID shards, one entry each
+    LinuxMonitor::setFdCacheCapacity(16);
+    LinuxMonitor::parseProcesses();
+    EXPECT_LE(LinuxMonitor::getProcReadStats().cached_processes, 16u);
+    LinuxMonitor::setFdCacheCapacity(4096);
+}
+
+TEST_F(LinuxMonitorTest, FdCache_ReadersSurviveConcurrentEviction) {
+    // Readers pin entries and pread outside the shard lock while the main
+    // thread keeps evicting them; every read must still see this process
+    const int self = getpid();
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad_reads{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                if (LinuxMonitor::parseProcessInfo(self).pid != self) {
+                    ++bad_reads;
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 200; ++round) {
+        LinuxMonitor::setFdCacheCapacity(round % 2 == 0 ? 0 : 4096);
+        LinuxMonitor::beginScanTick();
+        LinuxMonitor::endScanTick(0);
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    LinuxMonitor::setFdCacheCapacity(4096);
+    EXPECT_EQ(0, bad_reads.load());
+}
+
+TEST_F(LinuxMonitorTest, ParallelScan_MatchesSerialScan) {
+    std::vector<int> pids = LinuxMonitor::listPids();
+    ASSERT_FALSE(pids.empty());
+    
+    ThreadPool pool(4);
+    auto serial = LinuxMonitor::parseProcesses(pids, nullptr);
+    auto parallel = LinuxMonitor::parseProcesses(pids, &pool);
+    
+    auto byPid = [](const ProcessInfo& a, const ProcessInfo& b) { return a.pid < b.pid; };
+    std::sort(serial.begin(), serial.end(), byPid);
+    std::sort(parallel.begin(), parallel.end(), byPid);
+    
+    // Processes may exit between the two scans, but never appear twice
+    EXPECT_NEAR(static_cast<double>(serial.size()), static_cast<double>(parallel.size()), 5.0);
+    EXPECT_EQ(parallel.end(), std::adjacent_find(parallel.begin(), parallel.end(),
+        [](const ProcessInfo& a, const ProcessInfo& b) { return a.pid == b.pid; }));
+}
+
+TEST_F(LinuxMonitorTest, ParseCPUStats_AllCoresInOnePass) {
+    const std::string stat =
+        "cpu  100 10 50 1000 20 5 5 40 30 0\n"
+        "cpu0 60 5 25 500 10 3 2 30 30 0\n"
+        "cpu1 40 5 25 500 10 2 3 10 0 0\n"
+        "intr 123456 0 0 0\n"
+        "ctxt 999\n";
+    CPUStats total;
+    std::vector<CPUStats> cores;
+    size_t online = 0;
+    ASSERT_TRUE(LinuxMonitor::parseCPUStatsBuffer(stat.data(), stat.size(), total, cores, online));
+    
+    ASSERT_EQ(2u, cores.size());
+    EXPECT_EQ(2u, online);
+    EXPECT_DOUBLE_EQ(40.0, total.steal);
+    EXPECT_DOUBLE_EQ(30.0, total.guest);
+    // guest time is part of user, so it must not be counted twice
+    EXPECT_DOUBLE_EQ(100 + 10 + 50 + 1000 + 20 + 5 + 5 + 40, total.total);
+    EXPECT_DOUBLE_EQ(60.0, cores[0].user);
+    EXPECT_DOUBLE_EQ(30.0, cores[0].steal);
+    EXPECT_DOUBLE_EQ(10.0, cores[1].steal);
+}
+
+TEST_F(LinuxMonitorTest, ParseCPUStats_ShrinksWhenCoresGoOffline) {
+    const std::string before = "cpu  1 1 1 1 1 1 1 1 0 0\ncpu0 1 1 1 1\ncpu1 1 1 1 1\ncpu2 1 1 1 1\n";
+    const std::string after = "cpu  1 1 1 1 1 1 1 1 0 0\ncpu0 1 1 1 1\ncpu1 1 1 1 1\n";
+    CPUStats total;
+    std::vector<CPUStats> cores;
+    size_t online = 0;
+    LinuxMonitor::parseCPUStatsBuffer(before.data(), before.size(), total, cores, online);
+    EXPECT_EQ(3u, cores.size());
+    LinuxMonitor::parseCPUStatsBuffer(after.data(), after.size(), total, cores, online);
+    EXPECT_EQ(2u, cores.size());
+    EXPECT_EQ(2u, online);
+}
+
+TEST_F(LinuxMonitorTest, ParseCPUStats_ZeroesCoresMissingFromTheMiddle) {
+    // With nosmt the siblings cpu1 and cpu3 have no line
+    const std::string all = "cpu  4 4 4 4 4 4 4 4 0 0\ncpu0 1 1 1 1\ncpu1 1 1 1 1\ncpu2 1 1 1 1\ncpu3 1 1 1 1\n";
+    const std::string gaps = "cpu  2 2 2 2 2 2 2 2 0 0\ncpu0 2 2 2 2\ncpu2 3 3 3 3\n";
+    CPUStats total;
+    std::vector<CPUStats> cores;
+    size_t online = 0;
+    LinuxMonitor::parseCPUStatsBuffer(all.data(), all.size(), total, cores, online);
+    EXPECT_EQ(4u, online);
+    LinuxMonitor::parseCPUStatsBuffer(gaps.data(), gaps.size(), total, cores, online);
+    
+    ASSERT_EQ(3u, cores.size());
+    EXPECT_EQ(2u, online);
+    EXPECT_DOUBLE_EQ(2.0, cores[0].user);
+    EXPECT_DOUBLE_EQ(0.0, cores[1].user);
+    EXPECT_DOUBLE_EQ(0.0, cores[1].total);
+    EXPECT_DOUBLE_EQ(3.0, cores[2].user);
+}
+
+TEST_F(LinuxMonitorTest, ParsePressure_SomeAndFull) {
+    const std::string psi =
+        "some avg10=38.75 avg60=62.69 avg300=44.02 total=621475771\n"
+        "full avg10=0.50 avg60=0.05 avg300=0.00 total=1234\n";
+    PressureStats stats;
+    ASSERT_TRUE(LinuxMonitor::parsePressureBuffer(psi.data(), psi.size(), stats));
+    EXPECT_TRUE(stats.available);
+    EXPECT_NEAR(38.75, stats.some.avg10, 1e-9);
+    EXPECT_NEAR(62.69, stats.some.avg60, 1e-9);
+    EXPECT_NEAR(44.02, stats.some.avg300, 1e-9);
+    EXPECT_EQ(621475771u, stats.some.total_us);
+    EXPECT_NEAR(0.5, stats.full.avg10, 1e-9);
+    EXPECT_EQ(1234u, stats.full.total_us);
+}
+
+TEST_F(LinuxMonitorTest, ParsePressure_CpuWithoutFullLine) {
+    // Kernels before 5.13 print no "full" line for cpu
+    const std::string psi = "some avg10=1.00 avg60=2.00 avg300=3.00 total=42\n";
+    PressureStats stats;
+    ASSERT_TRUE(LinuxMonitor::parsePressureBuffer(psi.data(), psi.size(), stats));
+    EXPECT_NEAR(3.0, stats.some.avg300, 1e-9);
+    EXPECT_EQ(0u, stats.full.total_us);
+    
+    EXPECT_FALSE(LinuxMonitor::parsePressureBuffer("", 0, stats));
+    EXPECT_FALSE(stats.available);
+}
+
+TEST_F(LinuxMonitorTest, CgroupPressure_PathsAreRelative) {
+    std::vector<CgroupPressure> groups;
+    if (LinuxMonitor::cgroupRoot().empty() || !LinuxMonitor::readCgroupPressure(groups)) {
+        GTEST_SKIP() << "no cgroup v2 hierarchy with PSI";
+    }
+    for (const auto& group : groups) {
+        EXPECT_FALSE(group.path.empty());
+        EXPECT_NE('/', group.path.front());
+        EXPECT_TRUE(group.cpu.available || group.memory.available);
+    }
+}
+
+TEST_F(LinuxMonitorTest, ParseCgroup_PicksUnifiedEntry) {
+    const std::string hybrid =
+        "9:name=systemd:/\n"
+        "4:memory:/docker/abc\n"
+        "0::/system.slice/docker-abc.scope\n";
+    EXPECT_EQ("/system.slice/docker-abc.scope",
+              LinuxMonitor::parseCgroupBuffer(hybrid.data(), hybrid.size()));
+    
+    const std::string root = "0::/\n";
+    EXPECT_EQ("/", LinuxMonitor::parseCgroupBuffer(root.data(), root.size()));
+    
+    const std::string v1_only = "4:memory:/docker/abc\n";
+    EXPECT_EQ("", LinuxMonitor::parseCgroupBuffer(v1_only.data(), v1_only.size()));
+}
+
+TEST_F(LinuxMonitorTest, ScanProcesses_StatOnlyReadsOneFile) {
+    std::vector<int> pids = LinuxMonitor::listPids();
+    LinuxMonitor::beginScanTick();
+    LinuxMonitor::scanProcesses(pids, nullptr, LinuxMonitor::ScanDepth::Full);
+    LinuxMonitor::endScanTick(0);
+    
+    LinuxMonitor::beginScanTick();
+    auto before = LinuxMonitor::getProcReadStats();
+    auto processes = LinuxMonitor::scanProcesses(pids, nullptr, LinuxMonitor::ScanDepth::StatOnly);
+    auto after = LinuxMonitor::getProcReadStats();
+    // Idle allowance keeps the status and io fds that were not read this tick
+    LinuxMonitor::endScanTick(1);
+    
+    ASSERT_FALSE(processes.empty());
+    for (const auto& proc : processes) {
+        EXPECT_GT(proc.pid, 0);
+        EXPECT_FALSE(proc.name.empty());
+        EXPECT_EQ(0u, proc.memory_bytes);
+        EXPECT_FALSE(proc.io_available);
+    }
+    double per_process = static_cast<double>(after.syscalls() - before.syscalls()) / processes.size();
+    EXPECT_LT(per_process, 1.5);
+}
+
+TEST_F(LinuxMonitorTest, ParseSmapsRollup_SumsPrivatePages) {
+    const std::string rollup =
+        "55d0c8a00000-7ffd9b5fe000 ---p 00000000 00:00 0                          [rollup]\n"
+        "Rss:               10240 kB\n"
+        "Pss:                4096 kB\n"
+        "Pss_Anon:           2048 kB\n"
+        "Pss_File:           2048 kB\n"
+        "Shared_Clean:       6144 kB\n"
+        "Shared_Dirty:        512 kB\n"
+        "Private_Clean:      1024 kB\n"
+        "Private_Dirty:      2560 kB\n"
+        "Swap:                300 kB\n"
+        "SwapPss:             100 kB\n";
+    MemoryFootprint footprint;
+    ASSERT_TRUE(LinuxMonitor::parseSmapsRollupBuffer(rollup.data(), rollup.size(), footprint));
+    
+    EXPECT_EQ(10240u * 1024, footprint.rss);
+    EXPECT_EQ(4096u * 1024, footprint.pss);
+    EXPECT_EQ((1024u + 2560u) * 1024, footprint.uss);
+    EXPECT_EQ(300u * 1024, footprint.swap);
+    EXPECT_EQ(100u * 1024, footprint.swap_pss);
+}
+
+TEST_F(LinuxMonitorTest, ReadSmapsRollup_Self) {
+    if (access("/proc/self/smaps_rollup", R_OK) != 0) {
+        GTEST_SKIP() << "kernel without smaps_rollup";
+    }
+    MemoryFootprint footprint;
+    ASSERT_TRUE(LinuxMonitor::readSmapsRollup(static_cast<int>(getpid()), footprint));
+    EXPECT_GT(footprint.pss, 0u);
+    EXPECT_GT(footprint.uss, 0u);
+    EXPECT_LE(footprint.uss, footprint.pss);
+    EXPECT_LE(footprint.pss, footprint.rss);
+}
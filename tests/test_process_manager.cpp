@@ -12,6 +12,10 @@ protected:
         p1.cpu_percent = 15.5;
         p1.memory_percent = 5.2;
         p1.memory_bytes = 1024 * 1024 * 500; // 500 MB
+        p1.io_read_rate = 1000.0;
+        p1.io_write_rate = 50.0;
+        p1.io_syscr_rate = 40.0;
+        p1.io_syscw_rate = 2.0;
         
         ProcessInfo p2;
         p2.pid = 1002;
@@ -19,6 +23,10 @@ protected:
         p2.cpu_percent = 8.3;
         p2.memory_percent = 3.1;
         p2.memory_bytes = 1024 * 1024 * 300; // 300 MB
+        p2.io_read_rate = 10.0;
+        p2.io_write_rate = 4000.0;
+        p2.io_syscr_rate = 5.0;
+        p2.io_syscw_rate = 300.0;
         
         ProcessInfo p3;
         p3.pid = 1003;
@@ -26,6 +34,10 @@ protected:
         p3.cpu_percent = 2.1;
         p3.memory_percent = 1.5;
         p3.memory_bytes = 1024 * 1024 * 150; // 150 MB
+        p3.io_read_rate = 200.0;
+        p3.io_write_rate = 0.0;
+        p3.io_syscr_rate = 900.0;
+        p3.io_syscw_rate = 0.0;
         
         processes_ = {p1, p2, p3};
     }
@@ -96,3 +108,134 @@ TEST_F(ProcessManagerTest, SortProcesses_ByName) {
     EXPECT_LE(sorted[1].name, sorted[2].name);
 }
 
+TEST_F(ProcessManagerTest, SortProcesses_ByIORead) {
+    auto sorted = processes_;
+    manager_.sortProcesses(sorted, ProcessManager::SortBy::IO_READ, true);
+    
+    EXPECT_EQ("chromium", sorted[0].name);
+    EXPECT_EQ("code", sorted[1].name);
+    EXPECT_EQ("firefox", sorted[2].name);
+}
+
+TEST_F(ProcessManagerTest, SortProcesses_ByIOWrite) {
+    auto sorted = processes_;
+    manager_.sortProcesses(sorted, ProcessManager::SortBy::IO_WRITE, true);
+    
+    EXPECT_EQ("firefox", sorted[0].name);
+    EXPECT_EQ("code", sorted[2].name);
+}
+
+TEST_F(ProcessManagerTest, SortProcesses_BySyscallRates) {
+    auto sorted = processes_;
+    manager_.sortProcesses(sorted, ProcessManager::SortBy::IO_SYSCR, true);
+    EXPECT_EQ("code", sorted[0].name);
+    EXPECT_EQ("firefox", sorted[2].name);
+    
+    manager_.sortProcesses(sorted, ProcessManager::SortBy::IO_SYSCW, true);
+    EXPECT_EQ("firefox", sorted[0].name);
+    EXPECT_EQ("chromium", sorted[1].name);
+}
+
+TEST_F(ProcessManagerTest, SortProcesses_ByIOTotal) {
+    auto sorted = processes_;
+    manager_.sortProcesses(sorted, ProcessManager::SortBy::IO_TOTAL, false);
+    
+    EXPECT_EQ("code", sorted[0].name);
+    EXPECT_EQ("chromium", sorted[1].name);
+    EXPECT_EQ("firefox", sorted[2].name);
+}
+
+TEST_F(ProcessManagerTest, SortRows_MatchesSortProcesses) {
+    StringPool strings;
+    ProcessTable table;
+    for (const auto& proc : processes_) {
+        table.append(proc, strings);
+    }
+    
+    using SortBy = ProcessManager::SortBy;
+    for (SortBy criteria : {SortBy::CPU, SortBy::MEMORY, SortBy::PID, SortBy::NAME,
+                            SortBy::IO_READ, SortBy::IO_WRITE, SortBy::IO_TOTAL, SortBy::IO_SYSCR,
+                            SortBy::IO_SYSCW}) {
+        for (bool descending : {true, false}) {
+            auto sorted = processes_;
+            manager_.sortProcesses(sorted, criteria, descending);
+            std::vector<uint32_t> order;
+            manager_.sortRows(table, strings, criteria, descending, order);
+            
+            ASSERT_EQ(sorted.size(), order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                EXPECT_EQ(sorted[i].pid, table.pid[order[i]]) << ProcessManager::sortName(criteria);
+            }
+        }
+    }
+    // The table itself stays in its original order
+    EXPECT_EQ(1001, table.pid[0]);
+}
+
+TEST_F(ProcessManagerTest, FilterRows_MatchesFilterProcesses) {
+    StringPool strings;
+    ProcessTable table;
+    for (const auto& proc : processes_) {
+        table.append(proc, strings);
+    }
+    // Two processes sharing a name are scored once and both kept
+    ProcessInfo twin = processes_[0];
+    twin.pid = 1004;
+    table.append(twin, strings);
+    
+    std::vector<uint32_t> order;
+    manager_.filterRows(table, strings, "chr", order);
+    ASSERT_EQ(2u, order.size());
+    EXPECT_EQ(1001, table.pid[order[0]]);
+    EXPECT_EQ(1004, table.pid[order[1]]);
+    
+    manager_.filterRows(table, strings, "nonexistent", order);
+    EXPECT_TRUE(order.empty());
+    
+    manager_.filterRows(table, strings, "", order);
+    EXPECT_EQ(table.size(), order.size());
+}
+
+TEST_F(ProcessManagerTest, FilterRows_EqualScoresBusiestFirst) {
+    // 200 workers of one pool, in the PID order the monitor hands over,
+    // with the busiest at the highest PIDs
+    StringPool strings;
+    ProcessTable table;
+    for (int i = 0; i < 200; ++i) {
+        ProcessInfo worker;
+        worker.pid = 5000 + i;
+        worker.name = "php-fpm";
+        worker.cpu_percent = i < 190 ? 0.0 : static_cast<double>(i - 189);
+        worker.memory_percent = i == 10 ? 2.0 : 1.0;
+        table.append(worker, strings);
+    }
+    
+    std::vector<uint32_t> order;
+    manager_.filterRows(table, strings, "php", order);
+    ASSERT_EQ(200u, order.size());
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(5199 - static_cast<int>(i), table.pid[order[i]]);
+    }
+    // Among idle workers the larger one leads, then PIDs ascend
+    EXPECT_EQ(5010, table.pid[order[10]]);
+    EXPECT_EQ(5000, table.pid[order[11]]);
+}
+
+TEST_F(ProcessManagerTest, SortRows_CPUTiesBreakOnMemory) {
+    StringPool strings;
+    ProcessTable table;
+    for (int i = 0; i < 3; ++i) {
+        ProcessInfo proc;
+        proc.pid = 100 + i;
+        proc.name = "idle";
+        proc.memory_percent = static_cast<double>(i);
+        table.append(proc, strings);
+    }
+    
+    std::vector<uint32_t> order;
+    manager_.sortRows(table, strings, ProcessManager::SortBy::CPU, true, order);
+    ASSERT_EQ(3u, order.size());
+    EXPECT_EQ(102, table.pid[order[0]]);
+    EXPECT_EQ(101, table.pid[order[1]]);
+    EXPECT_EQ(100, table.pid[order[2]]);
+}
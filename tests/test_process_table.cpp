@@ -0,0 +1,281 @@
+#include <gtest/gtest.h>
+#include "process_table.hpp"
+#include <algorithm>
+#include <string>
+
+class ProcessTableTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+    
+    static ProcessInfo makeProcess(int pid, const std::string& name, const std::string& user) {
+        ProcessInfo proc;
+        proc.pid = pid;
+        proc.ppid = 1;
+        proc.name = name;
+        proc.user = user;
+        proc.state = 'S';
+        proc.cpu_percent = pid * 0.5;
+        proc.memory_bytes = static_cast<uint64_t>(pid) * 4096;
+        return proc;
+    }
+};
+
+TEST_F(ProcessTableTest, StringPool_InternsOnce) {
+    StringPool pool;
+    EXPECT_EQ(0u, pool.intern(""));
+    EXPECT_EQ("", pool.get(0));
+    
+    const StringPool::Id bash = pool.intern("bash");
+    const StringPool::Id root = pool.intern("root");
+    EXPECT_NE(bash, root);
+    EXPECT_EQ(bash, pool.intern(std::string("bash")));
+    EXPECT_EQ("bash", pool.get(bash));
+    EXPECT_EQ(3u, pool.size());
+}
+
+TEST_F(ProcessTableTest, StringPool_ReferencesSurviveGrowth) {
+    StringPool pool;
+    const std::string& first = pool.get(pool.intern("a-name-longer-than-small-string-buffer"));
+    for (int i = 0; i < 10000; ++i) {
+        pool.intern("name-" + std::to_string(i));
+    }
+    EXPECT_EQ("a-name-longer-than-small-string-buffer", first);
+    EXPECT_EQ(1u, pool.intern("a-name-longer-than-small-string-buffer"));
+}
+
+TEST_F(ProcessTableTest, StringPool_SyncCopiesOnlyNewStrings) {
+    StringPool source;
+    StringPool replica;
+    const StringPool::Id sshd = source.intern("sshd");
+    replica.syncFrom(source);
+    EXPECT_EQ("sshd", replica.get(sshd));
+    
+    const StringPool::Id nginx = source.intern("nginx");
+    replica.syncFrom(source);
+    EXPECT_EQ(source.size(), replica.size());
+    EXPECT_EQ("nginx", replica.get(nginx));
+    // The replica's index finds synced strings under the source's IDs
+    EXPECT_EQ(sshd, replica.intern("sshd"));
+}
+
+TEST_F(ProcessTableTest, StringPool_KeepsLowercaseCopy) {
+    StringPool source;
+    const StringPool::Id name = source.intern("NetworkManager");
+    const StringPool::Id other = source.intern("Xorg-1.20_\xc3\x89");
+    EXPECT_EQ("NetworkManager", source.get(name));
+    EXPECT_EQ("networkmanager", source.lower(name));
+    // ASCII only; other bytes are left alone
+    EXPECT_EQ("xorg-1.20_\xc3\x89", source.lower(other));
+    
+    StringPool replica;
+    replica.syncFrom(source);
+    EXPECT_EQ("networkmanager", replica.lower(name));
+    EXPECT_EQ("", replica.lower(0));
+}
+
+TEST_F(ProcessTableTest, StringPool_CompactKeepsLiveStrings) {
+    StringPool pool;
+    ProcessTable table;
+    table.append(makeProcess(10, "gone", "nobody"), pool);
+    table.append(makeProcess(20, "Sshd", "root"), pool);
+    table.append(makeProcess(30, "exited", "root"), pool);
+    table.append(makeProcess(40, "bash", "root"), pool);
+    const uint64_t generation = pool.generation();
+    
+    // Only PIDs 20 and 40 are still running
+    ProcessTable live;
+    live.append(makeProcess(20, "Sshd", "root"), pool);
+    live.append(makeProcess(40, "bash", "root"), pool);
+    std::vector<uint8_t> flags(pool.size(), 0);
+    for (size_t row = 0; row < live.size(); ++row) {
+        flags[live.name[row]] = flags[live.user[row]] = 1;
+    }
+    std::vector<StringPool::Id> remap;
+    pool.compact(flags, remap);
+    live.remapStrings(remap);
+    
+    EXPECT_EQ(4u, pool.size());
+    EXPECT_NE(generation, pool.generation());
+    EXPECT_EQ("", pool.get(0));
+    EXPECT_EQ("Sshd", pool.get(live.name[0]));
+    EXPECT_EQ("sshd", pool.lower(live.name[0]));
+    EXPECT_EQ("root", pool.get(live.user[1]));
+    EXPECT_EQ("bash", pool.get(live.name[1]));
+    // The index points at the moved strings; dropped ones intern afresh
+    EXPECT_EQ(live.name[1], pool.intern("bash"));
+    EXPECT_EQ(4u, pool.intern("gone"));
+}
+
+TEST_F(ProcessTableTest, StringPool_ReplicaResyncsAfterCompact) {
+    StringPool source;
+    StringPool replica;
+    for (int i = 0; i < 100; ++i) {
+        source.intern("short-lived-" + std::to_string(i));
+    }
+    const StringPool::Id kept = source.intern("systemd");
+    replica.syncFrom(source);
+    
+    std::vector<uint8_t> flags(source.size(), 0);
+    flags[kept] = 1;
+    std::vector<StringPool::Id> remap;
+    source.compact(flags, remap);
+    const StringPool::Id added = source.intern("cron");
+    replica.syncFrom(source);
+    
+    EXPECT_EQ(source.size(), replica.size());
+    EXPECT_EQ(source.generation(), replica.generation());
+    EXPECT_EQ("systemd", replica.get(remap[kept]));
+    EXPECT_EQ("cron", replica.get(added));
+    EXPECT_EQ(added, replica.intern("cron"));
+}
+
+TEST_F(ProcessTableTest, Append_FillsEveryColumn) {
+    StringPool pool;
+    ProcessTable table;
+    ProcessInfo proc = makeProcess(42, "postgres", "postgres");
+    proc.io_available = true;
+    proc.io_read_rate = 100.0;
+    proc.io_syscr_rate = 25.0;
+    proc.io_syscw_rate = 5.0;
+    proc.sample_age = 2;
+    table.append(proc, pool);
+    table.append(makeProcess(43, "postgres", "root"), pool);
+    
+    ASSERT_EQ(2u, table.size());
+    EXPECT_EQ(42, table.pid[0]);
+    EXPECT_EQ(1, table.ppid[0]);
+    EXPECT_EQ('S', table.state[0]);
+    EXPECT_EQ("postgres", pool.get(table.name[0]));
+    EXPECT_EQ(table.name[0], table.name[1]);
+    EXPECT_EQ(table.name[0], table.user[0]);
+    EXPECT_EQ("root", pool.get(table.user[1]));
+    EXPECT_EQ(1, table.io_available[0]);
+    EXPECT_DOUBLE_EQ(100.0, table.io_read_rate[0]);
+    EXPECT_DOUBLE_EQ(25.0, table.io_syscr_rate[0]);
+    EXPECT_DOUBLE_EQ(5.0, table.io_syscw_rate[0]);
+    EXPECT_EQ(2u, table.sample_age[0]);
+    EXPECT_LT(table.footprint_age[0], 0.0);
+}
+
+TEST_F(ProcessTableTest, ReassignReusesCapacity) {
+    StringPool pool;
+    ProcessTable source;
+    for (int pid = 1; pid <= 500; ++pid) {
+        source.append(makeProcess(pid, "worker", "www-data"), pool);
+    }
+    ProcessTable copy;
+    copy = source;
+    const int* pids = copy.pid.data();
+    const double* cpu = copy.cpu_percent.data();
+    
+    // Next tick: rebuild the source in place and hand it over again
+    source.clear();
+    EXPECT_GE(source.pid.capacity(), 500u);
+    for (int pid = 2; pid <= 500; ++pid) {
+        source.append(makeProcess(pid, "worker", "www-data"), pool);
+    }
+    copy = source;
+    EXPECT_EQ(499u, copy.size());
+    EXPECT_EQ(pids, copy.pid.data());
+    EXPECT_EQ(cpu, copy.cpu_percent.data());
+    EXPECT_EQ(3u, pool.size());
+}
+
+TEST_F(ProcessTableTest, Delta_ClassifiesAddedRemovedChanged) {
+    StringPool pool;
+    ProcessTable before;
+    ProcessTable after;
+    for (int pid : {1, 2, 3, 5}) {
+        before.append(makeProcess(pid, "svc", "root"), pool);
+    }
+    after.append(makeProcess(1, "svc", "root"), pool);
+    ProcessInfo busy = makeProcess(3, "svc", "root");
+    busy.cpu_percent = 50.0;
+    busy.state = 'R';
+    after.append(busy, pool);
+    after.append(makeProcess(4, "svc", "root"), pool);
+    after.append(makeProcess(5, "svc", "root"), pool);
+    
+    ProcessDelta delta;
+    delta.compute(before, after);
+    EXPECT_EQ((std::vector<uint32_t>{2}), delta.added); // row of PID 4
+    EXPECT_EQ((std::vector<int>{2}), delta.removed);
+    ASSERT_EQ(1u, delta.changed.size());
+    EXPECT_EQ(3, after.pid[delta.changed[0]]);
+    EXPECT_EQ(kFieldCPU | kFieldState, delta.changed_fields[0]);
+    EXPECT_EQ(2u, delta.unchanged);
+}
+
+TEST_F(ProcessTableTest, Delta_ReusedPidIsRemovedAndAdded) {
+    StringPool pool;
+    ProcessTable before;
+    ProcessTable after;
+    ProcessInfo old_proc = makeProcess(7, "job", "root");
+    old_proc.start_time = 100;
+    before.append(old_proc, pool);
+    ProcessInfo new_proc = makeProcess(7, "job", "root");
+    new_proc.start_time = 200;
+    after.append(new_proc, pool);
+    
+    ProcessDelta delta;
+    delta.compute(before, after);
+    EXPECT_EQ((std::vector<int>{7}), delta.removed);
+    EXPECT_EQ((std::vector<uint32_t>{0}), delta.added);
+    EXPECT_TRUE(delta.changed.empty());
+}
+
+TEST_F(ProcessTableTest, Delta_AgesAloneAreNotChanges) {
+    StringPool pool;
+    ProcessTable before;
+    ProcessTable after;
+    ProcessInfo proc = makeProcess(9, "idle", "root");
+    proc.sample_age = 1;
+    proc.footprint_available = true;
+    proc.footprint_age = 1.0;
+    before.append(proc, pool);
+    proc.sample_age = 2;
+    proc.footprint_age = 2.0;
+    after.append(proc, pool);
+    
+    ProcessDelta delta;
+    delta.compute(before, after);
+    EXPECT_EQ(0u, delta.size());
+    
+    // Going fresh again is a change
+    after.clear();
+    proc.sample_age = 0;
+    after.append(proc, pool);
+    delta.compute(before, after);
+    ASSERT_EQ(1u, delta.changed.size());
+    EXPECT_EQ(kFieldStale, delta.changed_fields[0]);
+}
+
+TEST_F(ProcessTableTest, Delta_SizeFollowsChurnNotProcessCount) {
+    // The same churn over 1k and 50k processes: 10 exits, 10 spawns, 5 changes
+    for (int count : {1000, 50000}) {
+        StringPool pool;
+        ProcessTable before;
+        ProcessTable after;
+        for (int pid = 1; pid <= count; ++pid) {
+            before.append(makeProcess(pid, "worker", "www-data"), pool);
+        }
+        for (int pid = 11; pid <= count + 10; ++pid) {
+            ProcessInfo proc = makeProcess(pid, "worker", "www-data");
+            if (pid % (count / 5) == 0) {
+                proc.memory_bytes += 4096;
+            }
+            after.append(proc, pool);
+        }
+        
+        ProcessDelta delta;
+        delta.compute(before, after);
+        EXPECT_EQ(10u, delta.removed.size()) << count;
+        EXPECT_EQ(10u, delta.added.size()) << count;
+        EXPECT_EQ(5u, delta.changed.size()) << count;
+        EXPECT_EQ(25u, delta.size()) << count;
+        EXPECT_EQ(static_cast<size_t>(count) - 15, delta.unchanged) << count;
+        EXPECT_TRUE(std::all_of(delta.changed_fields.begin(), delta.changed_fields.end(),
+                                [](uint32_t fields) { return fields == kFieldMemory; }));
+    }
+}
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+#include "process_tree.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+class ProcessTreeTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+    
+    static ProcessInfo makeProcess(int pid, int ppid, double cpu = 0, uint64_t memory = 0, uint64_t start_time = 1) {
+        ProcessInfo proc;
+        proc.pid = pid;
+        proc.ppid = ppid;
+        proc.cpu_percent = cpu;
+        proc.memory_bytes = memory;
+        proc.start_time = start_time;
+        return proc;
+    }
+    
+    // 1 -> {2 -> {4, 5}, 3}
+    static std::vector<ProcessInfo> sampleTree() {
+        return {
+            makeProcess(1, 0, 1.0, 100),
+            makeProcess(2, 1, 2.0, 200),
+            makeProcess(3, 1, 3.0, 300),
+            makeProcess(4, 2, 4.0, 400),
+            makeProcess(5, 2, 5.0, 500),
+        };
+    }
+};
+
+TEST_F(ProcessTreeTest, BuildsHierarchyWithSubtreeTotals) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    
+    EXPECT_EQ(5u, tree.size());
+    EXPECT_EQ(1u, tree.rootCount());
+    const ProcessTree::Node* root = tree.find(1);
+    ASSERT_NE(nullptr, root);
+    EXPECT_DOUBLE_EQ(15.0, root->subtree_cpu);
+    EXPECT_EQ(1500u, root->subtree_memory);
+    EXPECT_EQ(5u, root->subtree_count);
+    
+    const ProcessTree::Node* middle = tree.find(2);
+    ASSERT_NE(nullptr, middle);
+    EXPECT_DOUBLE_EQ(11.0, middle->subtree_cpu);
+    EXPECT_EQ(3u, middle->subtree_count);
+    EXPECT_EQ(1, middle->parent);
+}
+
+TEST_F(ProcessTreeTest, UnchangedTickRecomputesNothing) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    tree.update(sampleTree());
+    
+    const auto& stats = tree.getLastUpdate();
+    EXPECT_EQ(0u, stats.added);
+    EXPECT_EQ(0u, stats.removed);
+    EXPECT_EQ(0u, stats.reparented);
+    EXPECT_EQ(0u, stats.recomputed);
+}
+
+TEST_F(ProcessTreeTest, ChangedLeafRecomputesOnlyItsPath) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    
+    auto processes = sampleTree();
+    processes[3].cpu_percent = 14.0; // pid 4
+    tree.update(processes);
+    
+    // 4, 2 and 1; 3 and 5 keep their totals
+    EXPECT_EQ(3u, tree.getLastUpdate().recomputed);
+    EXPECT_DOUBLE_EQ(25.0, tree.find(1)->subtree_cpu);
+    EXPECT_DOUBLE_EQ(21.0, tree.find(2)->subtree_cpu);
+}
+
+TEST_F(ProcessTreeTest, ExitedParentChildrenMoveToNewParent) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    
+    // 2 exits; the kernel hands 4 and 5 to init
+    auto processes = sampleTree();
+    processes.erase(processes.begin() + 1);
+    for (auto& proc : processes) {
+        if (proc.ppid == 2) {
+            proc.ppid = 1;
+        }
+    }
+    tree.update(processes);
+    
+    const auto& stats = tree.getLastUpdate();
+    EXPECT_EQ(1u, stats.removed);
+    EXPECT_EQ(2u, stats.reparented);
+    EXPECT_EQ(nullptr, tree.find(2));
+    EXPECT_EQ(1u, tree.rootCount());
+    EXPECT_EQ(1, tree.find(4)->parent);
+    EXPECT_DOUBLE_EQ(13.0, tree.find(1)->subtree_cpu);
+    EXPECT_EQ(4u, tree.find(1)->subtree_count);
+}
+
+TEST_F(ProcessTreeTest, ChildListedBeforeParentIsLinked) {
+    ProcessTree tree;
+    tree.update({makeProcess(1, 0)});
+    tree.update({makeProcess(9, 8, 2.0), makeProcess(1, 0), makeProcess(8, 1, 1.0)});
+    
+    EXPECT_EQ(1u, tree.rootCount());
+    EXPECT_EQ(8, tree.find(9)->parent);
+    EXPECT_DOUBLE_EQ(3.0, tree.find(1)->subtree_cpu);
+}
+
+TEST_F(ProcessTreeTest, OrphanIsAdoptedWhenParentAppears) {
+    ProcessTree tree;
+    tree.update({makeProcess(1, 0), makeProcess(7, 6, 1.0)});
+    EXPECT_EQ(2u, tree.rootCount());
+    
+    tree.update({makeProcess(1, 0), makeProcess(7, 6, 1.0), makeProcess(6, 1)});
+    EXPECT_EQ(1u, tree.rootCount());
+    EXPECT_EQ(6, tree.find(7)->parent);
+    EXPECT_EQ(3u, tree.find(1)->subtree_count);
+}
+
+TEST_F(ProcessTreeTest, ReusedPidIsANewNode) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    
+    // PID 2 exited and was reused at once by a fresh child of 3
+    auto processes = sampleTree();
+    processes[1] = makeProcess(2, 3, 0.5, 50, 99);
+    processes[3].ppid = 1;
+    processes[4].ppid = 1;
+    tree.update(processes);
+    
+    EXPECT_EQ(3, tree.find(2)->parent);
+    EXPECT_EQ(99u, tree.find(2)->start_time);
+    EXPECT_TRUE(tree.find(2)->children.empty());
+    EXPECT_DOUBLE_EQ(3.5, tree.find(3)->subtree_cpu);
+    EXPECT_DOUBLE_EQ(13.5, tree.find(1)->subtree_cpu);
+}
+
+TEST_F(ProcessTreeTest, FlattenSkipsCollapsedDescendants) {
+    ProcessTree tree;
+    tree.update(sampleTree());
+    
+    std::vector<ProcessTreeRow> rows;
+    tree.flatten({}, rows);
+    ASSERT_EQ(5u, rows.size());
+    // Busiest subtree first: 2 (11%) before 3 (3%), then 5 before 4
+    std::vector<int> order;
+    for (const auto& row : rows) {
+        order.push_back(row.pid);
+    }
+    EXPECT_EQ((std::vector<int>{1, 2, 5, 4, 3}), order);
+    EXPECT_EQ(2, rows[2].depth);
+    
+    tree.flatten({2}, rows);
+    ASSERT_EQ(3u, rows.size());
+    EXPECT_EQ(2, rows[1].pid);
+    EXPECT_TRUE(rows[1].collapsed);
+    EXPECT_EQ(3u, rows[1].subtree_count);
+    EXPECT_DOUBLE_EQ(11.0, rows[1].subtree_cpu);
+    EXPECT_EQ(3, rows[2].pid);
+}
+
+TEST_F(ProcessTreeTest, IncrementalTotalsMatchFullRebuild) {
+    std::mt19937 rng(42);
+    std::map<int, ProcessInfo> live;
+    live[1] = makeProcess(1, 0, 1.0, 10);
+    int next_pid = 2;
+    ProcessTree tree;
+    
+    for (int tick = 0; tick < 200; ++tick) {
+        // Fork a few, exit a few, and let some CPU and memory move
+        for (int i = 0; i < 3; ++i) {
+            auto parent = std::next(live.begin(), rng() % live.size());
+            live[next_pid] = makeProcess(next_pid, parent->first, rng() % 10, rng() % 1000);
+            ++next_pid;
+        }
+        for (int i = 0; i < 2 && live.size() > 1; ++i) {
+            auto victim = std::next(live.begin(), 1 + rng() % (live.size() - 1));
+            const int pid = victim->first;
+            const int ppid = victim->second.ppid;
+            live.erase(victim);
+            for (auto& [child_pid, child] : live) {
+                if (child.ppid == pid) {
+                    child.ppid = ppid;
+                }
+            }
+        }
+        for (auto& [pid, proc] : live) {
+            if (rng() % 4 == 0) {
+                proc.cpu_percent = rng() % 10;
+            }
+        }
+        
+        std::vector<ProcessInfo> processes;
+        for (const auto& [pid, proc] : live) {
+            processes.push_back(proc);
+        }
+        std::shuffle(processes.begin(), processes.end(), rng);
+        tree.update(processes);
+    }
+    
+    // Recompute every subtree from scratch and compare
+    std::map<int, double> expected_cpu;
+    std::map<int, uint64_t> expected_memory;
+    for (const auto& [pid, proc] : live) {
+        for (int ancestor = pid; ancestor != 0; ancestor = live.at(ancestor).ppid) {
+            expected_cpu[ancestor] += proc.cpu_percent;
+            expected_memory[ancestor] += proc.memory_bytes;
+        }
+    }
+    ASSERT_EQ(live.size(), tree.size());
+    EXPECT_EQ(1u, tree.rootCount());
+    for (const auto& [pid, proc] : live) {
+        const ProcessTree::Node* node = tree.find(pid);
+        ASSERT_NE(nullptr, node);
+        EXPECT_NEAR(expected_cpu[pid], node->subtree_cpu, 1e-9) << "pid " << pid;
+        EXPECT_EQ(expected_memory[pid], node->subtree_memory) << "pid " << pid;
+    }
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "smaps_sampler.hpp"
+#include "linux_monitor.hpp"
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+
+class SmapsSamplerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (access("/proc/self/smaps_rollup", R_OK) != 0) {
+            GTEST_SKIP() << "kernel without smaps_rollup";
+        }
+        self_ = static_cast<int>(getpid());
+        self_start_ = LinuxMonitor::parseProcessStat(self_).start_time;
+    }
+    void TearDown() override {}
+    
+    // Polls collect() until a result for pid shows up or the deadline passes
+    static bool waitForResult(const SmapsSampler& sampler, int pid, SmapsSampler::Result& out) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        std::vector<SmapsSampler::Result> results;
+        while (std::chrono::steady_clock::now() < deadline) {
+            sampler.collect(results);
+            for (const auto& result : results) {
+                if (result.pid == pid) {
+                    out = result;
+                    return true;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return false;
+    }
+    
+    int self_;
+    uint64_t self_start_;
+};
+
+TEST_F(SmapsSamplerTest, ReadsRequestedPid) {
+    SmapsSampler sampler(100, std::chrono::seconds(5));
+    sampler.request({{self_, self_start_}});
+    
+    SmapsSampler::Result result;
+    ASSERT_TRUE(waitForResult(sampler, self_, result));
+    EXPECT_EQ(self_start_, result.start_time);
+    EXPECT_GT(result.footprint.pss, 0u);
+    EXPECT_LE(result.sampled_at, std::chrono::steady_clock::now());
+}
+
+TEST_F(SmapsSamplerTest, IdleWithoutRequests) {
+    SmapsSampler sampler(100, std::chrono::seconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0u, sampler.getReadCount());
+}
+
+TEST_F(SmapsSamplerTest, CachedResultIsNotReread) {
+    SmapsSampler sampler(100, std::chrono::seconds(30));
+    sampler.request({{self_, self_start_}});
+    SmapsSampler::Result result;
+    ASSERT_TRUE(waitForResult(sampler, self_, result));
+    
+    // Re-requesting within the refresh interval is served from the cache
+    for (int i = 0; i < 5; ++i) {
+        sampler.request({{self_, self_start_}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(1u, sampler.getReadCount());
+}
+
+TEST_F(SmapsSamplerTest, RateLimitSpacesReads) {
+    // A zero refresh interval makes the PID due again immediately, so only
+    // the rate limit holds the lane back
+    SmapsSampler sampler(20, std::chrono::seconds(0));
+    sampler.request({{self_, self_start_}});
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    
+    // 20/s over 0.3 s: about 7 reads, never hundreds
+    EXPECT_GE(sampler.getReadCount(), 1u);
+    EXPECT_LE(sampler.getReadCount(), 9u);
+}
+
+TEST_F(SmapsSamplerTest, StartTimeMismatchIsNotReported) {
+    SmapsSampler sampler(100, std::chrono::seconds(30));
+    sampler.request({{self_, self_start_}});
+    SmapsSampler::Result result;
+    ASSERT_TRUE(waitForResult(sampler, self_, result));
+    
+    // Same PID, different process: the cached footprint must not be served
+    sampler.request({{self_, self_start_ + 1}});
+    std::vector<SmapsSampler::Result> results;
+    sampler.collect(results);
+    EXPECT_TRUE(results.empty());
+}
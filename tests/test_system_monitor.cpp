@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 #include "system_monitor.hpp"
+#include "snapshot.hpp"
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
 
 class SystemMonitorTest : public ::testing::Test {
 protected:
@@ -71,3 +78,458 @@ TEST_F(SystemMonitorTest, Processes_HaveValidData) {
     }
 }
 
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, ProcessCPU_TracksBusyProcess) {
+    monitor_->update();
+    
+    // Burn CPU on this thread so our own PID shows a non-zero delta
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+    volatile uint64_t sink = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        sink = sink + 1;
+    }
+    monitor_->update();
+    
+    const int self = static_cast<int>(getpid());
+    const double max_percent = 100.0 * std::max(1u, std::thread::hardware_concurrency());
+    bool found = false;
+    for (const auto& proc : monitor_->getProcesses()) {
+        EXPECT_GE(proc.cpu_percent, 0.0);
+        EXPECT_LE(proc.cpu_percent, max_percent);
+        if (proc.pid == self) {
+            found = true;
+            EXPECT_GT(proc.cpu_percent, 0.0);
+            EXPECT_GT(proc.start_time, 0u);
+        }
+    }
+    EXPECT_TRUE(found);
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, ProcessDiscovery_FallsBackToReaddir) {
+    MonitorOptions options;
+    options.use_proc_connector = false;
+    SystemMonitor monitor(options);
+    monitor.update();
+    
+    EXPECT_FALSE(monitor.isEventDriven());
+    EXPECT_EQ(2u, monitor.getReaddirPasses());
+    EXPECT_EQ(0u, monitor.getReaddirPassesAvoided());
+}
+
+TEST_F(SystemMonitorTest, ProcessDiscovery_EventDrivenCatchesShortLived) {
+    if (!monitor_->isEventDriven()) {
+        GTEST_SKIP() << "proc connector unavailable (needs CAP_NET_ADMIN)";
+    }
+    
+    uint64_t before = monitor_->getShortLivedCount();
+    pid_t child = fork();
+    if (child == 0) {
+        _exit(0);
+    }
+    ASSERT_GT(child, 0);
+    waitpid(child, nullptr, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    monitor_->update();
+    
+    EXPECT_GT(monitor_->getReaddirPassesAvoided(), 0u);
+    EXPECT_EQ(1u, monitor_->getReaddirPasses());
+    EXPECT_GT(monitor_->getShortLivedCount(), before);
+    EXPECT_GE(monitor_->getProcessCount(), 1u);
+}
+
+TEST_F(SystemMonitorTest, ProcessDiscovery_ExitEventsEvictState) {
+    if (!monitor_->isEventDriven()) {
+        GTEST_SKIP() << "proc connector unavailable (needs CAP_NET_ADMIN)";
+    }
+    
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    monitor_->update();
+    EXPECT_EQ(monitor_->getProcessCount(), monitor_->getTrackedProcessCount());
+    
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    monitor_->update();
+    // No readdir pass after the first, so only the exit event evicted it
+    EXPECT_EQ(1u, monitor_->getReaddirPasses());
+    EXPECT_EQ(monitor_->getProcessCount(), monitor_->getTrackedProcessCount());
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, CoreUsage_OneEntryPerCPU) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    monitor_->update();
+    
+    const auto& cores = monitor_->getCoreUsage();
+    ASSERT_GE(cores.size(), 1u);
+    for (double usage : cores) {
+        EXPECT_GE(usage, 0.0);
+        EXPECT_LE(usage, 100.0);
+    }
+    EXPECT_GE(monitor_->getCPUDelta().steal, 0.0);
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, Threads_OnlyScannedWhenExpanded) {
+    const int self = static_cast<int>(getpid());
+    monitor_->update();
+    EXPECT_EQ(nullptr, monitor_->getThreads(self));
+    EXPECT_TRUE(monitor_->getAllThreads().empty());
+    
+    std::atomic<bool> done(false);
+    std::thread busy([&] {
+        volatile uint64_t sink = 0;
+        while (!done) {
+            sink = sink + 1;
+        }
+    });
+    
+    monitor_->setExpandedPids({self});
+    monitor_->update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    monitor_->update();
+    done = true;
+    busy.join();
+    
+    const std::vector<ThreadInfo>* threads = monitor_->getThreads(self);
+    ASSERT_NE(nullptr, threads);
+    ASSERT_GE(threads->size(), 2u);
+    EXPECT_EQ(1u, monitor_->getAllThreads().size());
+    // Sorted by CPU, so the spinning thread leads
+    EXPECT_GT(threads->front().cpu_percent, 0.0);
+    
+    monitor_->setExpandedPids({});
+    monitor_->update();
+    EXPECT_EQ(nullptr, monitor_->getThreads(self));
+}
+
+TEST_F(SystemMonitorTest, Threads_TopNByCPU) {
+    MonitorOptions options;
+    options.thread_top_n = 3;
+    SystemMonitor monitor(options);
+    monitor.update();
+    
+    const auto& processes = monitor.getProcesses();
+    const size_t expected = std::min<size_t>(3, processes.size());
+    EXPECT_LE(monitor.getAllThreads().size(), expected);
+    for (size_t i = 0; i < expected; ++i) {
+        EXPECT_NE(nullptr, monitor.getThreads(processes[i].pid));
+    }
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, ProcessIO_RatesFromDeltas) {
+    // Pinned so the tiered sampler reads our counters on every tick
+    monitor_->setHotPids({static_cast<int>(getpid())});
+    monitor_->update();
+    
+    // Issue read syscalls against /dev/zero so our syscr counter moves
+    int fd = open("/dev/zero", O_RDONLY);
+    ASSERT_GE(fd, 0);
+    char buf[64];
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(static_cast<ssize_t>(sizeof(buf)), read(fd, buf, sizeof(buf)));
+    }
+    close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    monitor_->update();
+    
+    const int self = static_cast<int>(getpid());
+    auto it = std::find_if(monitor_->getProcesses().begin(), monitor_->getProcesses().end(),
+                           [self](const ProcessInfo& p) { return p.pid == self; });
+    ASSERT_NE(monitor_->getProcesses().end(), it);
+    ASSERT_TRUE(it->io_available);
+    EXPECT_GT(it->io_syscr_rate, 0.0);
+    EXPECT_GE(it->io_read_rate, 0.0);
+    EXPECT_GE(it->io_write_rate, 0.0);
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, DiskStats_RatesWithinBounds) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    monitor_->update();
+    
+    for (const auto& disk : monitor_->getDiskStats()) {
+        EXPECT_FALSE(disk.name.empty());
+        EXPECT_FALSE(disk.is_partition);
+        EXPECT_NE(0, disk.name.compare(0, 4, "loop"));
+        EXPECT_GE(disk.read_iops, 0.0);
+        EXPECT_GE(disk.write_bytes_per_sec, 0.0);
+        EXPECT_GE(disk.utilization, 0.0);
+        EXPECT_LE(disk.utilization, 100.0);
+        EXPECT_GE(disk.avg_latency_ms, 0.0);
+    }
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, NetStats_ActiveInterfacesHaveRates) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    monitor_->update();
+    
+    bool found_active = false;
+    for (const auto& iface : monitor_->getNetStats()) {
+        if (!iface.active) {
+            continue;
+        }
+        found_active = true;
+        EXPECT_FALSE(iface.name.empty());
+        EXPECT_GE(iface.rx_bytes_per_sec, 0.0);
+        EXPECT_GE(iface.tx_bytes_per_sec, 0.0);
+        EXPECT_GE(iface.rx_packets_per_sec, 0.0);
+    }
+    EXPECT_TRUE(found_active);
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, Pressure_MatchesKernelSupport) {
+    const bool kernel_psi = access("/proc/pressure/cpu", R_OK) == 0;
+    const SystemPressure& pressure = monitor_->getPressure();
+    EXPECT_EQ(kernel_psi, pressure.cpu.available);
+    if (kernel_psi) {
+        EXPECT_GE(pressure.cpu.some.avg10, 0.0);
+        EXPECT_LE(pressure.cpu.some.avg10, 100.0);
+        EXPECT_TRUE(pressure.memory.available);
+        EXPECT_TRUE(pressure.io.available);
+    }
+}
+#endif
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, Cgroups_MappingReadOnlyForNewPids) {
+    EXPECT_TRUE(monitor_->getCgroupStats().empty());
+    
+    monitor_->setCgroupViewEnabled(true);
+    monitor_->update();
+    const uint64_t first = monitor_->getCgroupLookups();
+    EXPECT_GE(first, monitor_->getProcessCount());
+    
+    monitor_->update();
+    const uint64_t second = monitor_->getCgroupLookups() - first;
+    // Only PIDs born between the two updates are looked up again
+    EXPECT_LT(second, first);
+    
+    size_t members = 0;
+    for (const auto& group : monitor_->getCgroupStats()) {
+        EXPECT_FALSE(group.path.empty());
+        EXPECT_GE(group.cpu_percent, 0.0);
+        members += group.process_count;
+    }
+    EXPECT_LE(members, monitor_->getProcessCount());
+    
+    monitor_->setCgroupViewEnabled(false);
+    monitor_->update();
+    EXPECT_TRUE(monitor_->getCgroupStats().empty());
+}
+#endif
+
+TEST_F(SystemMonitorTest, ProcessTree_OnlyWhileEnabled) {
+    monitor_->update();
+    EXPECT_TRUE(monitor_->getTreeRows().empty());
+    EXPECT_EQ(nullptr, monitor_->getProcessTree());
+    
+    monitor_->setTreeViewEnabled(true);
+    monitor_->update();
+    const auto& rows = monitor_->getTreeRows();
+    EXPECT_EQ(monitor_->getProcessCount(), rows.size());
+    
+    // Our parent is alive, so we sit below it
+    const int self = static_cast<int>(getpid());
+    auto row = std::find_if(rows.begin(), rows.end(), [&](const ProcessTreeRow& r) { return r.pid == self; });
+    ASSERT_NE(rows.end(), row);
+    EXPECT_GT(row->depth, 0);
+    
+    // Folding our parent hides us
+    monitor_->setCollapsedPids({static_cast<int>(getppid())});
+    monitor_->update();
+    const auto& folded = monitor_->getTreeRows();
+    EXPECT_EQ(folded.end(), std::find_if(folded.begin(), folded.end(),
+                                         [&](const ProcessTreeRow& r) { return r.pid == self; }));
+}
+
+TEST_F(SystemMonitorTest, Snapshot_HeldSnapshotIsNotModified) {
+    auto first = monitor_->snapshot();
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ(first->process_count, first->processes.size());
+    EXPECT_EQ(monitor_->getProcessCount(), first->process_count);
+    EXPECT_GT(first->memory.total, 0u);
+    const uint64_t version = first->version;
+    const size_t rows = first->processes.size();
+    
+    monitor_->update();
+    auto second = monitor_->snapshot();
+    EXPECT_EQ(version + 1, second->version);
+    EXPECT_NE(first.get(), second.get());
+    EXPECT_EQ(version, first->version);
+    EXPECT_EQ(rows, first->processes.size());
+    for (size_t row = 0; row < second->processes.size(); ++row) {
+        ASSERT_LT(second->processes.name[row], second->strings.size());
+    }
+}
+
+TEST_F(SystemMonitorTest, Snapshot_ReleasedBuffersAreReused) {
+    const Snapshot* released = monitor_->snapshot().get();
+    // The first update retires the buffer, the second refills it
+    monitor_->update();
+    monitor_->update();
+    EXPECT_EQ(released, monitor_->snapshot().get());
+}
+
+TEST_F(SystemMonitorTest, Snapshot_ReadersRaceTheCollector) {
+    std::atomic<bool> done(false);
+    std::atomic<size_t> inconsistent(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&] {
+            uint64_t last_version = 0;
+            while (!done) {
+                auto snap = monitor_->snapshot();
+                if (snap->version < last_version || snap->process_count != snap->processes.size()) {
+                    ++inconsistent;
+                }
+                // Every name ID must resolve in the snapshot's own pool
+                for (size_t row = 0; row < snap->processes.size(); ++row) {
+                    if (snap->processes.name[row] >= snap->strings.size()) {
+                        ++inconsistent;
+                    }
+                }
+                last_version = snap->version;
+            }
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        monitor_->update();
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0u, inconsistent.load());
+    EXPECT_EQ(21u, monitor_->snapshot()->version);
+}
+
+TEST_F(SystemMonitorTest, Delta_TracksForkAndExit) {
+    MonitorOptions options;
+    options.use_proc_connector = false;
+    SystemMonitor monitor(options);
+    const ProcessTable& table = monitor.getProcessTable();
+    EXPECT_TRUE(std::is_sorted(table.pid.begin(), table.pid.end()));
+    
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    monitor.update();
+    const ProcessDelta& delta = monitor.getProcessDelta();
+    EXPECT_TRUE(std::any_of(delta.added.begin(), delta.added.end(),
+                            [&](uint32_t row) { return table.pid[row] == child; }));
+    // Most processes sat still between the two updates
+    EXPECT_LT(delta.size(), table.size());
+    
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    monitor.update();
+    EXPECT_NE(delta.removed.end(), std::find(delta.removed.begin(), delta.removed.end(), child));
+    EXPECT_EQ(monitor.getProcessCount(), delta.added.size() + delta.changed.size() + delta.unchanged);
+}
+
+#ifndef __APPLE__
+TEST_F(SystemMonitorTest, TieredSampling_IdleProcessesGoCold) {
+    // A child that never runs after fork is the idlest process possible
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+    
+    MonitorOptions options;
+    options.cold_interval = 4;
+    options.hot_top_n = 0;
+    options.use_proc_connector = false;
+    SystemMonitor monitor(options);
+    const int self = static_cast<int>(getpid());
+    monitor.setHotPids({self});
+    
+    bool child_stale = false;
+    size_t cold_skipped = 0;
+    for (int i = 0; i < 12; ++i) {
+        monitor.update();
+        cold_skipped += monitor.getSamplingStats().cold_skipped;
+        for (const auto& proc : monitor.getProcesses()) {
+            if (proc.pid == self) {
+                EXPECT_FALSE(proc.stale());
+            } else if (proc.pid == child && proc.stale()) {
+                child_stale = true;
+                EXPECT_GT(proc.start_time, 0u);
+            }
+        }
+    }
+    
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    
+    EXPECT_TRUE(child_stale);
+    EXPECT_GT(cold_skipped, 0u);
+    const SamplingStats& stats = monitor.getSamplingStats();
+    EXPECT_GE(stats.hot, 1u);
+    EXPECT_LT(stats.hot, monitor.getProcessCount());
+}
+
+TEST_F(SystemMonitorTest, Footprint_OnlyForHotPids) {
+    if (access("/proc/self/smaps_rollup", R_OK) != 0) {
+        GTEST_SKIP() << "kernel without smaps_rollup";
+    }
+    const int self = static_cast<int>(getpid());
+    monitor_->setHotPids({self});
+    
+    const ProcessInfo* found = nullptr;
+    for (int attempt = 0; attempt < 100 && !found; ++attempt) {
+        monitor_->update();
+        for (const auto& proc : monitor_->getProcesses()) {
+            if (proc.pid == self && proc.footprint_available) {
+                found = &proc;
+            } else if (proc.pid != self) {
+                EXPECT_FALSE(proc.footprint_available);
+            }
+        }
+        if (!found) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ASSERT_NE(nullptr, found);
+    EXPECT_GT(found->footprint.pss, 0u);
+    EXPECT_GE(found->footprint_age, 0.0);
+}
+
+TEST_F(SystemMonitorTest, TieredSampling_IntervalOneSamplesEverything) {
+    MonitorOptions options;
+    options.cold_interval = 1;
+    SystemMonitor monitor(options);
+    for (int i = 0; i < 5; ++i) {
+        monitor.update();
+    }
+    const SamplingStats& stats = monitor.getSamplingStats();
+    EXPECT_EQ(monitor.getProcessCount(), stats.hot);
+    EXPECT_EQ(0u, stats.cold_checked + stats.cold_skipped);
+    for (const auto& proc : monitor.getProcesses()) {
+        EXPECT_FALSE(proc.stale());
+    }
+}
+#endif
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "thread_pool.hpp"
+#include <atomic>
+#include <vector>
+
+class ThreadPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(ThreadPoolTest, ParallelFor_VisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(1000);
+    
+    pool.parallelFor(hits.size(), 7, [&](size_t worker, size_t begin, size_t end) {
+        EXPECT_LT(worker, pool.size());
+        for (size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+    
+    for (const auto& hit : hits) {
+        EXPECT_EQ(1, hit.load());
+    }
+}
+
+TEST_F(ThreadPoolTest, ParallelFor_ReusableAcrossCalls) {
+    ThreadPool pool(3);
+    std::atomic<size_t> sum{0};
+    for (int round = 0; round < 50; ++round) {
+        pool.parallelFor(100, 4, [&](size_t, size_t begin, size_t end) {
+            sum.fetch_add(end - begin);
+        });
+    }
+    EXPECT_EQ(5000u, sum.load());
+}
+
+TEST_F(ThreadPoolTest, SingleThreadRunsInline) {
+    ThreadPool pool(1);
+    EXPECT_EQ(1u, pool.size());
+    size_t seen = 0;
+    pool.parallelFor(10, 3, [&](size_t worker, size_t begin, size_t end) {
+        EXPECT_EQ(0u, worker);
+        seen += end - begin;
+    });
+    EXPECT_EQ(10u, seen);
+}
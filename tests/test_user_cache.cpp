@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "user_cache.hpp"
+#include <chrono>
+#include <thread>
+#include <pwd.h>
+#include <unistd.h>
+
+class UserCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {}
+    void TearDown() override {}
+    
+    // Polls until the background resolver replaces the numeric placeholder
+    static std::string resolvedName(unsigned uid) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        std::string name = UserCache::instance().lookup(uid);
+        while (name == std::to_string(uid) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            name = UserCache::instance().lookup(uid);
+        }
+        return name;
+    }
+};
+
+TEST_F(UserCacheTest, Lookup_ReturnsImmediately) {
+    const std::string& name = UserCache::instance().lookup(static_cast<unsigned>(getuid()));
+    EXPECT_FALSE(name.empty());
+}
+
+TEST_F(UserCacheTest, Lookup_ResolvesInBackground) {
+    const unsigned uid = static_cast<unsigned>(getuid());
+    struct passwd* pw = getpwuid(uid);
+    if (!pw) {
+        GTEST_SKIP() << "current UID has no passwd entry";
+    }
+    EXPECT_EQ(std::string(pw->pw_name), resolvedName(uid));
+}
+
+TEST_F(UserCacheTest, Lookup_InternsNames) {
+    const unsigned uid = static_cast<unsigned>(getuid());
+    resolvedName(uid);
+    const std::string& first = UserCache::instance().lookup(uid);
+    const std::string& second = UserCache::instance().lookup(uid);
+    EXPECT_EQ(&first, &second);
+}
+
+TEST_F(UserCacheTest, Lookup_UnknownUidStaysNumeric) {
+    const unsigned uid = 3999999999u;
+    UserCache::instance().lookup(uid);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ("3999999999", UserCache::instance().lookup(uid));
+}